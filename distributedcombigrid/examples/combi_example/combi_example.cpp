@@ -35,17 +35,25 @@ BOOST_CLASS_EXPORT(StaticFaults)
 BOOST_CLASS_EXPORT(WeibullFaults)
 BOOST_CLASS_EXPORT(FaultCriterion)
 int main(int argc, char** argv) {
-  MPI_Init(&argc, &argv);
+  // read in parameter file
+  boost::property_tree::ptree cfg;
+  boost::property_tree::ini_parser::read_ini("ctparam", cfg);
+
+  // the tasks are only initialized on a helper thread if MPI supports it
+  bool prefetch = cfg.get<bool>("manager.prefetch", false);
+
+  if (prefetch) {
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+  } else {
+    MPI_Init(&argc, &argv);
+  }
 
   /* when using timers (TIMING is defined in Stats), the Stats class must be
    * initialized at the beginning of the program. (and finalized in the end)
    */
   Stats::initialize();
 
-  // read in parameter file
-  boost::property_tree::ptree cfg;
-  boost::property_tree::ini_parser::read_ini("ctparam", cfg);
-
   // number of process groups and number of processes per group
   size_t ngroup = cfg.get<size_t>("manager.ngroup");
   size_t nprocs = cfg.get<size_t>("manager.nprocs");
@@ -118,6 +126,7 @@ int main(int argc, char** argv) {
     // create combiparameters
     CombiParameters params(dim, lmin, lmax, boundary, levels, coeffs, taskIDs, ncombi, 1);
     params.setParallelization(p);
+    params.setPrefetchTaskInit(prefetch);
     // create abstraction for Manager
     ProcessManager manager(pgroups, tasks, params, std::move(loadmodel));
 
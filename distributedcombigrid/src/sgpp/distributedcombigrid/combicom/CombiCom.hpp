@@ -1,9 +1,13 @@
 #ifndef COMBICOM_HPP_
 #define COMBICOM_HPP_
 
+#include <cstdint>
+#include <numeric>
+
 #include "sgpp/distributedcombigrid/fullgrid/DistributedFullGrid.hpp"
 #include "sgpp/distributedcombigrid/fullgrid/DistributedFullGridNonUniform.hpp"
 #include "sgpp/distributedcombigrid/fullgrid/FullGrid.hpp"
+#include "sgpp/distributedcombigrid/mpi/MPILargeCount.hpp"
 #include "sgpp/distributedcombigrid/mpi/MPISystem.hpp"
 #include "sgpp/distributedcombigrid/sparsegrid/DistributedSparseGrid.hpp"
 #include "sgpp/distributedcombigrid/sparsegrid/SGrid.hpp"
@@ -18,6 +22,69 @@ struct mycomplex {
 
 namespace combigrid {
 
+/* state of a non-blocking global reduction of a distributed sparse grid
+ * (see CombiCom::startDistributedGlobalReduce)
+ */
+template <typename FG_ELEMENT>
+struct GlobalReduceRequest {
+  std::vector<size_t> subspaceSizes;
+
+  std::vector<FG_ELEMENT> buf;
+
+  // one request per chunk of buf, see MPILargeCount::iallreduce
+  std::vector<MPI_Request> requests;
+};
+
+/* persistent state of the one-sided global reduction of a distributed sparse grid
+ * (see CombiCom::distributedGlobalReduceRMA). it is kept between the combinations and
+ * released with CombiCom::freeGlobalReduceWindow
+ */
+template <typename FG_ELEMENT>
+struct GlobalReduceWindow {
+  MPI_Win win = MPI_WIN_NULL;
+
+  // three copies of the subspaces owned by this process, used in turn
+  std::vector<FG_ELEMENT> buf;
+
+  // number of contributions which are complete in each copy, summed over all reductions
+  // which used the copy
+  MPI_Win counterWin = MPI_WIN_NULL;
+
+  std::vector<int64_t> counters;
+
+  // layout of the sparse grid the window was created for
+  LevelVector nmin;
+
+  LevelVector nmax;
+
+  std::vector<size_t> subspaceSizes;
+
+  // position of each subspace in the copy of its owner
+  std::vector<size_t> subspaceOffsets;
+
+  // size of one copy on each owner
+  std::vector<size_t> ownerCounts;
+
+  // number of reductions since the window was created
+  size_t numReductions = 0;
+};
+
+/* persistent state of the node-aware global reduction of a distributed sparse grid
+ * (see CombiCom::distributedGlobalReduceHierarchical). it is kept between the combinations
+ * and released with CombiCom::freeGlobalReduceSharedWindow
+ */
+template <typename FG_ELEMENT>
+struct GlobalReduceSharedWindow {
+  MPI_Win win = MPI_WIN_NULL;
+
+  // size of the sparse grid buffer the window was created for
+  size_t bsize = 0;
+
+  // buffers of all processes of the node. the node leader has a second buffer behind its
+  // own, which holds the sum of the node and later the global sum
+  std::vector<FG_ELEMENT*> nodeBufs;
+};
+
 /*
  template <typename FG_ELEMENT>
  class SGrid;
@@ -41,6 +108,11 @@ class CombiCom {
   template <typename FG_ELEMENT>
   static void FGAllreduce(FullGrid<FG_ELEMENT>& fg, MPI_Comm comm);
 
+  // the local reduce variants below work on the non-uniform DistributedSparseGrid. they
+  // are not used by the combination, which adds the grids to a DistributedSparseGridUniform
+  // (see DistributedFullGrid::addToUniformSG), and can not be instantiated with the
+  // current DistributedFullGrid, whose subspaces do not store their bounds
+
   // multiply dfg with coeff and add to dsg. dfg will not be changed
   template <typename FG_ELEMENT>
   static void distributedLocalReduce(DistributedFullGrid<FG_ELEMENT>& dfg,
@@ -72,6 +144,132 @@ class CombiCom {
 
   template <typename FG_ELEMENT>
   static void distributedGlobalReduce(DistributedSparseGridUniform<FG_ELEMENT>& dsg);
+
+  // like distributedGlobalReduce, but each subspace is reduced only on its owner
+  // and afterwards only sent to the process groups which contain it.
+  // subspaces which are not needed on this process group stay empty
+  template <typename FG_ELEMENT>
+  static void distributedGlobalReduceScatter(DistributedSparseGridUniform<FG_ELEMENT>& dsg);
+
+  // one-sided variant: each subspace lives in an MPI window on its owner. every process
+  // accumulates its contribution into the windows of the owners and afterwards gets
+  // only the subspaces which are needed on this process group. the window persists in
+  // window as long as nmin and nmax of dsg do not change, a reduction then needs no
+  // collective call. aborts if the subspaces of dsg do not match the window
+  template <typename FG_ELEMENT>
+  static void distributedGlobalReduceRMA(DistributedSparseGridUniform<FG_ELEMENT>& dsg,
+                                         GlobalReduceWindow<FG_ELEMENT>& window);
+
+  // release the window of distributedGlobalReduceRMA, collective over the global reduce
+  // communicator
+  template <typename FG_ELEMENT>
+  static void freeGlobalReduceWindow(GlobalReduceWindow<FG_ELEMENT>& window);
+
+  // like distributedGlobalReduce, but the processes on the same node first reduce
+  // in shared memory and only one process per node takes part in the allreduce. the
+  // shared memory persists in window as long as the size of dsg does not change
+  template <typename FG_ELEMENT>
+  static void distributedGlobalReduceHierarchical(DistributedSparseGridUniform<FG_ELEMENT>& dsg,
+                                                  GlobalReduceSharedWindow<FG_ELEMENT>& window);
+
+  // release the window of distributedGlobalReduceHierarchical, collective over the node
+  // communicator of the global reduction
+  template <typename FG_ELEMENT>
+  static void freeGlobalReduceSharedWindow(GlobalReduceSharedWindow<FG_ELEMENT>& window);
+
+  // incremental variant of distributedGlobalReduce. only the subspaces in which the
+  // contribution of dsg differs by more than tol from the contribution that was sent
+  // before (stored in sent) are exchanged, the global result is accumulated in combined.
+  // afterwards dsg contains the combined solution. sent and combined have to be
+  // kept by the caller between the combinations
+  template <typename FG_ELEMENT>
+  static void distributedGlobalReduceDelta(DistributedSparseGridUniform<FG_ELEMENT>& dsg,
+                                           DistributedSparseGridUniform<FG_ELEMENT>& sent,
+                                           DistributedSparseGridUniform<FG_ELEMENT>& combined,
+                                           real tol);
+
+  // variant of distributedGlobalReduce which sends the subspaces with a level sum of at
+  // least minLevelSum in reduced precision (see abstraction::ReducedPrecision). the
+  // rounding error of this process is stored in residual and added to the contribution
+  // in the next call, so residual has to be kept by the caller between the combinations.
+  // the error of the result is about (n + 1) roundings for n processes
+  template <typename FG_ELEMENT>
+  static void distributedGlobalReduceReducedPrecision(
+      DistributedSparseGridUniform<FG_ELEMENT>& dsg,
+      DistributedSparseGridUniform<FG_ELEMENT>& residual, LevelType minLevelSum);
+
+  // copy the data of src to dst. src and dst have to be the same grid on the same
+  // processes but can use different parallelizations and decompositions. each process
+  // exchanges the overlap of its part in one grid with the parts of all processes in
+  // the other grid (alltoallv)
+  template <typename FG_ELEMENT>
+  static void redistribute(DistributedFullGrid<FG_ELEMENT>& src,
+                           DistributedFullGrid<FG_ELEMENT>& dst);
+
+  // like redistribute, but src and dst may be distributed over different subsets of the
+  // processes of comm, e.g. the first processes of a larger process group or a
+  // sub-communicator. processes of comm which do not hold a grid pass nullptr, all
+  // processes of comm have to take part, also those which hold neither grid
+  template <typename FG_ELEMENT>
+  static void redistribute(DistributedFullGrid<FG_ELEMENT>* src,
+                           DistributedFullGrid<FG_ELEMENT>* dst, DimType dim, MPI_Comm comm);
+
+  // non-blocking version of distributedGlobalReduce. dsg and request must not be
+  // changed or destroyed until finishDistributedGlobalReduce was called
+  template <typename FG_ELEMENT>
+  static void startDistributedGlobalReduce(DistributedSparseGridUniform<FG_ELEMENT>& dsg,
+                                           GlobalReduceRequest<FG_ELEMENT>& request,
+                                           MPI_Comm comm);
+
+  // wait for the reduction started with startDistributedGlobalReduce and write
+  // the result to dsg
+  template <typename FG_ELEMENT>
+  static void finishDistributedGlobalReduce(DistributedSparseGridUniform<FG_ELEMENT>& dsg,
+                                            GlobalReduceRequest<FG_ELEMENT>& request);
+
+ private:
+  // get the global size of each partial subspace in comm, returns the sum of the sizes
+  template <typename FG_ELEMENT>
+  static size_t reduceSubspaceSizes(DistributedSparseGridUniform<FG_ELEMENT>& dsg,
+                                    std::vector<size_t>& subspaceSizes, MPI_Comm comm);
+
+  // copy the subspaces of dsg to buf. subspaces which do not exist are filled with 0
+  template <typename FG_ELEMENT>
+  static void packSubspaces(DistributedSparseGridUniform<FG_ELEMENT>& dsg,
+                            const std::vector<size_t>& subspaceSizes, FG_ELEMENT* buf);
+
+  // intersection [lower, upper) of the boxes [lower1, upper1) and [lower2, upper2).
+  // returns the number of points in the intersection
+  static size_t intersectBoxes(const IndexVector& lower1, const IndexVector& upper1,
+                               const IndexVector& lower2, const IndexVector& upper2,
+                               IndexVector& lower, IndexVector& upper);
+
+  // lower and upper bounds of the part of each process of comm in dfg, see the
+  // redistribute overload with comm. processes which do not hold dfg get empty boxes
+  template <typename FG_ELEMENT>
+  static void getBoxes(const DistributedFullGrid<FG_ELEMENT>* dfg, DimType dim, MPI_Comm comm,
+                       std::vector<IndexVector>& lower, std::vector<IndexVector>& upper);
+
+  // exchange the overlaps of src and dst on comm. the boxes of both grids are given for
+  // all processes of comm, src or dst are nullptr on processes which do not hold them
+  template <typename FG_ELEMENT>
+  static void redistribute(DistributedFullGrid<FG_ELEMENT>* src,
+                           DistributedFullGrid<FG_ELEMENT>* dst,
+                           const std::vector<IndexVector>& srcLower,
+                           const std::vector<IndexVector>& srcUpper,
+                           const std::vector<IndexVector>& dstLower,
+                           const std::vector<IndexVector>& dstUpper, MPI_Comm comm);
+
+  // call f(localIndex, length) for each contiguous row (along the first dimension) of
+  // the box [lower, upper) in the local data of dfg
+  template <typename FG_ELEMENT, typename F>
+  static void forEachRow(const DistributedFullGrid<FG_ELEMENT>& dfg, const IndexVector& lower,
+                         const IndexVector& upper, F f);
+
+  // copy buf to the subspaces of dsg. missing subspaces are initialized
+  template <typename FG_ELEMENT>
+  static void unpackSubspaces(DistributedSparseGridUniform<FG_ELEMENT>& dsg,
+                              const std::vector<size_t>& subspaceSizes, const FG_ELEMENT* buf);
 };
 
 template <>
@@ -627,11 +825,11 @@ void CombiCom::distributedLocalReduceSGR(DistributedFullGrid<FG_ELEMENT>& dfg,
 
     // mpi reduce on buffer
     if (dfg.getMpiRank() == r) {
-      MPI_Reduce(MPI_IN_PLACE, buffers[r].data(), bsize, dfg.getMPIDatatype(), MPI_SUM, r,
-                 dfg.getCommunicator());
+      MPILargeCount::reduce(MPI_IN_PLACE, buffers[r].data(), bsize, dfg.getMPIDatatype(),
+                            MPI_SUM, r, dfg.getCommunicator());
     } else {
-      MPI_Reduce(buffers[r].data(), buffers[r].data(), bsize, dfg.getMPIDatatype(), MPI_SUM, r,
-                 dfg.getCommunicator());
+      MPILargeCount::reduce(buffers[r].data(), buffers[r].data(), bsize, dfg.getMPIDatatype(),
+                            MPI_SUM, r, dfg.getCommunicator());
     }
 
     if (dfg.getMpiRank() != r) buffers[r].resize(0);
@@ -701,17 +899,15 @@ void CombiCom::distributedGlobalReduce(DistributedSparseGrid<FG_ELEMENT>& dsg) {
     dsg.initSubspace(i, 0.0);
 
     FG_ELEMENT* buf = dsg.getData(i);
-    int bsize = int(dsg.getDataSize(i));
+    size_t bsize = dsg.getDataSize(i);
     MPI_Datatype dtype =
         abstraction::getMPIDatatype(abstraction::getabstractionDataType<FG_ELEMENT>());
 
     // mpi allreduce
     if (USE_NONBLOCKING_MPI_COLLECTIVE) {
-      MPI_Request request;
-      MPI_Iallreduce(MPI_IN_PLACE, buf, bsize, dtype, MPI_SUM, mycomm, &request);
-      myrequests.push_back(request);
+      MPILargeCount::iallreduce(buf, bsize, dtype, MPI_SUM, mycomm, myrequests);
     } else {
-      MPI_Allreduce(MPI_IN_PLACE, buf, bsize, dtype, MPI_SUM, mycomm);
+      MPILargeCount::allreduce(MPI_IN_PLACE, buf, bsize, dtype, MPI_SUM, mycomm);
     }
   }
 
@@ -734,31 +930,47 @@ void CombiCom::distributedGlobalReduce(DistributedSparseGridUniform<FG_ELEMENT>&
 
   assert(mycomm != MPI_COMM_NULL);
 
+  std::vector<size_t> subspaceSizes;
+  size_t bsize = reduceSubspaceSizes(dsg, subspaceSizes, mycomm);
+
+  // put subspace data into buffer for allreduce
+  std::vector<FG_ELEMENT> buf(bsize, FG_ELEMENT(0));
+  packSubspaces(dsg, subspaceSizes, buf.data());
+
+  // define datatype for full grid elements
+  MPI_Datatype dtype =
+      abstraction::getMPIDatatype(abstraction::getabstractionDataType<FG_ELEMENT>());
+  // reduce the local part of sparse grid (distributed according to domain decomposition)
+  MPILargeCount::allreduce(MPI_IN_PLACE, buf.data(), bsize, dtype, MPI_SUM, mycomm);
+
+  // extract subspace data from buffer and write in corresponding subspaces
+  unpackSubspaces(dsg, subspaceSizes, buf.data());
+}
+
+template <typename FG_ELEMENT>
+size_t CombiCom::reduceSubspaceSizes(DistributedSparseGridUniform<FG_ELEMENT>& dsg,
+                                     std::vector<size_t>& subspaceSizes, MPI_Comm comm) {
   /* get sizes of all partial subspaces in communicator
    * we have to do this, because size information of uninitialized subspaces
    * is not available in dsg. at the moment this information is only available
    * in dfg.
    */
-  std::vector<int> subspaceSizes(dsg.getNumSubspaces());
-
-  for (size_t i = 0; i < subspaceSizes.size(); ++i) {
-    // MPI does not have a real size_t equivalent. int should work in most cases
-    // if not we can at least detect this with an assert
-    assert(dsg.getDataSize(i) <= std::numeric_limits<int>::max());
+  subspaceSizes.resize(dsg.getNumSubspaces());
 
-    subspaceSizes[i] = int(dsg.getDataSize(i));
-  }
+  for (size_t i = 0; i < subspaceSizes.size(); ++i) subspaceSizes[i] = dsg.getDataSize(i);
 
-  MPI_Allreduce(MPI_IN_PLACE, subspaceSizes.data(), int(subspaceSizes.size()), MPI_INT, MPI_MAX,
-                mycomm);
+  // MPI does not have a size_t datatype, so we use the 64 bit equivalent
+  static_assert(sizeof(size_t) == sizeof(uint64_t), "size_t is expected to have 64 bit");
+  MPI_Allreduce(MPI_IN_PLACE, subspaceSizes.data(), int(subspaceSizes.size()), MPI_UINT64_T,
+                MPI_MAX, comm);
 
   // check for implementation errors, the reduced subspace size should not be
   // different from the size of already initialized subspaces
-  int bsize = 0;
+  size_t bsize = 0;
 
   for (size_t i = 0; i < subspaceSizes.size(); ++i) {
     bool check = (subspaceSizes[i] == 0 || dsg.getDataSize(i) == 0 ||
-                  subspaceSizes[i] == int(dsg.getDataSize(i)));
+                  subspaceSizes[i] == dsg.getDataSize(i));
 
     if (!check) {
       int rank;
@@ -773,57 +985,898 @@ void CombiCom::distributedGlobalReduce(DistributedSparseGridUniform<FG_ELEMENT>&
     bsize += subspaceSizes[i];
   }
 
-  // put subspace data into buffer for allreduce
-  std::vector<FG_ELEMENT> buf(bsize, FG_ELEMENT(0));
+  return bsize;
+}
+
+template <typename FG_ELEMENT>
+void CombiCom::packSubspaces(DistributedSparseGridUniform<FG_ELEMENT>& dsg,
+                             const std::vector<size_t>& subspaceSizes, FG_ELEMENT* buf) {
+  FG_ELEMENT* buf_it = buf;
+
+  for (size_t i = 0; i < dsg.getNumSubspaces(); ++i) {
+    std::vector<FG_ELEMENT>& subspaceData = dsg.getDataVector(i);
+
+    // if subspace does not exist on this process this part of the buffer is
+    // filled with zeros
+    if (subspaceData.size() == 0) {
+      std::fill(buf_it, buf_it + subspaceSizes[i], FG_ELEMENT(0));
+      buf_it += subspaceSizes[i];
+      continue;
+    }
+
+    buf_it = std::copy(subspaceData.begin(), subspaceData.end(), buf_it);
+  }
+}
+
+template <typename FG_ELEMENT>
+void CombiCom::unpackSubspaces(DistributedSparseGridUniform<FG_ELEMENT>& dsg,
+                               const std::vector<size_t>& subspaceSizes,
+                               const FG_ELEMENT* buf) {
+  const FG_ELEMENT* buf_it = buf;
+
+  for (size_t i = 0; i < dsg.getNumSubspaces(); ++i) {
+    std::vector<FG_ELEMENT>& subspaceData = dsg.getDataVector(i);
+
+    // this can happen if dsg is different than
+    // lmax and lmin of combination scheme
+    if (subspaceData.size() == 0 && subspaceSizes[i] == 0) continue;
+
+    // this happens for subspaces that are only available in component grids
+    // on other process groups
+    if (subspaceData.size() == 0 && subspaceSizes[i] > 0) {
+      subspaceData.resize(subspaceSizes[i]);
+    }
+
+    // in case subspaceData.size() > 0 und subspaceSizes > 0
+    std::copy(buf_it, buf_it + subspaceData.size(), subspaceData.begin());
+    buf_it += subspaceData.size();
+  }
+}
+
+/***
+ * Node-aware variant of the global reduction. The processes of the global reduce communicator
+ * which share a node first sum up their buffers in a shared memory window: each process adds up
+ * one slice of the buffers of all processes on the node and writes it to the result buffer of
+ * the node leader. Only the node leaders then perform an MPI_Allreduce over the network.
+ * Afterwards all processes of a node read the result directly from the result buffer of their
+ * leader.
+ *
+ * The window is only allocated (collectively on the node) when the size of the sparse grid
+ * changes. It stays locked for all processes, a reduction synchronizes the node three times
+ * with a barrier (after the packing, after the summation on the node and after the
+ * allreduce). Since the packed buffers and the result are kept apart, the packing of the next
+ * reduction does not have to wait for the reading of this one: the result is only written
+ * again after the first barrier of the next reduction, which all processes pass after their
+ * reading is complete.
+ */
+template <typename FG_ELEMENT>
+void CombiCom::distributedGlobalReduceHierarchical(DistributedSparseGridUniform<FG_ELEMENT>& dsg,
+                                                   GlobalReduceSharedWindow<FG_ELEMENT>& window) {
+  MPI_Comm mycomm = theMPISystem()->getGlobalReduceComm();
+  MPI_Comm nodeComm = theMPISystem()->getGlobalReduceNodeComm();
+  MPI_Comm leaderComm = theMPISystem()->getGlobalReduceNodeLeaderComm();
+
+  assert(mycomm != MPI_COMM_NULL);
+  assert(nodeComm != MPI_COMM_NULL);
+
+  std::vector<size_t> subspaceSizes;
+  size_t bsize = reduceSubspaceSizes(dsg, subspaceSizes, mycomm);
+
+  int nodeSize = getCommSize(nodeComm);
+  int nodeRank = getCommRank(nodeComm);
+
+  // bsize is the same on all processes of the node, so they agree on the reallocation
+  if (window.win == MPI_WIN_NULL || window.bsize != bsize) {
+    freeGlobalReduceSharedWindow(window);
+
+    window.bsize = bsize;
+
+    // the leader holds the result behind its own buffer
+    MPI_Aint size = MPI_Aint((nodeRank == 0 ? 2 : 1) * bsize * sizeof(FG_ELEMENT));
+    FG_ELEMENT* myBuf;
+    MPI_Win_allocate_shared(size, sizeof(FG_ELEMENT), MPI_INFO_NULL, nodeComm, &myBuf,
+                            &window.win);
+
+    window.nodeBufs.resize(nodeSize);
+
+    for (int r = 0; r < nodeSize; ++r) {
+      MPI_Aint rsize;
+      int dispUnit;
+      MPI_Win_shared_query(window.win, r, &rsize, &dispUnit, &window.nodeBufs[r]);
+    }
+
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, window.win);
+  }
+
+  std::vector<FG_ELEMENT*>& nodeBufs = window.nodeBufs;
+  FG_ELEMENT* result = nodeBufs[0] + bsize;
+
+  packSubspaces(dsg, subspaceSizes, nodeBufs[nodeRank]);
+
+  MPI_Win_sync(window.win);
+  MPI_Barrier(nodeComm);
+  MPI_Win_sync(window.win);
+
+  // sum up the slice of this process into the result of the leader
+  size_t sliceBegin = bsize * nodeRank / nodeSize;
+  size_t sliceEnd = bsize * (nodeRank + 1) / nodeSize;
+
+  std::copy(nodeBufs[0] + sliceBegin, nodeBufs[0] + sliceEnd, result + sliceBegin);
+
+  for (int r = 1; r < nodeSize; ++r) {
+    for (size_t j = sliceBegin; j < sliceEnd; ++j) result[j] += nodeBufs[r][j];
+  }
+
+  MPI_Win_sync(window.win);
+  MPI_Barrier(nodeComm);
+  MPI_Win_sync(window.win);
+
+  // reduce between the nodes
+  if (leaderComm != MPI_COMM_NULL) {
+    MPI_Datatype dtype =
+        abstraction::getMPIDatatype(abstraction::getabstractionDataType<FG_ELEMENT>());
+    MPILargeCount::allreduce(MPI_IN_PLACE, result, bsize, dtype, MPI_SUM, leaderComm);
+  }
+
+  MPI_Win_sync(window.win);
+  MPI_Barrier(nodeComm);
+  MPI_Win_sync(window.win);
+
+  unpackSubspaces(dsg, subspaceSizes, result);
+}
+
+template <typename FG_ELEMENT>
+void CombiCom::freeGlobalReduceSharedWindow(GlobalReduceSharedWindow<FG_ELEMENT>& window) {
+  if (window.win == MPI_WIN_NULL) return;
+
+  // the buffers may still be read by the other processes of the node
+  MPI_Win_unlock_all(window.win);
+  MPI_Win_free(&window.win);
+  window.nodeBufs.clear();
+  window.bsize = 0;
+}
+
+/***
+ * Delta-based global reduction. Each process compares its current contribution with the one it
+ * has sent in previous combinations. A subspace is only exchanged if the maximum difference is
+ * larger than tol on any process of the global reduce communicator; in this case the differences
+ * are reduced and added to the combined sparse grid, and the new contribution is remembered as
+ * sent. Differences below the tolerance are not lost, they accumulate until they are exchanged.
+ * Thus the error of the combined solution is bounded by the number of process groups times tol.
+ * With tol = 0 only the unchanged subspaces are skipped and the result is exact.
+ */
+template <typename FG_ELEMENT>
+void CombiCom::distributedGlobalReduceDelta(DistributedSparseGridUniform<FG_ELEMENT>& dsg,
+                                            DistributedSparseGridUniform<FG_ELEMENT>& sent,
+                                            DistributedSparseGridUniform<FG_ELEMENT>& combined,
+                                            real tol) {
+  MPI_Comm mycomm = theMPISystem()->getGlobalReduceComm();
+
+  assert(mycomm != MPI_COMM_NULL);
+  assert(sent.getNumSubspaces() == dsg.getNumSubspaces());
+  assert(combined.getNumSubspaces() == dsg.getNumSubspaces());
+
+  std::vector<size_t> subspaceSizes;
+  reduceSubspaceSizes(dsg, subspaceSizes, mycomm);
+
+  size_t numSubspaces = dsg.getNumSubspaces();
+
+  // find the subspaces which changed by more than tol on this process
+  std::vector<int> changed(numSubspaces, 0);
+
+  for (size_t i = 0; i < numSubspaces; ++i) {
+    const std::vector<FG_ELEMENT>& current = dsg.getDataVector(i);
+    const std::vector<FG_ELEMENT>& reference = sent.getDataVector(i);
+
+    for (size_t j = 0; j < subspaceSizes[i]; ++j) {
+      FG_ELEMENT delta = (current.empty() ? FG_ELEMENT(0) : current[j]) -
+                         (reference.empty() ? FG_ELEMENT(0) : reference[j]);
+
+      if (std::abs(delta) > tol) {
+        changed[i] = 1;
+        break;
+      }
+    }
+  }
+
+  MPI_Allreduce(MPI_IN_PLACE, changed.data(), int(numSubspaces), MPI_INT, MPI_MAX, mycomm);
+
+  // put the differences of the changed subspaces into the buffer and remember the
+  // current contribution as sent
+  size_t bsize = 0;
+
+  for (size_t i = 0; i < numSubspaces; ++i) {
+    if (changed[i]) bsize += subspaceSizes[i];
+  }
+
+  std::vector<FG_ELEMENT> buf(bsize);
   {
     typename std::vector<FG_ELEMENT>::iterator buf_it = buf.begin();
 
-    for (size_t i = 0; i < dsg.getNumSubspaces(); ++i) {
-      std::vector<FG_ELEMENT>& subspaceData = dsg.getDataVector(i);
+    for (size_t i = 0; i < numSubspaces; ++i) {
+      if (!changed[i]) continue;
 
-      // if subspace does not exist on this process this part of the buffer is
-      // left empty
-      if (subspaceData.size() == 0) {
-        buf_it += subspaceSizes[i];
-        continue;
+      const std::vector<FG_ELEMENT>& current = dsg.getDataVector(i);
+      std::vector<FG_ELEMENT>& reference = sent.getDataVector(i);
+      reference.resize(subspaceSizes[i], FG_ELEMENT(0));
+
+      for (size_t j = 0; j < subspaceSizes[i]; ++j) {
+        FG_ELEMENT value = current.empty() ? FG_ELEMENT(0) : current[j];
+        *buf_it = value - reference[j];
+        reference[j] = value;
+        ++buf_it;
       }
+    }
+  }
+
+  MPI_Datatype dtype =
+      abstraction::getMPIDatatype(abstraction::getabstractionDataType<FG_ELEMENT>());
+  MPILargeCount::allreduce(MPI_IN_PLACE, buf.data(), bsize, dtype, MPI_SUM, mycomm);
+
+  // update the combined solution and copy it to dsg
+  typename std::vector<FG_ELEMENT>::const_iterator buf_it = buf.begin();
+
+  for (size_t i = 0; i < numSubspaces; ++i) {
+    std::vector<FG_ELEMENT>& result = combined.getDataVector(i);
 
-      for (size_t j = 0; j < subspaceData.size(); ++j) {
-        *buf_it = subspaceData[j];
+    if (changed[i]) {
+      result.resize(subspaceSizes[i], FG_ELEMENT(0));
+
+      for (size_t j = 0; j < subspaceSizes[i]; ++j) {
+        result[j] += *buf_it;
         ++buf_it;
       }
     }
+
+    if (subspaceSizes[i] == 0) continue;
+
+    std::vector<FG_ELEMENT>& subspaceData = dsg.getDataVector(i);
+    subspaceData.resize(subspaceSizes[i]);
+
+    // subspaces which never changed are zero
+    if (result.empty())
+      std::fill(subspaceData.begin(), subspaceData.end(), FG_ELEMENT(0));
+    else
+      std::copy(result.begin(), result.end(), subspaceData.begin());
   }
-  // define datatype for full grid elements
+}
+
+/***
+ * The non-blocking global reduction is split in two parts. In the first part the sizes of the
+ * subspaces are agreed on (this is a small blocking collective) and the data is packed and handed
+ * to MPI_Iallreduce. The reduction then progresses while the caller continues with other work,
+ * e.g. the next time steps of the tasks. Note that without asynchronous progress in the MPI
+ * library, the reduction only progresses during other MPI calls.
+ */
+template <typename FG_ELEMENT>
+void CombiCom::startDistributedGlobalReduce(DistributedSparseGridUniform<FG_ELEMENT>& dsg,
+                                            GlobalReduceRequest<FG_ELEMENT>& request,
+                                            MPI_Comm comm) {
+  assert(comm != MPI_COMM_NULL);
+  assert(request.requests.empty() && "reduction still in progress");
+
+  size_t bsize = reduceSubspaceSizes(dsg, request.subspaceSizes, comm);
+
+  request.buf.resize(bsize);
+  packSubspaces(dsg, request.subspaceSizes, request.buf.data());
+
   MPI_Datatype dtype =
       abstraction::getMPIDatatype(abstraction::getabstractionDataType<FG_ELEMENT>());
-  // reduce the local part of sparse grid (distributed according to domain decomposition)
-  MPI_Allreduce(MPI_IN_PLACE, buf.data(), bsize, dtype, MPI_SUM, mycomm);
+  MPILargeCount::iallreduce(request.buf.data(), bsize, dtype, MPI_SUM, comm, request.requests);
+}
 
-  // extract subspace data from buffer and write in corresponding subspaces
+template <typename FG_ELEMENT>
+void CombiCom::finishDistributedGlobalReduce(DistributedSparseGridUniform<FG_ELEMENT>& dsg,
+                                             GlobalReduceRequest<FG_ELEMENT>& request) {
+  MPI_Waitall(static_cast<int>(request.requests.size()), request.requests.data(),
+              MPI_STATUSES_IGNORE);
+  request.requests.clear();
+
+  unpackSubspaces(dsg, request.subspaceSizes, request.buf.data());
+
+  // release buffer
+  std::vector<FG_ELEMENT>().swap(request.buf);
+}
+
+/***
+ * Reduce-scatter variant of the global reduction. Every subspace gets an owner in the global
+ * reduce communicator (see DistributedSparseGridUniform::calcSubspaceOwners). The subspaces are
+ * summed up only on their owner with MPI_Reduce_scatter and the owners then send the reduced
+ * subspaces only to the process groups whose component grids contain them. Compared to the
+ * allreduce variant, each process receives only the part of the sparse grid it actually needs
+ * and subspaces which are not needed on a process group are not allocated there.
+ * So after this reduction the sparse grid does not hold the full combined solution, and the
+ * worker refuses parallelEval and setCombinedSolutionUniform (e.g. for recomputed tasks).
+ */
+template <typename FG_ELEMENT>
+void CombiCom::distributedGlobalReduceScatter(DistributedSparseGridUniform<FG_ELEMENT>& dsg) {
+  MPI_Comm mycomm = theMPISystem()->getGlobalReduceComm();
+
+  assert(mycomm != MPI_COMM_NULL);
+
+  int commSize = getCommSize(mycomm);
+  int commRank = getCommRank(mycomm);
+  size_t numSubspaces = dsg.getNumSubspaces();
+
+  // get sizes of all partial subspaces, see distributedGlobalReduce
+  std::vector<size_t> subspaceSizes;
+  reduceSubspaceSizes(dsg, subspaceSizes, mycomm);
+
+  // a subspace is needed on this process if it was initialized by the local reduce
+  std::vector<char> needed(numSubspaces);
+
+  for (size_t i = 0; i < numSubspaces; ++i) needed[i] = (dsg.getDataSize(i) > 0);
+
+  std::vector<char> allNeeded(numSubspaces * commSize);
+  MPI_Allgather(needed.data(), int(numSubspaces), MPI_CHAR, allNeeded.data(), int(numSubspaces),
+                MPI_CHAR, mycomm);
+
+  dsg.calcSubspaceOwners(subspaceSizes, commSize);
+
+  // the send buffer is ordered by owner, so that each owner receives a contiguous block
+  std::vector<size_t> ownerCounts(commSize, 0);
+
+  for (size_t i = 0; i < numSubspaces; ++i) {
+    ownerCounts[dsg.getSubspaceOwner(i)] += subspaceSizes[i];
+  }
+
+  std::vector<size_t> ownerOffsets(commSize, 0);
+
+  for (int r = 1; r < commSize; ++r) ownerOffsets[r] = ownerOffsets[r - 1] + ownerCounts[r - 1];
+
+  size_t bsize = ownerOffsets[commSize - 1] + ownerCounts[commSize - 1];
+
+  std::vector<FG_ELEMENT> sendBuf(bsize, FG_ELEMENT(0));
+
+  // offset of each subspace in the block of its owner
+  std::vector<size_t> subspaceOffsets(numSubspaces);
   {
-    typename std::vector<FG_ELEMENT>::iterator buf_it = buf.begin();
+    std::vector<size_t> cursor(commSize, 0);
+
+    for (size_t i = 0; i < numSubspaces; ++i) {
+      RankType owner = dsg.getSubspaceOwner(i);
+      subspaceOffsets[i] = cursor[owner];
+      cursor[owner] += subspaceSizes[i];
 
-    for (size_t i = 0; i < dsg.getNumSubspaces(); ++i) {
       std::vector<FG_ELEMENT>& subspaceData = dsg.getDataVector(i);
+      std::copy(subspaceData.begin(), subspaceData.end(),
+                sendBuf.begin() + ownerOffsets[owner] + subspaceOffsets[i]);
+    }
+  }
+
+  MPI_Datatype dtype =
+      abstraction::getMPIDatatype(abstraction::getabstractionDataType<FG_ELEMENT>());
+
+  std::vector<FG_ELEMENT> ownedBuf(ownerCounts[commRank]);
+  MPILargeCount::reduceScatter(sendBuf.data(), ownedBuf.data(), ownerCounts, dtype, MPI_SUM,
+                               mycomm);
+
+  // release the send buffer before the redistribution
+  std::vector<FG_ELEMENT>().swap(sendBuf);
 
-      // this can happen if dsg is different than
-      // lmax and lmin of combination scheme
-      if (subspaceData.size() == 0 && subspaceSizes[i] == 0) continue;
+  // send the reduced subspaces to all processes which need them. on both sides
+  // the subspaces are packed in ascending order of their index
+  std::vector<size_t> sendCounts(commSize, 0);
+  std::vector<size_t> recvCounts(commSize, 0);
 
-      // this happens for subspaces that are only available in component grids
-      // on other process groups
-      if (subspaceData.size() == 0 && subspaceSizes[i] > 0) {
-        subspaceData.resize(subspaceSizes[i]);
+  for (size_t i = 0; i < numSubspaces; ++i) {
+    RankType owner = dsg.getSubspaceOwner(i);
+
+    if (owner == commRank) {
+      for (int r = 0; r < commSize; ++r) {
+        if (allNeeded[r * numSubspaces + i]) sendCounts[r] += subspaceSizes[i];
       }
+    }
 
-      // in case subspaceData.size() > 0 und subspaceSizes > 0
-      for (size_t j = 0; j < subspaceData.size(); ++j) {
-        subspaceData[j] = *buf_it;
-        ++buf_it;
+    if (needed[i]) recvCounts[owner] += subspaceSizes[i];
+  }
+
+  std::vector<size_t> sendDispls(commSize, 0);
+  std::vector<size_t> recvDispls(commSize, 0);
+
+  for (int r = 1; r < commSize; ++r) {
+    sendDispls[r] = sendDispls[r - 1] + sendCounts[r - 1];
+    recvDispls[r] = recvDispls[r - 1] + recvCounts[r - 1];
+  }
+
+  std::vector<FG_ELEMENT> redistSendBuf(sendDispls[commSize - 1] + sendCounts[commSize - 1]);
+  std::vector<FG_ELEMENT> redistRecvBuf(recvDispls[commSize - 1] + recvCounts[commSize - 1]);
+  {
+    std::vector<size_t> cursor(sendDispls);
+
+    for (size_t i = 0; i < numSubspaces; ++i) {
+      if (dsg.getSubspaceOwner(i) != commRank) continue;
+
+      typename std::vector<FG_ELEMENT>::const_iterator first =
+          ownedBuf.begin() + subspaceOffsets[i];
+
+      for (int r = 0; r < commSize; ++r) {
+        if (!allNeeded[r * numSubspaces + i]) continue;
+
+        std::copy(first, first + subspaceSizes[i], redistSendBuf.begin() + cursor[r]);
+        cursor[r] += subspaceSizes[i];
+      }
+    }
+  }
+
+  MPILargeCount::alltoallv(redistSendBuf.data(), sendCounts, sendDispls, redistRecvBuf.data(),
+                           recvCounts, recvDispls, dtype, mycomm);
+
+  // write received data into the subspaces
+  {
+    std::vector<size_t> cursor(recvDispls);
+
+    for (size_t i = 0; i < numSubspaces; ++i) {
+      if (!needed[i]) continue;
+
+      RankType owner = dsg.getSubspaceOwner(i);
+      std::vector<FG_ELEMENT>& subspaceData = dsg.getDataVector(i);
+
+      std::copy(redistRecvBuf.begin() + cursor[owner],
+                redistRecvBuf.begin() + cursor[owner] + subspaceSizes[i], subspaceData.begin());
+      cursor[owner] += subspaceSizes[i];
+    }
+  }
+}
+
+/***
+ * One-sided variant of the global reduction. As in the reduce-scatter variant every subspace
+ * has an owner in the global reduce communicator. The owners expose the memory of their
+ * subspaces in an MPI window. Each process adds its part of the sparse grid directly to the
+ * windows of the owners with MPI_Accumulate, which needs no matching call on the owner and no
+ * ordering between the process groups. Afterwards each process reads back with MPI_Get only the
+ * subspaces it needs. Like in the reduce-scatter variant, the subspaces which are not needed on
+ * a process group are not allocated there.
+ *
+ * The window is created collectively (after the subspace sizes are reduced) in the first
+ * reduction and again when nmin or nmax change, e.g. in the last combination. The other
+ * reductions have no collective call. Instead, the completion is signalled one-sidedly: once
+ * its accumulations are complete at the targets (MPI_Win_flush_all), every process increments
+ * a counter on each owner. A process reads from the owners after their counters show that all
+ * processes have contributed, and it waits for the counters of all owners, not only of those
+ * it reads from. So no process can finish reduction k before every owner has started it. The
+ * counters are never reset: the counter of a copy counts the contributions of all reductions
+ * which used the copy.
+ *
+ * The owners keep three copies of their subspaces: reduction k accumulates into copy k % 3,
+ * and before it signals its own contribution each owner zeroes copy (k + 1) % 3. That copy was
+ * last read in reduction k - 2. These reads are complete: the owner has seen the contributions
+ * of all processes to reduction k - 1, and every process contributes to k - 1 only after its
+ * reads of k - 2. Nobody accumulates into the zeroed copy too early, since reduction k + 1
+ * starts only after the counters of all owners, including the one of this owner, are
+ * complete for reduction k.
+ *
+ * The layout of the window is fixed between its creations. A subspace which is non-empty on
+ * this process but has another size in the window (e.g. it was empty on all processes when
+ * the window was created) cannot be reduced, and the reduction aborts. Checking this against
+ * the reduced sizes in every reduction would need a collective call again.
+ */
+template <typename FG_ELEMENT>
+void CombiCom::distributedGlobalReduceRMA(DistributedSparseGridUniform<FG_ELEMENT>& dsg,
+                                          GlobalReduceWindow<FG_ELEMENT>& window) {
+  MPI_Comm mycomm = theMPISystem()->getGlobalReduceComm();
+
+  assert(mycomm != MPI_COMM_NULL);
+
+  int commSize = getCommSize(mycomm);
+  int commRank = getCommRank(mycomm);
+  size_t numSubspaces = dsg.getNumSubspaces();
+
+  // e.g. lmin and lmax are not reduced in the last combination
+  if (window.win == MPI_WIN_NULL || window.nmin != dsg.getNMin() ||
+      window.nmax != dsg.getNMax()) {
+    freeGlobalReduceWindow(window);
+
+    window.nmin = dsg.getNMin();
+    window.nmax = dsg.getNMax();
+    reduceSubspaceSizes(dsg, window.subspaceSizes, mycomm);
+
+    dsg.calcSubspaceOwners(window.subspaceSizes, commSize);
+
+    window.subspaceOffsets.assign(numSubspaces, 0);
+    window.ownerCounts.assign(commSize, 0);
+
+    for (size_t i = 0; i < numSubspaces; ++i) {
+      RankType owner = dsg.getSubspaceOwner(i);
+      window.subspaceOffsets[i] = window.ownerCounts[owner];
+      window.ownerCounts[owner] += window.subspaceSizes[i];
+    }
+
+    // all copies and counters are zero-initialized before the windows are created, the
+    // creation is collective so nobody can access them before
+    window.buf.assign(3 * window.ownerCounts[commRank], FG_ELEMENT(0));
+    window.counters.assign(3, 0);
+
+    MPI_Win_create(window.buf.data(), MPI_Aint(window.buf.size() * sizeof(FG_ELEMENT)),
+                   sizeof(FG_ELEMENT), MPI_INFO_NULL, mycomm, &window.win);
+    MPI_Win_create(window.counters.data(), MPI_Aint(window.counters.size() * sizeof(int64_t)),
+                   sizeof(int64_t), MPI_INFO_NULL, mycomm, &window.counterWin);
+    window.numReductions = 0;
+  } else {
+    // the sparse grid is new in each combination, the owners only depend on the sizes
+    dsg.calcSubspaceOwners(window.subspaceSizes, commSize);
+  }
+
+  for (size_t i = 0; i < numSubspaces; ++i) {
+    if (dsg.getDataSize(i) != 0 && dsg.getDataSize(i) != window.subspaceSizes[i]) {
+      std::cout << "the subspaces of the sparse grid do not match the window of the RMA "
+                << "global reduction! Aborting! \n";
+      MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+  }
+
+  size_t current = window.numReductions % 3;
+  size_t next = (window.numReductions + 1) % 3;
+  // number of contributions to the current copy once all processes have contributed
+  int64_t expected = int64_t(window.numReductions / 3 + 1) * commSize;
+  ++window.numReductions;
+
+  MPI_Datatype dtype =
+      abstraction::getMPIDatatype(abstraction::getabstractionDataType<FG_ELEMENT>());
+
+  MPI_Win_lock_all(MPI_MODE_NOCHECK, window.win);
+  MPI_Win_lock_all(MPI_MODE_NOCHECK, window.counterWin);
+
+  // prepare the copy of the next reduction, see above
+  size_t ownedSize = window.ownerCounts[commRank];
+  std::fill(window.buf.begin() + next * ownedSize, window.buf.begin() + (next + 1) * ownedSize,
+            FG_ELEMENT(0));
+  MPI_Win_sync(window.win);
+
+  for (size_t i = 0; i < numSubspaces; ++i) {
+    std::vector<FG_ELEMENT>& subspaceData = dsg.getDataVector(i);
+
+    if (subspaceData.size() == 0) continue;
+
+    RankType owner = dsg.getSubspaceOwner(i);
+    MPI_Aint disp = MPI_Aint(current * window.ownerCounts[owner] + window.subspaceOffsets[i]);
+
+    MPI_Datatype type;
+    int count = MPILargeCount::createLargeType(subspaceData.size(), dtype, &type);
+    MPI_Accumulate(subspaceData.data(), count, type, owner, disp, count, type, MPI_SUM,
+                   window.win);
+    MPILargeCount::freeLargeType(&type, dtype);
+  }
+
+  // the contributions have to be complete at the owners before they are counted
+  MPI_Win_flush_all(window.win);
+
+  int64_t one = 1;
+
+  for (int r = 0; r < commSize; ++r) {
+    MPI_Accumulate(&one, 1, MPI_INT64_T, r, MPI_Aint(current), 1, MPI_INT64_T, MPI_SUM,
+                   window.counterWin);
+  }
+
+  MPI_Win_flush_all(window.counterWin);
+
+  // wait until all processes have contributed to all owners
+  for (int r = 0; r < commSize; ++r) {
+    int64_t count = 0;
+
+    while (count < expected) {
+      MPI_Fetch_and_op(nullptr, &count, MPI_INT64_T, r, MPI_Aint(current), MPI_NO_OP,
+                       window.counterWin);
+      MPI_Win_flush(r, window.counterWin);
+    }
+  }
+
+  MPI_Win_sync(window.win);
+
+  for (size_t i = 0; i < numSubspaces; ++i) {
+    std::vector<FG_ELEMENT>& subspaceData = dsg.getDataVector(i);
+
+    if (subspaceData.size() == 0) continue;
+
+    RankType owner = dsg.getSubspaceOwner(i);
+    MPI_Aint disp = MPI_Aint(current * window.ownerCounts[owner] + window.subspaceOffsets[i]);
+
+    MPI_Datatype type;
+    int count = MPILargeCount::createLargeType(subspaceData.size(), dtype, &type);
+    MPI_Get(subspaceData.data(), count, type, owner, disp, count, type, window.win);
+    MPILargeCount::freeLargeType(&type, dtype);
+  }
+
+  MPI_Win_unlock_all(window.counterWin);
+  MPI_Win_unlock_all(window.win);
+}
+
+template <typename FG_ELEMENT>
+void CombiCom::freeGlobalReduceWindow(GlobalReduceWindow<FG_ELEMENT>& window) {
+  if (window.win == MPI_WIN_NULL) return;
+
+  MPI_Win_free(&window.win);
+  MPI_Win_free(&window.counterWin);
+  std::vector<FG_ELEMENT>().swap(window.buf);
+  window.counters.clear();
+}
+
+/***
+ * Global reduction with a reduced precision wire format. The coarse subspaces, which carry most
+ * of the solution, are reduced exactly. The contribution to the fine subspaces is rounded to the
+ * lower precision before the reduction. The rounding error is not discarded but remembered in
+ * residual and sent with the next combination (error feedback), so it does not accumulate over
+ * the combinations. The error of a combined surplus is not bounded by one rounding, though: the
+ * residual of the last combination is added again (one rounding per contribution), the new
+ * contribution is rounded (another one) and the contributions are summed in the lower precision.
+ * For n processes and the unit roundoff u of the lower precision, the error is bounded by about
+ * (n + 1) u times the sum of the absolute contributions.
+ */
+template <typename FG_ELEMENT>
+void CombiCom::distributedGlobalReduceReducedPrecision(
+    DistributedSparseGridUniform<FG_ELEMENT>& dsg,
+    DistributedSparseGridUniform<FG_ELEMENT>& residual, LevelType minLevelSum) {
+  typedef typename abstraction::ReducedPrecision<FG_ELEMENT>::type ReducedType;
+
+  MPI_Comm mycomm = theMPISystem()->getGlobalReduceComm();
+
+  assert(mycomm != MPI_COMM_NULL);
+  assert(residual.getNumSubspaces() == dsg.getNumSubspaces());
+
+  std::vector<size_t> subspaceSizes;
+  reduceSubspaceSizes(dsg, subspaceSizes, mycomm);
+
+  size_t numSubspaces = dsg.getNumSubspaces();
+
+  // the classification only depends on the level, so it is the same on all processes
+  std::vector<bool> reduced(numSubspaces);
+  size_t exactSize = 0;
+  size_t reducedSize = 0;
+
+  for (size_t i = 0; i < numSubspaces; ++i) {
+    const LevelVector& l = dsg.getLevelVector(i);
+    reduced[i] = (std::accumulate(l.begin(), l.end(), LevelType(0)) >= minLevelSum);
+
+    if (reduced[i])
+      reducedSize += subspaceSizes[i];
+    else
+      exactSize += subspaceSizes[i];
+  }
+
+  std::vector<FG_ELEMENT> exactBuf(exactSize);
+  std::vector<ReducedType> reducedBuf(reducedSize);
+  {
+    typename std::vector<FG_ELEMENT>::iterator exact_it = exactBuf.begin();
+    typename std::vector<ReducedType>::iterator reduced_it = reducedBuf.begin();
+
+    for (size_t i = 0; i < numSubspaces; ++i) {
+      const std::vector<FG_ELEMENT>& current = dsg.getDataVector(i);
+
+      if (!reduced[i]) {
+        for (size_t j = 0; j < subspaceSizes[i]; ++j, ++exact_it)
+          *exact_it = current.empty() ? FG_ELEMENT(0) : current[j];
+
+        continue;
+      }
+
+      // round the contribution including the error of the last combination
+      std::vector<FG_ELEMENT>& error = residual.getDataVector(i);
+      error.resize(subspaceSizes[i], FG_ELEMENT(0));
+
+      for (size_t j = 0; j < subspaceSizes[i]; ++j, ++reduced_it) {
+        FG_ELEMENT value = (current.empty() ? FG_ELEMENT(0) : current[j]) + error[j];
+        *reduced_it = static_cast<ReducedType>(value);
+        error[j] = value - static_cast<FG_ELEMENT>(*reduced_it);
       }
     }
   }
+
+  MPILargeCount::allreduce(
+      MPI_IN_PLACE, exactBuf.data(), exactSize,
+      abstraction::getMPIDatatype(abstraction::getabstractionDataType<FG_ELEMENT>()), MPI_SUM,
+      mycomm);
+  MPILargeCount::allreduce(
+      MPI_IN_PLACE, reducedBuf.data(), reducedSize,
+      abstraction::getMPIDatatype(abstraction::getabstractionDataType<ReducedType>()), MPI_SUM,
+      mycomm);
+
+  typename std::vector<FG_ELEMENT>::const_iterator exact_it = exactBuf.begin();
+  typename std::vector<ReducedType>::const_iterator reduced_it = reducedBuf.begin();
+
+  for (size_t i = 0; i < numSubspaces; ++i) {
+    std::vector<FG_ELEMENT>& subspaceData = dsg.getDataVector(i);
+    subspaceData.resize(subspaceSizes[i]);
+
+    if (reduced[i]) {
+      for (size_t j = 0; j < subspaceSizes[i]; ++j, ++reduced_it)
+        subspaceData[j] = static_cast<FG_ELEMENT>(*reduced_it);
+    } else {
+      std::copy(exact_it, exact_it + subspaceSizes[i], subspaceData.begin());
+      exact_it += subspaceSizes[i];
+    }
+  }
+}
+
+inline size_t CombiCom::intersectBoxes(const IndexVector& lower1, const IndexVector& upper1,
+                                       const IndexVector& lower2, const IndexVector& upper2,
+                                       IndexVector& lower, IndexVector& upper) {
+  size_t numPoints = 1;
+
+  lower.resize(lower1.size());
+  upper.resize(lower1.size());
+
+  for (size_t d = 0; d < lower1.size(); ++d) {
+    lower[d] = std::max(lower1[d], lower2[d]);
+    upper[d] = std::min(upper1[d], upper2[d]);
+
+    if (upper[d] <= lower[d]) return 0;
+
+    numPoints *= size_t(upper[d] - lower[d]);
+  }
+
+  return numPoints;
+}
+
+template <typename FG_ELEMENT, typename F>
+void CombiCom::forEachRow(const DistributedFullGrid<FG_ELEMENT>& dfg, const IndexVector& lower,
+                          const IndexVector& upper, F f) {
+  DimType dim = dfg.getDimension();
+  const IndexVector& localLower = dfg.getLowerBounds();
+  const IndexVector& localOffsets = dfg.getLocalOffsets();
+
+  IndexType rowLength = upper[0] - lower[0];
+
+  // index of the current row, the first dimension is not used
+  IndexVector idx(lower);
+
+  while (true) {
+    IndexType localIndex = 0;
+
+    for (DimType d = 0; d < dim; ++d) localIndex += (idx[d] - localLower[d]) * localOffsets[d];
+
+    f(localIndex, rowLength);
+
+    // next row
+    DimType d = 1;
+
+    for (; d < dim; ++d) {
+      if (++idx[d] < upper[d]) break;
+
+      idx[d] = lower[d];
+    }
+
+    if (d >= dim) break;
+  }
+}
+
+/***
+ * Redistribution of a full grid between two decompositions. Every process sends the overlap of
+ * its part of src with the part of each process in dst and receives the overlap of the part of
+ * each process in src with its part in dst. The blocks are packed row by row in the order of
+ * the local data, so sender and receiver agree on the order without additional information.
+ */
+template <typename FG_ELEMENT>
+void CombiCom::redistribute(DistributedFullGrid<FG_ELEMENT>& src,
+                            DistributedFullGrid<FG_ELEMENT>& dst) {
+  assert(src.getLevels() == dst.getLevels());
+  assert(src.returnBoundaryFlags() == dst.returnBoundaryFlags());
+  assert(src.getCommunicatorSize() == dst.getCommunicatorSize());
+
+  int size = src.getCommunicatorSize();
+
+  // both grids are known on all processes
+  std::vector<IndexVector> srcLower(size), srcUpper(size), dstLower(size), dstUpper(size);
+
+  for (int r = 0; r < size; ++r) {
+    srcLower[r] = src.getLowerBounds(r);
+    srcUpper[r] = src.getUpperBounds(r);
+    dstLower[r] = dst.getLowerBounds(r);
+    dstUpper[r] = dst.getUpperBounds(r);
+  }
+
+  // both grids use the same processes, so the communicator of src can be used
+  redistribute(&src, &dst, srcLower, srcUpper, dstLower, dstUpper, src.getCommunicator());
+}
+
+template <typename FG_ELEMENT>
+void CombiCom::redistribute(DistributedFullGrid<FG_ELEMENT>* src,
+                            DistributedFullGrid<FG_ELEMENT>* dst, DimType dim, MPI_Comm comm) {
+  assert(src == nullptr || src->getDimension() == dim);
+  assert(dst == nullptr || dst->getDimension() == dim);
+
+  std::vector<IndexVector> srcLower, srcUpper, dstLower, dstUpper;
+  getBoxes(src, dim, comm, srcLower, srcUpper);
+  getBoxes(dst, dim, comm, dstLower, dstUpper);
+
+  redistribute(src, dst, srcLower, srcUpper, dstLower, dstUpper, comm);
+}
+
+template <typename FG_ELEMENT>
+void CombiCom::getBoxes(const DistributedFullGrid<FG_ELEMENT>* dfg, DimType dim, MPI_Comm comm,
+                        std::vector<IndexVector>& lower, std::vector<IndexVector>& upper) {
+  int size = getCommSize(comm);
+
+  // each process contributes its own box, processes without dfg an empty one
+  std::vector<IndexType> box(2 * dim, 0);
+
+  if (dfg != nullptr) {
+    std::copy(dfg->getLowerBounds().begin(), dfg->getLowerBounds().end(), box.begin());
+    std::copy(dfg->getUpperBounds().begin(), dfg->getUpperBounds().end(), box.begin() + dim);
+  }
+
+  std::vector<IndexType> bounds(2 * dim * size);
+
+  static_assert(sizeof(IndexType) == sizeof(int64_t), "IndexType is sent as MPI_INT64_T");
+  MPI_Allgather(box.data(), static_cast<int>(box.size()), MPI_INT64_T, bounds.data(),
+                static_cast<int>(box.size()), MPI_INT64_T, comm);
+
+  lower.resize(size);
+  upper.resize(size);
+
+  for (int r = 0; r < size; ++r) {
+    lower[r].assign(bounds.begin() + 2 * dim * r, bounds.begin() + 2 * dim * r + dim);
+    upper[r].assign(bounds.begin() + 2 * dim * r + dim, bounds.begin() + 2 * dim * (r + 1));
+  }
+}
+
+template <typename FG_ELEMENT>
+void CombiCom::redistribute(DistributedFullGrid<FG_ELEMENT>* src,
+                            DistributedFullGrid<FG_ELEMENT>* dst,
+                            const std::vector<IndexVector>& srcLower,
+                            const std::vector<IndexVector>& srcUpper,
+                            const std::vector<IndexVector>& dstLower,
+                            const std::vector<IndexVector>& dstUpper, MPI_Comm comm) {
+  assert(src == nullptr || dst == nullptr || src->getLevels() == dst->getLevels());
+
+  int size = getCommSize(comm);
+  int rank = getCommRank(comm);
+
+  std::vector<size_t> sendCounts(size, 0), sendDispls(size, 0), recvCounts(size, 0),
+      recvDispls(size, 0);
+  std::vector<FG_ELEMENT> sendBuf;
+  IndexVector lower, upper;
+
+  // pack the parts of src which belong to each process in dst
+  if (src != nullptr) {
+    const FG_ELEMENT* data = src->getData();
+
+    for (int r = 0; r < size; ++r) {
+      sendDispls[r] = sendBuf.size();
+      sendCounts[r] = intersectBoxes(srcLower[rank], srcUpper[rank], dstLower[r], dstUpper[r],
+                                     lower, upper);
+
+      if (sendCounts[r] == 0) continue;
+
+      forEachRow(*src, lower, upper, [&](IndexType localIndex, IndexType length) {
+        sendBuf.insert(sendBuf.end(), data + localIndex, data + localIndex + length);
+      });
+    }
+  }
+
+  size_t recvSize = 0;
+
+  if (dst != nullptr) {
+    for (int r = 0; r < size; ++r) {
+      recvDispls[r] = recvSize;
+      recvCounts[r] = intersectBoxes(srcLower[r], srcUpper[r], dstLower[rank], dstUpper[rank],
+                                     lower, upper);
+      recvSize += recvCounts[r];
+    }
+  }
+
+  std::vector<FG_ELEMENT> recvBuf(recvSize);
+
+  MPI_Datatype dtype =
+      abstraction::getMPIDatatype(abstraction::getabstractionDataType<FG_ELEMENT>());
+  MPILargeCount::alltoallv(sendBuf.data(), sendCounts, sendDispls, recvBuf.data(), recvCounts,
+                           recvDispls, dtype, comm);
+
+  if (dst == nullptr) return;
+
+  // unpack in the same order
+  FG_ELEMENT* data = dst->getData();
+
+  for (int r = 0; r < size; ++r) {
+    if (recvCounts[r] == 0) continue;
+
+    intersectBoxes(srcLower[r], srcUpper[r], dstLower[rank], dstUpper[rank], lower, upper);
+
+    typename std::vector<FG_ELEMENT>::const_iterator it = recvBuf.begin() + recvDispls[r];
+    forEachRow(*dst, lower, upper, [&](IndexType localIndex, IndexType length) {
+      std::copy(it, it + length, data + localIndex);
+      it += length;
+    });
+  }
 }
 
 } /* namespace combigrid */
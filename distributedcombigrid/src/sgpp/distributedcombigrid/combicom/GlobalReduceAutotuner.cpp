@@ -0,0 +1,95 @@
+#include "sgpp/distributedcombigrid/combicom/GlobalReduceAutotuner.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <sstream>
+
+namespace combigrid {
+
+GlobalReduceAutotuner::GlobalReduceAutotuner(const std::string& tuningFile)
+    : tuningFile_(tuningFile),
+      loaded_(false),
+      // the scatter type strategies leave the subspaces which are not needed by a
+      // process unallocated, so they are no alternative to a full reduction
+      candidates_({GLOBAL_REDUCE_ALLREDUCE, GLOBAL_REDUCE_HIERARCHICAL}) {}
+
+std::string GlobalReduceAutotuner::getKey(const LevelVector& lmin, const LevelVector& lmax,
+                                          const IndexVector& parallelization, int numGroups) {
+  std::stringstream ss;
+  ss << "lmin=" << toString(lmin) << ";lmax=" << toString(lmax)
+     << ";p=" << toString(parallelization) << ";groups=" << numGroups;
+  return ss.str();
+}
+
+GlobalReduceType GlobalReduceAutotuner::select(const std::string& key) {
+  if (isTuned(key)) return winners_[key].first;
+
+  // next candidate which has not been measured
+  const std::map<GlobalReduceType, double>& times = timings_[key];
+
+  for (GlobalReduceType type : candidates_) {
+    if (times.find(type) == times.end()) return type;
+  }
+
+  assert(false && "all candidates measured but no winner");
+  return GLOBAL_REDUCE_ALLREDUCE;
+}
+
+bool GlobalReduceAutotuner::isTuned(const std::string& key) {
+  if (!loaded_) load();
+
+  return winners_.find(key) != winners_.end();
+}
+
+void GlobalReduceAutotuner::record(const std::string& key, GlobalReduceType type, double time,
+                                   bool write) {
+  if (isTuned(key)) return;
+
+  std::map<GlobalReduceType, double>& times = timings_[key];
+  times[type] = time;
+
+  if (times.size() < candidates_.size()) return;
+
+  // all candidates measured -> the fastest one wins
+  std::pair<GlobalReduceType, double> winner(candidates_[0], times[candidates_[0]]);
+
+  for (GlobalReduceType t : candidates_) {
+    if (times[t] < winner.second) winner = std::make_pair(t, times[t]);
+  }
+
+  winners_[key] = winner;
+  timings_.erase(key);
+
+  if (write) save();
+}
+
+void GlobalReduceAutotuner::load() {
+  loaded_ = true;
+
+  if (tuningFile_.empty()) return;
+
+  // a missing file is not an error, it is created after the first class is tuned
+  std::ifstream ifs(tuningFile_.c_str());
+  std::string key;
+  GlobalReduceType type;
+  double time;
+
+  while (ifs >> key >> type >> time) {
+    // winners of files with other candidates have to be tuned again
+    if (std::find(candidates_.begin(), candidates_.end(), type) != candidates_.end())
+      winners_[key] = std::make_pair(type, time);
+  }
+}
+
+void GlobalReduceAutotuner::save() const {
+  if (tuningFile_.empty()) return;
+
+  std::ofstream ofs(tuningFile_.c_str());
+
+  for (const auto& winner : winners_) {
+    ofs << winner.first << " " << winner.second.first << " " << winner.second.second << std::endl;
+  }
+}
+
+} /* namespace combigrid */
@@ -0,0 +1,81 @@
+#ifndef SRC_SGPP_COMBIGRID_COMBICOM_GLOBALREDUCEAUTOTUNER_HPP_
+#define SRC_SGPP_COMBIGRID_COMBICOM_GLOBALREDUCEAUTOTUNER_HPP_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "sgpp/distributedcombigrid/manager/ProcessGroupSignals.hpp"
+#include "sgpp/distributedcombigrid/utils/LevelVector.hpp"
+
+namespace combigrid {
+
+/* runtime selection of the global reduce strategy (see ProcessGroupSignals.hpp).
+ *
+ * this does not select between the local reduce variants of CombiCom
+ * (distributedLocalReduce, ...NB, ...Red, ...SGR, ...Block). they work on the non-uniform
+ * DistributedSparseGrid, which the combination does not use, and they rely on subspace
+ * bounds which DistributedFullGrid no longer provides. the local reduce of the uniform
+ * combination (DistributedFullGrid::addToUniformSG) has only one variant and needs no
+ * communication, so there is nothing to tune per level vector and decomposition of the
+ * task grids.
+ *
+ * which strategy is the fastest depends on the sparse grid (lmin, lmax), the
+ * decomposition and the number of process groups. for each such class the
+ * candidates are tried one after another in the first combinations. the candidate
+ * with the lowest time becomes the winner, which is used in all following
+ * combinations. winners are kept in a tuning file, so later runs with the same
+ * setup start with the winner directly.
+ *
+ * only the strategies which give the full combined sparse grid on all processes are
+ * candidates (allreduce and hierarchical). reduce-scatter and RMA leave the subspaces
+ * which a process does not need unallocated and are only used if requested
+ * explicitly.
+ *
+ * the timings passed to record have to be the same on all processes which use the
+ * tuner (e.g. the maximum over all workers), otherwise processes could select
+ * different strategies.
+ */
+class GlobalReduceAutotuner {
+ public:
+  // an empty file name disables the persistence
+  explicit GlobalReduceAutotuner(const std::string& tuningFile = "");
+
+  // identifier of the class of a global reduction
+  static std::string getKey(const LevelVector& lmin, const LevelVector& lmax,
+                            const IndexVector& parallelization, int numGroups);
+
+  // returns the winner of key if known, otherwise the next candidate to measure
+  GlobalReduceType select(const std::string& key);
+
+  // true if the winner of key is known
+  bool isTuned(const std::string& key);
+
+  // store the time of the reduction with type for key. once all candidates have
+  // been measured the winner is determined and, if write is true, the tuning file
+  // is updated
+  void record(const std::string& key, GlobalReduceType type, double time, bool write);
+
+  inline const std::vector<GlobalReduceType>& getCandidates() const { return candidates_; }
+
+ private:
+  void load();
+
+  void save() const;
+
+  std::string tuningFile_;
+
+  bool loaded_;
+
+  std::vector<GlobalReduceType> candidates_;
+
+  // winner and its time for each class
+  std::map<std::string, std::pair<GlobalReduceType, double> > winners_;
+
+  // measured time of each candidate for classes which are not tuned yet
+  std::map<std::string, std::map<GlobalReduceType, double> > timings_;
+};
+
+} /* namespace combigrid */
+
+#endif /* SRC_SGPP_COMBIGRID_COMBICOM_GLOBALREDUCEAUTOTUNER_HPP_ */
@@ -5,6 +5,7 @@
 #include <iostream>
 #include <numeric>
 #include "sgpp/distributedcombigrid/fullgrid/FullGrid.hpp"
+#include "sgpp/distributedcombigrid/mpi/MPILargeCount.hpp"
 #include "sgpp/distributedcombigrid/mpi/MPISystem.hpp"
 #include "sgpp/distributedcombigrid/sparsegrid/DistributedSparseGridUniform.hpp"
 #include "sgpp/distributedcombigrid/sparsegrid/SGrid.hpp"
@@ -62,7 +63,8 @@ class DistributedFullGrid {
                       bool forwardDecomposition = true,
                       const std::vector<IndexVector>& decomposition = std::vector<IndexVector>(),
                       const BasisFunctionBasis* basis = NULL)
-                      : dim_(dim), levels_(levels), procs_(procs)  {
+                      : dim_(dim), levels_(levels), procs_(procs),
+                        forwardDecomposition_(forwardDecomposition)  {
     assert(levels.size() == dim);
     assert(hasBdrPoints.size() == dim);
     assert(procs.size() == dim);
@@ -915,8 +917,11 @@ class DistributedFullGrid {
     // each rank: send subspace to dst
     // important: skip this if send size = 0
     if (subsp.data_.size() > 0) {
-      MPI_Send(subsp.data_.data(), int(subsp.data_.size()), this->getMPIDatatype(), dst, 0,
-               this->getCommunicator());
+      MPI_Datatype sendType;
+      int sendCount =
+          MPILargeCount::createLargeType(subsp.data_.size(), this->getMPIDatatype(), &sendType);
+      MPI_Send(subsp.data_.data(), sendCount, sendType, dst, 0, this->getCommunicator());
+      MPILargeCount::freeLargeType(&sendType, this->getMPIDatatype());
     }
 
     if (rank_ == dst) {
@@ -1003,10 +1008,15 @@ class DistributedFullGrid {
     // each rank: send subspace to dst
     // important: skip this if send size = 0
     if (subsp.data_.size() > 0) {
+      MPI_Datatype sendType;
+      int sendCount =
+          MPILargeCount::createLargeType(subsp.data_.size(), this->getMPIDatatype(), &sendType);
       MPI_Request sendRequest;
-      MPI_Isend(subsp.data_.data(), int(subsp.data_.size()), this->getMPIDatatype(), dst, tag,
-                this->getCommunicator(), &sendRequest);
+      MPI_Isend(subsp.data_.data(), sendCount, sendType, dst, tag, this->getCommunicator(),
+                &sendRequest);
       requests.push_back(sendRequest);
+      // the datatype is only marked for deallocation, the pending send is not affected
+      MPILargeCount::freeLargeType(&sendType, this->getMPIDatatype());
     }
 
     // rank r: for each rank create subarray view on fg
@@ -1054,8 +1064,12 @@ class DistributedFullGrid {
     bool recvd(false);
 
     if (subsp.data_.size() > 0) {
-      MPI_Irecv(subsp.data_.data(), int(subsp.data_.size()), this->getMPIDatatype(), src, 0,
-                this->getCommunicator(), &recvRequest);
+      MPI_Datatype recvType;
+      int recvCount =
+          MPILargeCount::createLargeType(subsp.data_.size(), this->getMPIDatatype(), &recvType);
+      MPI_Irecv(subsp.data_.data(), recvCount, recvType, src, 0, this->getCommunicator(),
+                &recvRequest);
+      MPILargeCount::freeLargeType(&recvType, this->getMPIDatatype());
       recvd = true;
     }
 
@@ -1233,27 +1247,10 @@ class DistributedFullGrid {
   // write data to file using MPI-IO
   void writePlotFile(const char* filename) const {
     auto dim = getDimension();
-
-    // create subarray data type
     IndexVector sizes = getGlobalSizes();
-    IndexVector subsizes = getUpperBounds() - getLowerBounds();
-    IndexVector starts = getLowerBounds();
-
-    // we store our data in c format, i.e. first dimension is the innermost
-    // dimension. however, we access our data in fortran notation, with the
-    // first index in indexvectors being the first dimension.
-    // to comply with an ordering that mpi understands, we have to reverse
-    // our index vectors
-    // also we have to use int as datatype
-    std::vector<int> csizes(sizes.rbegin(), sizes.rend());
-    std::vector<int> csubsizes(subsizes.rbegin(), subsizes.rend());
-    std::vector<int> cstarts(starts.rbegin(), starts.rend());
 
     // create subarray view on data
-    MPI_Datatype mysubarray;
-    MPI_Type_create_subarray(static_cast<int>(getDimension()), &csizes[0], &csubsizes[0],
-                             &cstarts[0], MPI_ORDER_C, getMPIDatatype(), &mysubarray);
-    MPI_Type_commit(&mysubarray);
+    MPI_Datatype mysubarray = createLocalSubarrayType();
 
     // open file
     MPI_File fh;
@@ -1262,10 +1259,11 @@ class DistributedFullGrid {
 
     // rank 0 write dim and resolution (and data format?)
     if (rank_ == 0) {
-      MPI_File_write(fh, &dim, 1, MPI_INT, MPI_STATUS_IGNORE);
+      int idim = static_cast<int>(dim);
+      MPI_File_write(fh, &idim, 1, MPI_INT, MPI_STATUS_IGNORE);
 
       std::vector<int> res(sizes.begin(), sizes.end());
-      MPI_File_write(fh, &res[0], 6, MPI_INT, MPI_STATUS_IGNORE);
+      MPI_File_write(fh, &res[0], idim, MPI_INT, MPI_STATUS_IGNORE);
     }
 
     // set file view to right offset (in bytes)
@@ -1274,15 +1272,156 @@ class DistributedFullGrid {
     MPI_File_set_view(fh, offset, getMPIDatatype(), mysubarray, "native", MPI_INFO_NULL);
 
     // write subarray
-    MPI_File_write_all(fh, getData(), getNrLocalElements(), getMPIDatatype(), MPI_STATUS_IGNORE);
+    // the number of local elements may exceed the range of int
+    MPI_Datatype writeType;
+    int writeCount =
+        MPILargeCount::createLargeType(getNrLocalElements(), getMPIDatatype(), &writeType);
+    MPI_File_write_all(fh, getData(), writeCount, writeType, MPI_STATUS_IGNORE);
+    MPILargeCount::freeLargeType(&writeType, getMPIDatatype());
 
     // close file
     MPI_File_close(&fh);
   }
 
+  /* write the values of the grid to fh, starting at offset (in bytes), in the order of
+   * the global full grid. the file content does not depend on the decomposition, so it
+   * can be read into a grid with another parallelization. collective over the
+   * processes of fh, processes which do not hold this grid call writeEmptyToFile
+   */
+  void writeToFile(MPI_File fh, MPI_Offset offset) const {
+    MPI_Datatype fileType = createLocalSubarrayType();
+    MPI_File_set_view(fh, offset, getMPIDatatype(), fileType, "native", MPI_INFO_NULL);
+
+    MPI_Datatype writeType;
+    int writeCount =
+        MPILargeCount::createLargeType(getNrLocalElements(), getMPIDatatype(), &writeType);
+    MPI_File_write_all(fh, getData(), writeCount, writeType, MPI_STATUS_IGNORE);
+    MPILargeCount::freeLargeType(&writeType, getMPIDatatype());
+
+    MPI_Type_free(&fileType);
+    resetFileView(fh);
+  }
+
+  // counterpart of writeToFile
+  void readFromFile(MPI_File fh, MPI_Offset offset) {
+    MPI_Datatype fileType = createLocalSubarrayType();
+    MPI_File_set_view(fh, offset, getMPIDatatype(), fileType, "native", MPI_INFO_NULL);
+
+    MPI_Datatype readType;
+    int readCount =
+        MPILargeCount::createLargeType(getNrLocalElements(), getMPIDatatype(), &readType);
+    MPI_File_read_all(fh, getData(), readCount, readType, MPI_STATUS_IGNORE);
+    MPILargeCount::freeLargeType(&readType, getMPIDatatype());
+
+    MPI_Type_free(&fileType);
+    resetFileView(fh);
+  }
+
+  // take part in writeToFile of a grid which is not held by this process
+  static void writeEmptyToFile(MPI_File fh) {
+    MPI_Datatype dtype =
+        abstraction::getMPIDatatype(abstraction::getabstractionDataType<FG_ELEMENT>());
+    MPI_File_set_view(fh, 0, dtype, dtype, "native", MPI_INFO_NULL);
+    MPI_File_write_all(fh, nullptr, 0, dtype, MPI_STATUS_IGNORE);
+    resetFileView(fh);
+  }
+
+  // take part in readFromFile of a grid which is not held by this process
+  static void readEmptyFromFile(MPI_File fh) {
+    MPI_Datatype dtype =
+        abstraction::getMPIDatatype(abstraction::getabstractionDataType<FG_ELEMENT>());
+    MPI_File_set_view(fh, 0, dtype, dtype, "native", MPI_INFO_NULL);
+    MPI_File_read_all(fh, nullptr, 0, dtype, MPI_STATUS_IGNORE);
+    resetFileView(fh);
+  }
+
   std::vector<IndexVector>& getDecomposition() { return decomposition_; }
 
+  // true if grid points on process boundaries belong to the right-hand process
+  bool isForwardDecomposition() const { return forwardDecomposition_; }
+
+  /* lower bounds of the parts of numPoints grid points in one dimension which is split
+   * into numProcs parts, see calculateDefaultBounds
+   */
+  static IndexVector getDefaultBounds1D(IndexType numPoints, IndexType numProcs,
+                                        bool forwardDecomposition) {
+    IndexVector llbnd(numProcs);
+
+    for (IndexType j = 0; j < numProcs; ++j) {
+      double tmp = static_cast<double>(numPoints) * static_cast<double>(j) /
+                   static_cast<double>(numProcs);
+
+      if (forwardDecomposition)
+        llbnd[j] = static_cast<IndexType>(std::ceil(tmp));
+      else
+        llbnd[j] = static_cast<IndexType>(std::floor(tmp));
+    }
+
+    return llbnd;
+  }
+
+  /* number of elements of the largest local part of a grid with the given levels and the
+   * default decomposition, which is the memory the grid needs on a single process
+   */
+  static IndexType getMaxNrLocalElements(const LevelVector& levels,
+                                         const std::vector<bool>& hasBdrPoints,
+                                         const IndexVector& procs, bool forwardDecomposition) {
+    IndexType numElements = 1;
+
+    for (size_t i = 0; i < levels.size(); ++i) {
+      IndexType numPoints =
+          hasBdrPoints[i] ? (powerOfTwo[levels[i]] + 1) : (powerOfTwo[levels[i]] - 1);
+      IndexVector llbnd = getDefaultBounds1D(numPoints, procs[i], forwardDecomposition);
+      llbnd.push_back(numPoints);
+
+      IndexType largest = 0;
+
+      for (IndexType j = 0; j < procs[i]; ++j)
+        largest = std::max(largest, llbnd[j + 1] - llbnd[j]);
+
+      numElements *= largest;
+    }
+
+    return numElements;
+  }
+
  private:
+  // view on the local part of the grid within the global full grid
+  MPI_Datatype createLocalSubarrayType() const {
+    // a process without grid points does not access the file, any view will do
+    if (getNrLocalElements() == 0) {
+      MPI_Datatype view;
+      MPI_Type_dup(getMPIDatatype(), &view);
+      return view;
+    }
+
+    IndexVector sizes = getGlobalSizes();
+    IndexVector subsizes = getUpperBounds() - getLowerBounds();
+    IndexVector starts = getLowerBounds();
+
+    // we store our data in c format, i.e. first dimension is the innermost
+    // dimension. however, we access our data in fortran notation, with the
+    // first index in indexvectors being the first dimension.
+    // to comply with an ordering that mpi understands, we have to reverse
+    // our index vectors
+    // also we have to use int as datatype
+    std::vector<int> csizes(sizes.rbegin(), sizes.rend());
+    std::vector<int> csubsizes(subsizes.rbegin(), subsizes.rend());
+    std::vector<int> cstarts(starts.rbegin(), starts.rend());
+
+    MPI_Datatype mysubarray;
+    MPI_Type_create_subarray(static_cast<int>(getDimension()), &csizes[0], &csubsizes[0],
+                             &cstarts[0], MPI_ORDER_C, getMPIDatatype(), &mysubarray);
+    MPI_Type_commit(&mysubarray);
+
+    return mysubarray;
+  }
+
+  // back to the default view of a file (bytes, starting at 0)
+  static void resetFileView(MPI_File fh) {
+    MPI_File_set_view(fh, 0, MPI_BYTE, MPI_BYTE, "native", MPI_INFO_NULL);
+  }
+
   /** dimension of the full grid */
   DimType dim_;
 
@@ -1331,6 +1470,9 @@ class DistributedFullGrid {
   /** number of procs in every dimension */
   IndexVector procs_;
 
+  /** see calculateDefaultBounds */
+  bool forwardDecomposition_;
+
   /** mpi rank */
   RankType rank_;
 
@@ -1427,20 +1569,8 @@ class DistributedFullGrid {
   void calculateDefaultBounds(bool forwardDecomposition) {
     std::vector<IndexVector> llbounds(dim_);
 
-    for (DimType i = 0; i < dim_; ++i) {
-      IndexVector& llbnd = llbounds[i];
-      llbnd.resize(procs_[i]);
-
-      for (IndexType j = 0; j < procs_[i]; ++j) {
-        double tmp = static_cast<double>(nrPoints_[i]) * static_cast<double>(j) /
-                     static_cast<double>(procs_[i]);
-
-        if (forwardDecomposition)
-          llbnd[j] = static_cast<IndexType>(std::ceil(tmp));
-        else
-          llbnd[j] = static_cast<IndexType>(std::floor(tmp));
-      }
-    }
+    for (DimType i = 0; i < dim_; ++i)
+      llbounds[i] = getDefaultBounds1D(nrPoints_[i], procs_[i], forwardDecomposition);
 
     for (RankType r = 0; r < size_; ++r) {
       // get coords of r in cart comm
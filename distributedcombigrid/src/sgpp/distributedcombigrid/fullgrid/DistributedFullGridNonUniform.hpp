@@ -5,6 +5,7 @@
 #include <iostream>
 #include <numeric>
 #include "sgpp/distributedcombigrid/fullgrid/FullGrid.hpp"
+#include "sgpp/distributedcombigrid/mpi/MPILargeCount.hpp"
 #include "sgpp/distributedcombigrid/mpi/MPISystem.hpp"
 #include "sgpp/distributedcombigrid/sparsegrid/DistributedSparseGridUniform.hpp"
 #include "sgpp/distributedcombigrid/sparsegrid/SGrid.hpp"
@@ -989,8 +990,11 @@ class DistributedFullGridNonUniform {
     // each rank: send subspace to dst
     // important: skip this if send size = 0
     if (subsp.data_.size() > 0) {
-      MPI_Send(subsp.data_.data(), int(subsp.data_.size()), this->getMPIDatatype(), dst, 0,
-               this->getCommunicator());
+      MPI_Datatype sendType;
+      int sendCount =
+          MPILargeCount::createLargeType(subsp.data_.size(), this->getMPIDatatype(), &sendType);
+      MPI_Send(subsp.data_.data(), sendCount, sendType, dst, 0, this->getCommunicator());
+      MPILargeCount::freeLargeType(&sendType, this->getMPIDatatype());
     }
 
     if (rank_ == dst) {
@@ -1128,10 +1132,15 @@ class DistributedFullGridNonUniform {
     // each rank: send subspace to dst
     // important: skip this if send size = 0
     if (subsp.data_.size() > 0) {
+      MPI_Datatype sendType;
+      int sendCount =
+          MPILargeCount::createLargeType(subsp.data_.size(), this->getMPIDatatype(), &sendType);
       MPI_Request sendRequest;
-      MPI_Isend(subsp.data_.data(), int(subsp.data_.size()), this->getMPIDatatype(), dst, tag,
-                this->getCommunicator(), &sendRequest);
+      MPI_Isend(subsp.data_.data(), sendCount, sendType, dst, tag, this->getCommunicator(),
+                &sendRequest);
       requests.push_back(sendRequest);
+      // the datatype is only marked for deallocation, the pending send is not affected
+      MPILargeCount::freeLargeType(&sendType, this->getMPIDatatype());
     }
 
     // rank r: for each rank create subarray view on fg
@@ -1179,8 +1188,12 @@ class DistributedFullGridNonUniform {
     bool recvd(false);
 
     if (subsp.data_.size() > 0) {
-      MPI_Irecv(subsp.data_.data(), int(subsp.data_.size()), this->getMPIDatatype(), src, 0,
-                this->getCommunicator(), &recvRequest);
+      MPI_Datatype recvType;
+      int recvCount =
+          MPILargeCount::createLargeType(subsp.data_.size(), this->getMPIDatatype(), &recvType);
+      MPI_Irecv(subsp.data_.data(), recvCount, recvType, src, 0, this->getCommunicator(),
+                &recvRequest);
+      MPILargeCount::freeLargeType(&recvType, this->getMPIDatatype());
       recvd = true;
     }
 
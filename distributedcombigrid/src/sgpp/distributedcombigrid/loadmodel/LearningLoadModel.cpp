@@ -1,7 +1,12 @@
+#include <algorithm>
+#include <cassert>
+#include <fstream>
 #include <iostream>
 #include <string>
 #include <chrono>
+#include <cmath>
 #include <memory>
+#include <sstream>
 #include <thread>
 #include <sys/stat.h>
 
@@ -10,19 +15,6 @@
 
 namespace combigrid {
 
-  unsigned long int getAverageOfFirstColumn(std::istream& fs){
-    std::string line, val;
-    unsigned long int sum=0, count=0;
-    while (std::getline (fs, line)) { 
-      std::stringstream s (line);
-      /* get first value (',' delimited) */
-      getline (s, val, ',');       
-      sum += std::stoul (val);
-      ++count;
-    }
-    return sum/count;
-  }
- 
   void LearningLoadModel::addLevelVectorToLoadModel(const LevelVector& lv) {
     durationsOfLevels_->insert(make_pair(lv, std::deque<durationInformation>()));
 
@@ -30,13 +22,17 @@ namespace combigrid {
     // if file exists, read contents
     if (stat(getFilename(lv).c_str(), &buf) != -1){
       std::fstream fs;
-      fs.open(getFilename(lv), std::fstream::in | std::fstream::app);
-      fs.seekg(0, std::ios::beg);
-      fs.clear();
-      if (fs.peek() != EOF) {
-        last_durations_avg_.insert(make_pair(lv, getAverageOfFirstColumn(fs)));
+      fs.open(getFilename(lv), std::fstream::in);
+      std::string line;
+      // columns: duration, dt, simulation time, process group, number of processes
+      while (std::getline(fs, line)) {
+        std::stringstream s(line);
+        real duration, dt, simtime, nProcesses;
+        int pgroup;
+        if (s >> duration >> dt >> simtime >> pgroup >> nProcesses) {
+          addMeasurement(lv, duration, nProcesses, dt);
+        }
       }
-      fs.clear();
       fs.close();
     }
     // else, make new empty file
@@ -47,5 +43,167 @@ namespace combigrid {
     }
 
   }
-} /* namespace combigrid */
 
+  real LearningLoadModel::eval(const LevelVector& l) {
+    auto cached = loads_.find(l);
+
+    if (cached != loads_.end()) return cached->second;
+
+    real ret(0.0);
+    auto measured = measurements_.find(l);
+
+    if (measured != measurements_.end() && !measured->second.empty()) {
+      // mean of the measured process times at the time step of the predictions, the
+      // measurements with other time steps are scaled by the fitted power of dt
+      real exponent(0.0), logDt(0.0);
+
+      if (numRegressionPoints_ > 0) {
+        if (!regressionFitted_) fitRegression();
+
+        const size_t n = coefficients_.size();
+        exponent = coefficients_[n - 1];
+        logDt = gram_[n - 1] / static_cast<real>(numRegressionPoints_);
+      }
+
+      for (const auto& m : measured->second)
+        ret += m.first * std::exp(exponent * (logDt - m.second));
+
+      ret /= static_cast<real>(measured->second.size());
+    } else if (numRegressionPoints_ > 0) {
+      ret = predict(l);
+    } else {
+      // no data yet, use linear load model
+      LinearLoadModel llm = LinearLoadModel();
+      ret = llm.eval(l);
+    }
+
+    loads_[l] = ret;
+
+    return ret;
+  }
+
+  void LearningLoadModel::addMeasurement(const LevelVector& l, real duration, real nProcesses,
+                                         real dt) {
+    // durations of groups of different size are compared by their process time
+    const real processTime = duration * std::max(nProcesses, real(1.0));
+
+    std::vector<real> x = getFeatures(l, nProcesses, dt);
+    const size_t n = x.size();
+
+    measurements_[l].emplace_back(processTime, x[n - 1]);
+
+    loads_.clear();
+
+    // the logarithm needs positive durations
+    if (processTime <= 0.0) return;
+
+    if (gram_.empty()) {
+      gram_.assign(n * n, 0.0);
+      moments_.assign(n, 0.0);
+    }
+
+    assert(moments_.size() == n && "all level vectors need the same dimension");
+
+    const real y = std::log(processTime);
+
+    for (size_t i = 0; i < n; ++i) {
+      for (size_t j = 0; j < n; ++j) gram_[i * n + j] += x[i] * x[j];
+
+      moments_[i] += x[i] * y;
+    }
+
+    ++numRegressionPoints_;
+    regressionFitted_ = false;
+  }
+
+  std::vector<real> LearningLoadModel::getFeatures(const LevelVector& l, real nProcesses,
+                                                   real dt) const {
+    // intercept, level of each dimension, processes and time step
+    std::vector<real> x;
+    x.reserve(l.size() + 3);
+    x.push_back(1.0);
+
+    for (LevelType li : l) x.push_back(static_cast<real>(li));
+
+    x.push_back(std::log(std::max(nProcesses, real(1.0))));
+    // tasks without time step (dt = 0) do not depend on it
+    x.push_back(dt > 0.0 ? std::log(dt) : 0.0);
+
+    return x;
+  }
+
+  void LearningLoadModel::fitRegression() {
+    const size_t n = moments_.size();
+    const size_t dim = n - 3;
+
+    // ridge regression towards the linear load model: the durations grow with 2^l
+    // in each dimension and scale perfectly with the number of processes, i.e. the
+    // process time does not depend on it
+    std::vector<real> prior(n, 0.0);
+
+    for (size_t d = 0; d < dim; ++d) prior[1 + d] = std::log(real(2.0));
+
+    const real lambda(1.0);
+
+    std::vector<real> a(gram_), b(moments_);
+
+    // the intercept is not regularized
+    for (size_t i = 1; i < n; ++i) {
+      a[i * n + i] += lambda;
+      b[i] += lambda * prior[i];
+    }
+
+    // gaussian elimination with partial pivoting, a is positive definite
+    for (size_t k = 0; k < n; ++k) {
+      size_t pivot = k;
+
+      for (size_t i = k + 1; i < n; ++i) {
+        if (std::abs(a[i * n + k]) > std::abs(a[pivot * n + k])) pivot = i;
+      }
+
+      if (pivot != k) {
+        for (size_t j = 0; j < n; ++j) std::swap(a[k * n + j], a[pivot * n + j]);
+
+        std::swap(b[k], b[pivot]);
+      }
+
+      for (size_t i = k + 1; i < n; ++i) {
+        real f = a[i * n + k] / a[k * n + k];
+
+        for (size_t j = k; j < n; ++j) a[i * n + j] -= f * a[k * n + j];
+
+        b[i] -= f * b[k];
+      }
+    }
+
+    coefficients_.assign(n, 0.0);
+
+    for (size_t k = n; k-- > 0;) {
+      real r = b[k];
+
+      for (size_t j = k + 1; j < n; ++j) r -= a[k * n + j] * coefficients_[j];
+
+      coefficients_[k] = r / a[k * n + k];
+    }
+
+    regressionFitted_ = true;
+  }
+
+  real LearningLoadModel::predict(const LevelVector& l) {
+    if (!regressionFitted_) fitRegression();
+
+    const size_t n = coefficients_.size();
+    assert(l.size() + 3 == n && "all level vectors need the same dimension");
+
+    // the mean (log) number of processes and time step of the measurements
+    const real count = static_cast<real>(numRegressionPoints_);
+    real y = coefficients_[0];
+
+    for (size_t d = 0; d < l.size(); ++d) y += coefficients_[1 + d] * static_cast<real>(l[d]);
+
+    y += coefficients_[n - 2] * gram_[n - 2] / count;
+    y += coefficients_[n - 1] * gram_[n - 1] / count;
+
+    return std::exp(y);
+  }
+} /* namespace combigrid */
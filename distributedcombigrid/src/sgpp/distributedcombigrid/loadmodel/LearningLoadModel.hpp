@@ -3,7 +3,10 @@
 
 #include <deque>
 #include <limits>
+#include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "sgpp/distributedcombigrid/loadmodel/LinearLoadModel.hpp"
 #include "sgpp/distributedcombigrid/loadmodel/LoadModel.hpp"
@@ -47,12 +50,31 @@ static std::string getFilename(const LevelVector& levelVector){
   return "./l_" + toString(levelVector) + ".durations";//TODO which directory
 }
 
-unsigned long int getAverageOfFirstColumn(std::istream& fs);
-
+/* load model which learns from the measured durations of the tasks.
+ *
+ * the load is the time of all processes of a task (duration times nProcesses), like
+ * the capacities of the schedulers, which are the sizes of the groups. the loads are
+ * given by a log-linear regression over all measurements, i.e. a power law in the
+ * number of points of each dimension, the number of processes and the time step:
+ *
+ *   log(duration * nProcesses) = c_0 + sum_d c_d l_d + c_p log(nProcesses) + c_t log(dt)
+ *
+ * the coefficients are a ridge regression towards the linear load model
+ * (c_d = log 2, perfect strong scaling c_p = 0 and c_t = 0), so that few
+ * measurements only scale the linear load model to the measured durations. the
+ * predictions use the mean (log) number of processes and time step of the
+ * measurements. a level vector which has been measured (in this run or in the
+ * .durations files of previous runs) gets the mean of its process times instead,
+ * each scaled to the same time step with the fitted c_t. the normal equations are
+ * updated with every data point, the loads are cached until the next data point
+ * arrives.
+ */
 class LearningLoadModel : public LoadModel {
  public:
   LearningLoadModel(std::vector<LevelVector> levelVectors) :
-  writeEveryNCombis_(50)
+  writeEveryNCombis_(50),
+  numRegressionPoints_(0),
+  regressionFitted_(false)
   {
     durationsOfLevels_ =
         std::unique_ptr<std::map<LevelVector, std::deque<durationInformation>>>(
@@ -62,10 +84,15 @@ class LearningLoadModel : public LoadModel {
     }
   }
 
-  inline real eval(const LevelVector& l);
+  virtual real eval(const LevelVector& l);
 
   ~LearningLoadModel() {
     // upon destruction, write data gathered to file
+    writeDurationsToFiles();
+  }
+
+  // write all durations which are still kept in memory to the files of the model
+  void writeDurationsToFiles() {
     for (const auto& item : *durationsOfLevels_) {
       LevelVector lv = item.first;
       writeDurationsToFile(lv);
@@ -73,6 +100,11 @@ class LearningLoadModel : public LoadModel {
   }
 
   void addDataPoint(durationInformation dI, LevelVector l) {
+    // level vectors which were not known at construction, e.g. of tasks added later
+    if (!durationsOfLevels_->count(l)) addLevelVectorToLoadModel(l);
+
+    addMeasurement(l, real(dI.duration), real(dI.nProcesses), dI.real_dt);
+
     durationsOfLevels_->at(l).push_back(dI);
     // write to file intermediately for long simulations
     // if (durationsOfLevels_->at(l).size() > writeEveryNCombis_*2) {
@@ -85,8 +117,21 @@ class LearningLoadModel : public LoadModel {
  private:
   size_t writeEveryNCombis_;
 
+  // add lv and the measurements of its file
   void addLevelVectorToLoadModel(const LevelVector& lv);
 
+  // add the process time of l and update the normal equations of the regression
+  void addMeasurement(const LevelVector& l, real duration, real nProcesses, real dt);
+
+  // (log) features of the regression
+  std::vector<real> getFeatures(const LevelVector& l, real nProcesses, real dt) const;
+
+  // solve the normal equations for the coefficients of the regression
+  void fitRegression();
+
+  // predicted duration of a level vector without measurements
+  real predict(const LevelVector& l);
+
   // durations that are written to file will be removed from the referenced deque
   void writeDurationsToFile(const LevelVector& lv,
                             std::deque<durationInformation>& durations,
@@ -114,33 +159,24 @@ class LearningLoadModel : public LoadModel {
 
   std::unique_ptr<std::map<LevelVector, std::deque<durationInformation>>>
       durationsOfLevels_;
-  std::map<LevelVector, long unsigned int> last_durations_avg_;
-};
 
-inline real LearningLoadModel::eval(const LevelVector& l) {
-  // std::cout << "eval loadmodel at " << toString(l) << std::endl;
-  real ret(0.0);
-  if (durationsOfLevels_->at(l).empty()) {
-    // if no data yet, use linear load model
-    if (!last_durations_avg_.count(l)) {
-      // std::cout << "using linear load model for initial guess" << std::endl;
-      LinearLoadModel llm = LinearLoadModel();
-      ret = llm.eval(l);
-    } else {
-      // use data from last time
-      // std::cout << "using recoded average of " << last_durations_avg_[l] << " for " << toString(l)
-                // << std::endl;
-      ret = last_durations_avg_[l];
-    }
-  } else {  // use simple averaging for now //TODO do fancier things, cache results
-    for (auto duration : durationsOfLevels_->at(l)) {
-      ret += duration.duration;
-    }
-    ret /= static_cast<double>(durationsOfLevels_->at(l).size());
-  }
+  // measured process times and log time steps (the dt feature) of each level vector
+  std::map<LevelVector, std::vector<std::pair<real, real>>> measurements_;
 
-  return ret;
-}
+  // normal equations X^T X (row-major) and X^T y of the regression
+  std::vector<real> gram_;
+
+  std::vector<real> moments_;
+
+  size_t numRegressionPoints_;
+
+  std::vector<real> coefficients_;
+
+  bool regressionFitted_;  // false if coefficients_ are outdated
+
+  // cached loads, cleared by every new measurement
+  std::map<LevelVector, real> loads_;
+};
 
 } /* namespace combigrid */
 
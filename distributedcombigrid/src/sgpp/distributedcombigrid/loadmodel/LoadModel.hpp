@@ -6,6 +6,11 @@
 
 namespace combigrid {
 
+/* the load of the task with level vector l. the schedulers only compare the loads with
+ * each other and with the sizes of the groups, so the unit depends on the model: the
+ * linear load model counts grid points, the learning load model measures the process
+ * time (duration times number of processes in usec)
+ */
 class LoadModel {
  public:
   virtual ~LoadModel() = default;
@@ -2,7 +2,12 @@
 #define SRC_SGPP_COMBIGRID_MANAGER_COMBIPARAMETERS_HPP_
 
 #include <boost/serialization/map.hpp>
+#include <boost/serialization/string.hpp>
+#include <string>
+#include "sgpp/distributedcombigrid/manager/ProcessGroupSignals.hpp"
 #include "sgpp/distributedcombigrid/mpi/MPISystem.hpp"
+#include "sgpp/distributedcombigrid/task/Task.hpp"
+#include "sgpp/distributedcombigrid/utils/Config.hpp"
 #include "sgpp/distributedcombigrid/utils/LevelVector.hpp"
 #include "sgpp/distributedcombigrid/utils/Types.hpp"
 namespace combigrid {
@@ -10,7 +15,22 @@ namespace combigrid {
 class CombiParameters {
  public:
   CombiParameters()
-      : procsSet_(false) {}
+      : procsSet_(false),
+        globalReduceType_(GLOBAL_REDUCE_ALLREDUCE),
+        deltaCombination_(false),
+        deltaCombinationTolerance_(0.0),
+        globalReduceTuningFile_(""),
+        reducedPrecisionReduce_(false),
+        reducedPrecisionMinLevelSum_(0),
+        taskMigration_(false),
+        taskMigrationTolerance_(0.05),
+        memoryPerProcess_(0),
+        subgroupSize_(0),
+        subgroupMaxPoints_(0),
+        combinationChangeTolerance_(0.0),
+        minRunsPerCombination_(1),
+        maxRunsPerCombination_(1),
+        prefetchTaskInit_(false) {}
 
   CombiParameters(DimType dim, LevelVector lmin, LevelVector lmax, std::vector<bool>& boundary,
                   std::vector<LevelVector>& levels, std::vector<real>& coeffs,
@@ -25,7 +45,22 @@ class CombiParameters {
         numberOfCombinations_(numberOfCombinations),
         numGridsPerTask_(numGrids),
         reduceCombinationDimsLmin_(reduceCombinationDimsLmin),
-        reduceCombinationDimsLmax_(reduceCombinationDimsLmax) {
+        reduceCombinationDimsLmax_(reduceCombinationDimsLmax),
+        globalReduceType_(GLOBAL_REDUCE_ALLREDUCE),
+        deltaCombination_(false),
+        deltaCombinationTolerance_(0.0),
+        globalReduceTuningFile_(""),
+        reducedPrecisionReduce_(false),
+        reducedPrecisionMinLevelSum_(0),
+        taskMigration_(false),
+        taskMigrationTolerance_(0.05),
+        memoryPerProcess_(0),
+        subgroupSize_(0),
+        subgroupMaxPoints_(0),
+        combinationChangeTolerance_(0.0),
+        minRunsPerCombination_(1),
+        maxRunsPerCombination_(1),
+        prefetchTaskInit_(false) {
     hierarchizationDims_ = std::vector<bool>(dim_, true);
     setLevelsCoeffs(taskIDs, levels, coeffs);
     numTasks_ = taskIDs.size();
@@ -46,7 +81,22 @@ class CombiParameters {
         numberOfCombinations_(numberOfCombinations),
         numGridsPerTask_(numGrids),
         reduceCombinationDimsLmin_(reduceCombinationDimsLmin),
-        reduceCombinationDimsLmax_(reduceCombinationDimsLmax) {
+        reduceCombinationDimsLmax_(reduceCombinationDimsLmax),
+        globalReduceType_(GLOBAL_REDUCE_ALLREDUCE),
+        deltaCombination_(false),
+        deltaCombinationTolerance_(0.0),
+        globalReduceTuningFile_(""),
+        reducedPrecisionReduce_(false),
+        reducedPrecisionMinLevelSum_(0),
+        taskMigration_(false),
+        taskMigrationTolerance_(0.05),
+        memoryPerProcess_(0),
+        subgroupSize_(0),
+        subgroupMaxPoints_(0),
+        combinationChangeTolerance_(0.0),
+        minRunsPerCombination_(1),
+        maxRunsPerCombination_(1),
+        prefetchTaskInit_(false) {
     setLevelsCoeffs(taskIDs, levels, coeffs);
     numTasks_ = taskIDs.size();
   }
@@ -116,7 +166,7 @@ class CombiParameters {
    * this method returns the number of grids a task contains
    * in case we have multiple grids in our simulation
    */
-  inline IndexType getNumGrids() { return numGridsPerTask_; }
+  inline IndexType getNumGrids() const { return numGridsPerTask_; }
   /**
    * this method returns the number of tasks also referred to as component grids (one task might
    * contain multiple grids)
@@ -126,25 +176,180 @@ class CombiParameters {
   inline const std::vector<bool>& getHierarchizationDims() { return hierarchizationDims_; }
 
   /* get the common parallelization
-   * this function can only be used in the uniform mode
+   * in the uniform mode all tasks use it. otherwise it is the parallelization of
+   * the sparse grids to which the tasks are redistributed for the combination
    */
   inline const IndexVector getParallelization() const {
-    assert(uniformDecomposition && procsSet_);
+    assert(procsSet_);
     return procs_;
   }
 
+  /* true if a common parallelization has been set. without it the grids of the
+   * tasks are combined with their own parallelization
+   */
+  inline bool isParallelizationSet() const { return procsSet_; }
+
   inline const IndexType& getNumberOfCombinations() const { return numberOfCombinations_; }
 
   /* set the common parallelization
-   * this function can only be used in the uniform mode
    */
   inline void setParallelization(const IndexVector p) {
-    assert(uniformDecomposition);
-
     procs_ = p;
     procsSet_ = true;
   }
 
+  /* set the strategy for the global reduction of the sparse grid
+   * (see ProcessGroupSignals.hpp for the available types). ProcessManager::combineAsync
+   * only supports GLOBAL_REDUCE_ALLREDUCE without the delta combination and the reduced
+   * precision (see isAsyncCombinationSupported). it keeps a copy of every task grid
+   * until the next combination, i.e. it doubles the memory of the component grids
+   */
+  inline void setGlobalReduceType(GlobalReduceType type) { globalReduceType_ = type; }
+
+  inline GlobalReduceType getGlobalReduceType() const { return globalReduceType_; }
+
+  // ProcessManager::combineAsync always uses the plain nonblocking allreduce
+  inline bool isAsyncCombinationSupported() const {
+    return globalReduceType_ == GLOBAL_REDUCE_ALLREDUCE && !deltaCombination_ &&
+           !reducedPrecisionReduce_;
+  }
+
+  /* in the delta combination only the subspaces whose contribution changed by more
+   * than tolerance (max norm) since the last combination are exchanged.
+   * this replaces the global reduce type
+   */
+  inline void setDeltaCombination(bool enable, real tolerance = 0.0) {
+    assert(tolerance >= 0.0);
+
+    deltaCombination_ = enable;
+    deltaCombinationTolerance_ = tolerance;
+  }
+
+  inline bool isDeltaCombination() const { return deltaCombination_; }
+
+  inline real getDeltaCombinationTolerance() const { return deltaCombinationTolerance_; }
+
+  /* file in which the winners of the autotuned global reduction are stored
+   * (GLOBAL_REDUCE_AUTOTUNE). an empty name disables the persistence
+   */
+  inline void setGlobalReduceTuningFile(const std::string& file) {
+    globalReduceTuningFile_ = file;
+  }
+
+  inline const std::string& getGlobalReduceTuningFile() const { return globalReduceTuningFile_; }
+
+  /* send the subspaces with a level sum of at least minLevelSum in single precision
+   * in the global reduction. the rounding errors are kept by the workers and added
+   * to their contribution in the next combination (error feedback).
+   * this replaces the global reduce type
+   */
+  inline void setReducedPrecisionReduce(bool enable, LevelType minLevelSum = 0) {
+    reducedPrecisionReduce_ = enable;
+    reducedPrecisionMinLevelSum_ = minLevelSum;
+  }
+
+  inline bool isReducedPrecisionReduce() const { return reducedPrecisionReduce_; }
+
+  inline LevelType getReducedPrecisionMinLevelSum() const { return reducedPrecisionMinLevelSum_; }
+
+  /* rebalance the tasks between the groups after each combination based on the
+   * measured durations. a task is only migrated if this reduces the maximum load
+   * of a group by more than tolerance (relative)
+   */
+  inline void setTaskMigration(bool enable, real tolerance = 0.05) {
+    assert(tolerance >= 0.0);
+
+    taskMigration_ = enable;
+    taskMigrationTolerance_ = tolerance;
+  }
+
+  inline bool isTaskMigration() const { return taskMigration_; }
+
+  inline real getTaskMigrationTolerance() const { return taskMigrationTolerance_; }
+
+  /* memory (in bytes) of one process which is available for the grids of the tasks.
+   * tasks are only scheduled on groups which are large enough to hold their grids.
+   * groups which are larger than the smallest group combine on a temporary copy of
+   * the grids on their first processes, which also has to fit. 0 means unlimited
+   */
+  inline void setMemoryPerProcess(size_t memory) { memoryPerProcess_ = memory; }
+
+  inline size_t getMemoryPerProcess() const { return memoryPerProcess_; }
+
+  /* small tasks (with at most maxPoints grid points) are not computed by the whole
+   * process group, but on sub-communicators of size processes. the small tasks of a
+   * group run concurrently on the different subgroups. 0 disables the subgroups
+   */
+  inline void setTaskSubgroups(size_t size, size_t maxPoints) {
+    subgroupSize_ = size;
+    subgroupMaxPoints_ = maxPoints;
+  }
+
+  inline size_t getSubgroupSize() const { return subgroupSize_; }
+
+  inline size_t getSubgroupMaxPoints() const { return subgroupMaxPoints_; }
+
+  /* memory (in bytes) per process of task t in a group of groupSize processes which
+   * combines on a temporary grid with the common parallelization: the largest part of the
+   * temporary grid (the task chooses the direction of its decomposition) plus the grids of
+   * the task, which are assumed to be evenly distributed. small tasks are assumed to run
+   * on the last subgroup, which is the smallest one. the manager places the tasks with it
+   * and the workers check it before they create the temporary grid
+   */
+  inline size_t getCommonGridMemoryRequirement(const Task& t, size_t groupSize,
+                                               bool subgroupTask) const {
+    typedef DistributedFullGrid<CombiDataType> DFG;
+    const LevelVector& l = t.getLevelVector();
+    const std::vector<bool>& boundary = t.getBoundary();
+
+    size_t numElements =
+        size_t(std::max(DFG::getMaxNrLocalElements(l, boundary, procs_, true),
+                        DFG::getMaxNrLocalElements(l, boundary, procs_, false)));
+
+    size_t taskProcs = groupSize;
+
+    if (subgroupTask)
+      taskProcs = (groupSize % subgroupSize_ == 0) ? subgroupSize_ : groupSize % subgroupSize_;
+
+    numElements += (t.getNumPoints() + taskProcs - 1) / taskProcs * size_t(numGridsPerTask_);
+
+    return numElements * sizeof(CombiDataType);
+  }
+
+  /* adapt the number of runs between two combinations of ProcessManager::runAutonomous
+   * to the relative change of the combined surpluses (l2 norm) in each combination. the
+   * interval is doubled if the change is below tolerance / 2 and halved if it is above
+   * tolerance, within [minRuns, maxRuns]. the number of runs of the loop stays fixed,
+   * the number of combinations changes with the interval. a tolerance of 0 disables the
+   * adaptation. not available with ENABLE_FT, where the manager runs the loop step by step
+   */
+  inline void setAdaptiveCombination(real tolerance, size_t minRuns, size_t maxRuns) {
+    assert(tolerance >= 0.0);
+    assert(minRuns > 0 && minRuns <= maxRuns);
+
+    combinationChangeTolerance_ = tolerance;
+    minRunsPerCombination_ = minRuns;
+    maxRunsPerCombination_ = maxRuns;
+  }
+
+  inline bool isAdaptiveCombination() const { return combinationChangeTolerance_ > 0.0; }
+
+  inline real getCombinationChangeTolerance() const { return combinationChangeTolerance_; }
+
+  inline size_t getMinRunsPerCombination() const { return minRunsPerCombination_; }
+
+  inline size_t getMaxRunsPerCombination() const { return maxRunsPerCombination_; }
+
+  /* initialize the next task of a group on a helper thread while the current one runs,
+   * instead of initializing all tasks before the first run. requires MPI_THREAD_MULTIPLE
+   * (see MPI_Init_thread), otherwise (and with GENE) the tasks are initialized one by one.
+   * only the tasks of runfirst are prefetched, the tasks of the recovery (ADD_TASK and
+   * RECOMPUTE) are needed right away and are always initialized when they arrive
+   */
+  inline void setPrefetchTaskInit(bool prefetch) { prefetchTaskInit_ = prefetch; }
+
+  inline bool isPrefetchTaskInit() const { return prefetchTaskInit_; }
+
  private:
   DimType dim_;
 
@@ -193,6 +398,36 @@ class CombiParameters {
     * It is ensured that lmax >= lmin
     */
   LevelVector reduceCombinationDimsLmax_;
+
+  GlobalReduceType globalReduceType_;
+
+  bool deltaCombination_;
+
+  real deltaCombinationTolerance_;
+
+  std::string globalReduceTuningFile_;
+
+  bool reducedPrecisionReduce_;
+
+  LevelType reducedPrecisionMinLevelSum_;
+
+  bool taskMigration_;
+
+  real taskMigrationTolerance_;
+
+  size_t memoryPerProcess_;
+
+  size_t subgroupSize_;
+
+  size_t subgroupMaxPoints_;
+
+  real combinationChangeTolerance_;
+
+  size_t minRunsPerCombination_;
+
+  size_t maxRunsPerCombination_;
+
+  bool prefetchTaskInit_;
   // serialize
   template <class Archive>
   void serialize(Archive& ar, const unsigned int version);
@@ -214,6 +449,21 @@ void CombiParameters::serialize(Archive& ar, const unsigned int version) {
   ar& numTasks_;
   ar& reduceCombinationDimsLmin_;
   ar& reduceCombinationDimsLmax_;
+  ar& globalReduceType_;
+  ar& deltaCombination_;
+  ar& deltaCombinationTolerance_;
+  ar& globalReduceTuningFile_;
+  ar& reducedPrecisionReduce_;
+  ar& reducedPrecisionMinLevelSum_;
+  ar& taskMigration_;
+  ar& taskMigrationTolerance_;
+  ar& memoryPerProcess_;
+  ar& subgroupSize_;
+  ar& subgroupMaxPoints_;
+  ar& combinationChangeTolerance_;
+  ar& minRunsPerCombination_;
+  ar& maxRunsPerCombination_;
+  ar& prefetchTaskInit_;
 }
 }
 
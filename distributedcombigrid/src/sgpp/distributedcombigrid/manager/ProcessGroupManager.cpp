@@ -14,6 +14,23 @@ bool ProcessGroupManager::runfirst(Task* t) {
   return storeTaskReferenceAndSendTaskToProcessGroup(t, RUN_FIRST);
 }
 
+bool ProcessGroupManager::runfirst(const TaskContainer& tasks) {
+  if (status_ != PROCESS_GROUP_WAIT) return false;
+
+  for (Task* t : tasks) storeTaskReference(t);
+
+  sendSignalToProcessGroup(RUN_FIRST_BATCH);
+
+  // all tasks in a single message
+  TaskContainer tmp(tasks);
+  MPIUtils::sendClass(&tmp, pgroupRootID_, theMPISystem()->getGlobalComm());
+
+  // the group acknowledges once all tasks have been run
+  setProcessGroupBusyAndReceive();
+
+  return true;
+}
+
 bool ProcessGroupManager::storeTaskReferenceAndSendTaskToProcessGroup(Task* t, SignalType signal){
   // first check status
   // tying to add a task to a busy group is an invalid operation
@@ -48,6 +65,18 @@ void ProcessGroupManager::sendSignalAndReceive(SignalType signal){
   setProcessGroupBusyAndReceive();
 }
 
+void ProcessGroupManager::sendCollectiveSignal(SignalType signal) {
+  if (!theMPISystem()->hasSubmanagers()) {
+    sendSignalAndReceive(signal);
+    return;
+  }
+
+  // the sub-managers forward the signal to the other groups of their block
+  if (theMPISystem()->isSubmanager(pgroupRootID_)) sendSignalToProcessGroup(signal);
+
+  status_ = PROCESS_GROUP_BUSY;
+}
+
 void ProcessGroupManager::sendSignalToProcessGroup(SignalType signal){
   MPI_Send(&signal, 1, MPI_INT, pgroupRootID_, signalTag, theMPISystem()->getGlobalComm());
 }
@@ -85,7 +114,39 @@ bool ProcessGroupManager::combine() {
   // can only send sync signal when in wait state
   assert(status_ == PROCESS_GROUP_WAIT);
 
-  sendSignalAndReceive(COMBINE);
+  sendCollectiveSignal(COMBINE);
+
+  return true;
+}
+
+bool ProcessGroupManager::combineAsync() {
+  // can only send sync signal when in wait state
+  assert(status_ == PROCESS_GROUP_WAIT);
+
+  sendCollectiveSignal(COMBINE_ASYNC);
+
+  return true;
+}
+
+bool ProcessGroupManager::runnextAndCombine() {
+  assert(status_ == PROCESS_GROUP_WAIT);
+
+  // groups without tasks take part in the global reduction as well
+  sendCollectiveSignal(RUN_NEXT_COMBINE);
+
+  return true;
+}
+
+bool ProcessGroupManager::runAutonomous(int numCombinations, int runsPerCombination) {
+  assert(status_ == PROCESS_GROUP_WAIT);
+
+  sendCollectiveSignal(RUN_AUTONOMOUS);
+
+  // the sub-managers distribute the parameters in their block
+  if (!theMPISystem()->hasSubmanagers() || theMPISystem()->isSubmanager(pgroupRootID_)) {
+    int info[2] = {numCombinations, runsPerCombination};
+    MPI_Send(info, 2, MPI_INT, pgroupRootID_, 0, theMPISystem()->getGlobalComm());
+  }
 
   return true;
 }
@@ -173,6 +234,68 @@ bool ProcessGroupManager::parallelEval(const LevelVector& leval, std::string& fi
   return true;
 }
 
+bool ProcessGroupManager::migrateTaskSend(Task* t, size_t dstGroup) {
+  assert(status_ == PROCESS_GROUP_WAIT);
+
+  std::vector<Task*>::iterator position = std::find(tasks_.begin(), tasks_.end(), t);
+  assert(position != tasks_.end());
+
+  sendSignalToProcessGroup(MIGRATE_TASK_SEND);
+
+  int info[2] = {t->getID(), int(dstGroup)};
+  MPI_Send(info, 2, MPI_INT, pgroupRootID_, 0, theMPISystem()->getGlobalComm());
+
+  tasks_.erase(position);
+
+  setProcessGroupBusyAndReceive();
+
+  return true;
+}
+
+bool ProcessGroupManager::migrateTaskReceive(Task* t, size_t srcGroup) {
+  assert(status_ == PROCESS_GROUP_WAIT);
+
+  sendSignalToProcessGroup(MIGRATE_TASK_RECEIVE);
+
+  int src = int(srcGroup);
+  MPI_Send(&src, 1, MPI_INT, pgroupRootID_, 0, theMPISystem()->getGlobalComm());
+
+  storeTaskReference(t);
+
+  setProcessGroupBusyAndReceive();
+
+  return true;
+}
+
+bool ProcessGroupManager::writeCheckpoint(const std::string& prefix) {
+  assert(status_ == PROCESS_GROUP_WAIT);
+
+  sendSignalToProcessGroup(CHECKPOINT);
+
+  std::string tmp(prefix);
+  MPIUtils::sendClass(&tmp, pgroupRootID_, theMPISystem()->getGlobalComm());
+
+  setProcessGroupBusyAndReceive();
+
+  return true;
+}
+
+bool ProcessGroupManager::restart(const TaskContainer& tasks, const std::string& prefix) {
+  assert(status_ == PROCESS_GROUP_WAIT);
+  assert(tasks_.empty());
+
+  for (Task* t : tasks) storeTaskReference(t);
+
+  sendSignalToProcessGroup(RESTART);
+
+  std::string tmp(prefix);
+  MPIUtils::sendClass(&tmp, pgroupRootID_, theMPISystem()->getGlobalComm());
+
+  setProcessGroupBusyAndReceive();
+
+  return true;
+}
+
 void ProcessGroupManager::recvStatus() {
   // start non-blocking call to receive status
   if (ENABLE_FT) {
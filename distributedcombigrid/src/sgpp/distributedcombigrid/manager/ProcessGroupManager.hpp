@@ -26,6 +26,10 @@ class ProcessGroupManager {
 
   bool runfirst(Task* t);
 
+  // send all tasks in one message. the group initializes and runs them and
+  // reports its status once
+  bool runfirst(const TaskContainer& tasks);
+
   bool runnext();
 
   bool exit();
@@ -46,6 +50,14 @@ class ProcessGroupManager {
 
   bool combine();
 
+  bool combineAsync();
+
+  // run the tasks and start the combination as soon as they are finished
+  bool runnextAndCombine();
+
+  // run numCombinations times: runsPerCombination runs of all tasks, then combine
+  bool runAutonomous(int numCombinations, int runsPerCombination);
+
   template <typename FG_ELEMENT>
   bool combineFG(FullGrid<FG_ELEMENT>& fg);
 
@@ -71,6 +83,22 @@ class ProcessGroupManager {
 
   bool parallelEval(const LevelVector& leval, std::string& filename);
 
+  /* move task t (including its state) to the group with the given index.
+   * migrateTaskReceive has to be called on the other group
+   */
+  bool migrateTaskSend(Task* t, size_t dstGroup);
+
+  // take over task t from the group with the given index
+  bool migrateTaskReceive(Task* t, size_t srcGroup);
+
+  // write the state of the group to the checkpoint with the given prefix
+  bool writeCheckpoint(const std::string& prefix);
+
+  /* take over tasks from the checkpoint with the given prefix. the group reads
+   * them from its own file, tasks are only the references kept on the manager
+   */
+  bool restart(const TaskContainer& tasks, const std::string& prefix);
+
  private:
   RankType pgroupRootID_;  // rank in GlobalComm of the master process of this group
 
@@ -95,6 +123,11 @@ class ProcessGroupManager {
 
   void sendSignalAndReceive(SignalType signal);
 
+  /* like sendSignalAndReceive for the signals which are sent to all groups at once. with
+   * sub-managers the status is collected by ProcessManager::collectStatus instead
+   */
+  void sendCollectiveSignal(SignalType signal);
+
   void sendSignalToProcessGroup(SignalType signal);
 
   inline void setProcessGroupBusyAndReceive();
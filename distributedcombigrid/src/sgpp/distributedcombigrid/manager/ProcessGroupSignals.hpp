@@ -26,6 +26,14 @@ const SignalType RECOVER_COMM = 16;
 const SignalType PARALLEL_EVAL = 17;
 const SignalType DO_NOTHING = 18;
 const SignalType RESET_TASKS = 19;
+const SignalType COMBINE_ASYNC = 20;
+const SignalType MIGRATE_TASK_SEND = 21;     // move a task to another group
+const SignalType MIGRATE_TASK_RECEIVE = 22;  // take over a task from another group
+const SignalType RUN_FIRST_BATCH = 23;       // receive and run all tasks of a group at once
+const SignalType RUN_NEXT_COMBINE = 24;      // run all tasks and combine right afterwards
+const SignalType RUN_AUTONOMOUS = 25;        // run the combination loop without the manager
+const SignalType CHECKPOINT = 26;            // write the state of the group to a checkpoint
+const SignalType RESTART = 27;               // take over the tasks of a group from a checkpoint
 
 typedef int NormalizationType;
 const NormalizationType NO_NORMALIZATION = 0;
@@ -33,11 +41,21 @@ const NormalizationType L1_NORMALIZATION = 1;
 const NormalizationType L2_NORMALIZATION = 2;
 const NormalizationType EV_NORMALIZATION = 3;
 
+// strategy of the global reduction of the distributed sparse grid
+typedef int GlobalReduceType;
+const GlobalReduceType GLOBAL_REDUCE_ALLREDUCE = 0;
+const GlobalReduceType GLOBAL_REDUCE_REDUCE_SCATTER = 1;
+const GlobalReduceType GLOBAL_REDUCE_HIERARCHICAL = 2;
+// select allreduce or hierarchical at runtime, see GlobalReduceAutotuner
+const GlobalReduceType GLOBAL_REDUCE_AUTOTUNE = 3;
+// synchronous one-sided variant, see CombiCom::distributedGlobalReduceRMA
+const GlobalReduceType GLOBAL_REDUCE_RMA = 4;
+
 typedef int FaultSimulationType;
 const FaultSimulationType RANDOM_FAIL = 0;
 const FaultSimulationType GROUPS_FAIL = 1;
 
-enum TagType { signalTag = 0, statusTag = 1, infoTag = 2, durationTag = 3 };
+enum TagType { signalTag = 0, statusTag = 1, infoTag = 2, durationTag = 3, migrationTag = 4 };
 
 // attention: changing StatusType might require changing the MPI Type
 typedef int StatusType;
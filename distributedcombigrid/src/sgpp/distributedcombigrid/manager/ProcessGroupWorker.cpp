@@ -7,6 +7,7 @@
 #include "sgpp/distributedcombigrid/hierarchization/DistributedHierarchization.hpp"
 #include "sgpp/distributedcombigrid/manager/CombiParameters.hpp"
 #include "sgpp/distributedcombigrid/manager/ProcessGroupSignals.hpp"
+#include "sgpp/distributedcombigrid/mpi/MPILargeCount.hpp"
 #include "sgpp/distributedcombigrid/mpi/MPIUtils.hpp"
 #include "sgpp/distributedcombigrid/sparsegrid/DistributedSparseGrid.hpp"
 #include "sgpp/distributedcombigrid/sparsegrid/DistributedSparseGridUniform.hpp"
@@ -15,21 +16,43 @@
 
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <numeric>
 #include <string>
 #include "sgpp/distributedcombigrid/mpi_fault_simulator/MPI-FT.h"
 
 namespace combigrid {
 
+namespace {
+
+// the signals which are sent to all groups at once. with sub-managers, they are
+// forwarded and answered through the sub-managers
+bool isCollectiveSignal(SignalType signal) {
+  return signal == COMBINE || signal == COMBINE_ASYNC || signal == RUN_NEXT_COMBINE ||
+         signal == RUN_AUTONOMOUS;
+}
+
+}  // namespace
+
 ProcessGroupWorker::ProcessGroupWorker()
     : currentTask_(NULL),
       status_(PROCESS_GROUP_WAIT),
       combinedFG_(NULL),
       combinedUniDSGVector_(0),
+      combinedUniDSGComplete_(true),
+      combinationChange_(-1.0),
       combinedFGexists_(false),
       combiParameters_(),
       combiParametersSet_(false),
-      currentCombi_(0) {
+      currentCombi_(0),
+      reportToSubmanager_(false),
+      subgroupComm_(MPI_COMM_NULL),
+      subgroup_(0),
+      prefetchTask_(nullptr),
+      prefetchComm_(MPI_COMM_NULL) {
   t_fault_ = -1;
   startTimeIteration_ = (std::chrono::high_resolution_clock::now());
   MASTER_EXCLUSIVE_SECTION {
@@ -38,17 +61,98 @@ ProcessGroupWorker::ProcessGroupWorker()
   }
 }
 
-ProcessGroupWorker::~ProcessGroupWorker() { delete combinedFG_; }
+ProcessGroupWorker::~ProcessGroupWorker() {
+  if (prefetchThread_.joinable()) prefetchThread_.join();
+
+  if (prefetchComm_ != MPI_COMM_NULL) MPI_Comm_free(&prefetchComm_);
+
+  delete combinedFG_;
+}
 
 // Do useful things with the info about how long a task took.
 // this gets called whenever a task was run, i.e., signals RUN_FIRST(once), RUN_NEXT(possibly multiple times),
 // RECOMPUTE(possibly multiple times), and in ready(possibly multiple times)
 void ProcessGroupWorker::processDuration(const Task& t, const Stats::Event e, size_t numProcs) { 
-  MASTER_EXCLUSIVE_SECTION {
-    // durationInformation info(e, t, numProcs);
-    durationInformation info = {t.getID(), Stats::getEventDurationInUsec(e), t.getCurrentTime(), t.getCurrentTimestep(), theMPISystem()->getWorldRank(), numProcs};
-    MPIUtils::sendClass(&info, theMPISystem()->getManagerRank(), theMPISystem()->getGlobalComm());
+  CommunicatorType comm = getTaskComm(t);
+
+  // the first process of the task reports the duration. the durations of small tasks
+  // are forwarded by the master, see runSubgroupTasks
+  if (comm == MPI_COMM_NULL || getCommRank(comm) != 0) return;
+
+  // durationInformation info(e, t, numProcs);
+  durationInformation info = {t.getID(), Stats::getEventDurationInUsec(e), t.getCurrentTime(), t.getCurrentTimestep(), theMPISystem()->getWorldRank(), static_cast<uint>(numProcs)};
+
+  if (theMPISystem()->isMaster())
+    reportDuration(info);
+  else
+    sendDuration(info, theMPISystem()->getMasterRank(), theMPISystem()->getLocalComm());
+}
+
+void ProcessGroupWorker::sendDuration(const durationInformation& info, RankType dst,
+                                      CommunicatorType comm) {
+  // release the buffers of the previous durations once they have been sent
+  if (!durationRequests_.empty()) {
+    int flag;
+    MPI_Testall(static_cast<int>(durationRequests_.size()), durationRequests_.data(), &flag,
+                MPI_STATUSES_IGNORE);
+
+    if (flag) {
+      durationRequests_.clear();
+      durations_.clear();
+    }
   }
+
+  // the buffer has to stay valid until the send has completed
+  durations_.push_back(info);
+  durationRequests_.push_back(MPI_REQUEST_NULL);
+  MPIUtils::isendPOD(&durations_.back(), dst, durationTag, comm, &durationRequests_.back());
+}
+
+void ProcessGroupWorker::reportDuration(const durationInformation& info) {
+  if (reportToSubmanager_)
+    pendingDurations_.push_back(info);
+  else
+    sendDuration(info, theMPISystem()->getManagerRank(), theMPISystem()->getGlobalComm());
+}
+
+/**
+ * The masters of the groups of one sub-manager gather their status and durations at the
+ * sub-manager, which forwards those of its whole block to the manager in a single
+ * message. The manager collects them in ProcessManager::collectStatus.
+ */
+void ProcessGroupWorker::reportStatusToSubmanager() {
+  std::vector<StatusType> status(1, status_);
+  std::vector<StatusType> blockStatus;
+  std::vector<durationInformation> blockDurations;
+
+  CommunicatorType groupComm = theMPISystem()->getSubmanagerGroupComm();
+  MPIUtils::gatherPODs(status, blockStatus, 0, groupComm);
+  MPIUtils::gatherPODs(pendingDurations_, blockDurations, 0, groupComm);
+
+  pendingDurations_.clear();
+
+  // only the sub-manager forwards
+  if (getCommRank(groupComm) != 0) return;
+
+  CommunicatorType comm = theMPISystem()->getSubmanagerComm();
+  RankType managerRank = getCommSize(comm) - 1;
+  std::vector<StatusType> unusedStatus;
+  std::vector<durationInformation> unusedDurations;
+  MPIUtils::gatherPODs(blockStatus, unusedStatus, managerRank, comm);
+  MPIUtils::gatherPODs(blockDurations, unusedDurations, managerRank, comm);
+}
+
+void ProcessGroupWorker::forwardSignalToSubmanagerGroup(SignalType signal) {
+  CommunicatorType groupComm = theMPISystem()->getSubmanagerGroupComm();
+
+  // only the sub-manager received the signal from the manager
+  if (getCommRank(groupComm) != 0) return;
+
+  // the masters of the block have consecutive ranks in the global comm
+  RankType globalRank = theMPISystem()->getGlobalRank();
+
+  for (int i = 1; i < getCommSize(groupComm); ++i)
+    MPI_Send(&signal, 1, MPI_INT, globalRank + i, signalTag, theMPISystem()->getGlobalComm());
 }
 
 SignalType ProcessGroupWorker::wait() {
@@ -66,15 +170,23 @@ SignalType ProcessGroupWorker::wait() {
   SignalType signal = -1;
 
   MASTER_EXCLUSIVE_SECTION {
-    // receive signal from manager
-    MPI_Recv(&signal, 1, MPI_INT, theMPISystem()->getManagerRank(), signalTag,
-             theMPISystem()->getGlobalComm(), MPI_STATUS_IGNORE);
+    // receive signal from manager. with sub-managers, the signals to all groups arrive
+    // from the sub-manager of the block
+    RankType source = theMPISystem()->hasSubmanagers() ? MPI_ANY_SOURCE
+                                                       : theMPISystem()->getManagerRank();
+    MPI_Recv(&signal, 1, MPI_INT, source, signalTag, theMPISystem()->getGlobalComm(),
+             MPI_STATUS_IGNORE);
+
+    if (theMPISystem()->hasSubmanagers() && isCollectiveSignal(signal))
+      forwardSignalToSubmanagerGroup(signal);
   }
   // distribute signal to other processes of pgroup
   MPI_Bcast(&signal, 1, MPI_INT, theMPISystem()->getMasterRank(), theMPISystem()->getLocalComm());
 #ifdef DEBUG_OUTPUT
   std::cout << theMPISystem()->getWorldRank() << " waits for signal " << signal << " \n";
 #endif
+  reportToSubmanager_ = theMPISystem()->hasSubmanagers() && isCollectiveSignal(signal);
+
   // process signal
   switch (signal) {
     case RUN_FIRST: {
@@ -87,6 +199,46 @@ SignalType ProcessGroupWorker::wait() {
       // std::cout << "from runfirst ";
       processDuration(*currentTask_, e, getCommSize(theMPISystem()->getLocalComm()));  
     } break;
+    case RUN_FIRST_BATCH: {
+      initializeTasks();
+
+      // the tasks are run in ready, which reports the status once all of them
+      // are finished
+    } break;
+    case RUN_NEXT_COMBINE: {  // run all tasks and combine right afterwards
+      // the combination starts as soon as the own tasks are finished, the global
+      // reduction synchronizes with the other groups. the status is sent afterwards.
+      // a failed group would not take part in the global reduction, so the manager
+      // sends RUN_NEXT and COMBINE separately with fault tolerance
+      if (ENABLE_FT) {
+        std::cout << "RUN_NEXT_COMBINE is not available with fault tolerance! Aborting! \n";
+        MPI_Abort(MPI_COMM_WORLD, 1);
+      }
+
+      for (Task* t : tasks_) t->setFinished(false);
+
+      status_ = PROCESS_GROUP_BUSY;
+
+      if (!runTasks()) return signal;
+
+      Stats::startEvent("combine");
+      combineUniform();
+      currentCombi_++;
+      Stats::stopEvent("combine");
+
+    } break;
+    case RUN_AUTONOMOUS: {  // run the combination loop without the manager
+      if (!runAutonomous()) return signal;
+
+    } break;
+    case CHECKPOINT: {  // write the state of the group to a checkpoint
+      writeCheckpoint(receiveCheckpointFilename());
+
+    } break;
+    case RESTART: {  // take over the tasks of the group from a checkpoint
+      readCheckpoint(receiveCheckpointFilename());
+
+    } break;
     case RUN_NEXT: {
       assert(tasks_.size() > 0);
       // reset finished status of all tasks
@@ -98,6 +250,9 @@ SignalType ProcessGroupWorker::wait() {
         // set currentTask
         currentTask_ = tasks_[0];
 
+        // small tasks are run concurrently in ready
+        if (isSubgroupTask(*currentTask_)) break;
+
         // run first task
         // if isGENE, this is done in GENE's worker_routines.cpp
         if (!isGENE) {
@@ -135,10 +290,14 @@ SignalType ProcessGroupWorker::wait() {
     case RESET_TASKS: {  // deleta all tasks (used in process recovery)
       std::cout << "resetting tasks" << std::endl;
 
+      abortTaskInits();
+
       // freeing tasks
       for (auto tmp : tasks_) delete (tmp);
 
       tasks_.clear();
+      subgroupTasks_.clear();
+      std::fill(subgroupPoints_.begin(), subgroupPoints_.end(), 0);
       status_ = PROCESS_GROUP_BUSY;
 
     } break;
@@ -149,6 +308,19 @@ SignalType ProcessGroupWorker::wait() {
       // t.eval(x)
     } break;
     case EXIT: {
+      // do not leave a pending reduction behind
+      finishCombineUniformAsync();
+
+      for (auto& window : globalReduceWindows_) CombiCom::freeGlobalReduceWindow(window);
+      globalReduceWindows_.clear();
+
+      for (auto& window : globalReduceSharedWindows_)
+        CombiCom::freeGlobalReduceSharedWindow(window);
+      globalReduceSharedWindows_.clear();
+
+      MPI_Waitall(static_cast<int>(durationRequests_.size()), durationRequests_.data(),
+                  MPI_STATUSES_IGNORE);
+
       if (isGENE) {
         chdir("../ginstance");
       }
@@ -168,6 +340,14 @@ SignalType ProcessGroupWorker::wait() {
       currentCombi_++;
       Stats::stopEvent("combine");
 
+    } break;
+    case COMBINE_ASYNC: {  // start lagged combination
+
+      Stats::startEvent("combine async");
+      combineUniformAsync();
+      currentCombi_++;
+      Stats::stopEvent("combine async");
+
     } break;
     case GRID_EVAL: {  // not supported anymore
 
@@ -208,6 +388,14 @@ SignalType ProcessGroupWorker::wait() {
       theMPISystem()->recoverCommunicators(true);
       return signal;
     } break;
+    case MIGRATE_TASK_SEND: {
+      migrateTaskSend();
+
+    } break;
+    case MIGRATE_TASK_RECEIVE: {
+      migrateTaskReceive();
+
+    } break;
     case PARALLEL_EVAL: {  // output final grid
 
       Stats::startEvent("parallel eval");
@@ -255,38 +443,7 @@ void ProcessGroupWorker::ready() {
     }
   }
   if (status_ != PROCESS_GROUP_FAIL) {
-    // check if there are unfinished tasks
-    // all the tasks that are not the first in their process group will be run in this loop
-    for (size_t i = 0; i < tasks_.size(); ++i) {
-      if (!tasks_[i]->isFinished()) {
-        status_ = PROCESS_GROUP_BUSY;
-
-        // set currentTask
-        currentTask_ = tasks_[i];
-        Stats::startEvent("worker run");
-        currentTask_->run(theMPISystem()->getLocalComm());
-        Stats::Event e = Stats::stopEvent("worker run");
-
-        // std::cout << "from ready ";
-        processDuration(*currentTask_, e, getCommSize(theMPISystem()->getLocalComm()));   
-        if (ENABLE_FT) {
-          // with this barrier the local root but also each other process can detect
-          // whether a process in the group has failed
-          int err = simft::Sim_FT_MPI_Barrier(theMPISystem()->getLocalCommFT());
-
-          if (err == MPI_ERR_PROC_FAILED) {
-            status_ = PROCESS_GROUP_FAIL;
-            break;
-          }
-        }
-        // merge problem?
-        // todo: gene specific voodoo
-        if (isGENE && !currentTask_->isFinished()) {
-          return;
-        }
-        //
-      }
-    }
+    if (!runTasks()) return;
 
     // all tasks finished -> group waiting
     if (status_ != PROCESS_GROUP_FAIL) {
@@ -298,7 +455,9 @@ void ProcessGroupWorker::ready() {
   MASTER_EXCLUSIVE_SECTION {
     StatusType status = status_;
 
-    if (ENABLE_FT) {
+    if (reportToSubmanager_) {
+      reportStatusToSubmanager();
+    } else if (ENABLE_FT) {
       simft::Sim_FT_MPI_Send(&status, 1, MPI_INT, theMPISystem()->getManagerRank(), statusTag,
                              theMPISystem()->getGlobalCommFT());
     } else {
@@ -313,11 +472,309 @@ void ProcessGroupWorker::ready() {
   // if failed proc in this group detected the alive procs go into recovery state
   if (ENABLE_FT) {
     if (status_ == PROCESS_GROUP_FAIL) {
+      // the local comm is replaced, the remaining tasks of the group are reset
+      abortTaskInits();
+
       theMPISystem()->recoverCommunicators(false);
       status_ = PROCESS_GROUP_WAIT;
     }
   }
 }
+/**
+ * The whole loop of time steps and combinations is executed without signals from the
+ * manager. The groups only synchronize in the global reductions of the combinations, the
+ * manager receives the status once the loop is finished.
+ */
+bool ProcessGroupWorker::runAutonomous() {
+  // the GENE tasks are run outside of the worker
+  assert(!isGENE);
+
+  // the loop can not recover from failed groups, with fault tolerance the manager runs
+  // it step by step
+  if (ENABLE_FT) {
+    std::cout << "the autonomous loop is not available with fault tolerance! Aborting! \n";
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+
+  int info[2];
+  MASTER_EXCLUSIVE_SECTION {
+    // with sub-managers, only they receive the parameters and pass them on in their block
+    bool hasSubmanagers = theMPISystem()->hasSubmanagers();
+    CommunicatorType groupComm = theMPISystem()->getSubmanagerGroupComm();
+
+    if (!hasSubmanagers || getCommRank(groupComm) == 0)
+      MPI_Recv(info, 2, MPI_INT, theMPISystem()->getManagerRank(), 0,
+               theMPISystem()->getGlobalComm(), MPI_STATUS_IGNORE);
+
+    if (hasSubmanagers) MPI_Bcast(info, 2, MPI_INT, 0, groupComm);
+  }
+  MPI_Bcast(info, 2, MPI_INT, theMPISystem()->getMasterRank(), theMPISystem()->getLocalComm());
+
+  const int numCombinations = info[0];
+  const int runsPerCombination = info[1];
+
+  status_ = PROCESS_GROUP_BUSY;
+
+  /* the adaptive combination changes the number of runs between the combinations, so
+   * only the total number of runs is fixed and the number of combinations floats. the
+   * last run is always followed by a combination, which is treated as combination
+   * lastCombi (e.g. lmin and lmax are not reduced in the last combination of the
+   * parameters). additional combinations of a shorter interval are treated like the
+   * one before lastCombi
+   */
+  const int numRuns = numCombinations * runsPerCombination;
+  const IndexType lastCombi = currentCombi_ + numCombinations - 1;
+  int interval = runsPerCombination;
+  int runsSinceCombination = 0;
+
+  if (combiParameters_.isAdaptiveCombination()) interval = clampCombinationInterval(interval);
+
+  for (int r = 0; r < numRuns; ++r) {
+    for (Task* t : tasks_) t->setFinished(false);
+
+    if (!runTasks()) return false;
+
+    ++runsSinceCombination;
+
+    if (r + 1 < numRuns) {
+      if (runsSinceCombination < interval) continue;
+
+      currentCombi_ = std::min(currentCombi_, std::max(lastCombi - 1, IndexType(0)));
+    } else {
+      currentCombi_ = lastCombi;
+    }
+
+    Stats::startEvent("combine");
+    combineUniform();
+    currentCombi_++;
+    Stats::stopEvent("combine");
+
+    runsSinceCombination = 0;
+
+    if (combiParameters_.isAdaptiveCombination()) interval = adaptCombinationInterval(interval);
+  }
+
+  return true;
+}
+
+/**
+ * The indicator for the adaptive combination is the relative change of the combined
+ * surpluses (l2 norm over all grids) since the last combination. It is computed from the
+ * local parts of the sparse grids, which costs one copy of the sparse grids and a few
+ * scalar reductions. All groups have to decide on the same interval, so the masters agree
+ * on the largest value of the groups before it is distributed in the group.
+ */
+void ProcessGroupWorker::computeCombinationChange() {
+  bool first = createPersistentSG(previousCombinedDSGVector_);
+
+  // squared norms of the change and of the combined surpluses
+  real norms[2] = {0.0, 0.0};
+
+  // only the processes of the local reduce comm hold parts of the sparse grids
+  if (theMPISystem()->getLocalReduceComm() != MPI_COMM_NULL) {
+    for (size_t g = 0; g < combinedUniDSGVector_.size(); ++g) {
+      DistributedSparseGridUniform<CombiDataType>& dsg = *combinedUniDSGVector_[g];
+      DistributedSparseGridUniform<CombiDataType>& previous = *previousCombinedDSGVector_[g];
+
+      for (size_t i = 0; i < dsg.getNumSubspaces(); ++i) {
+        const std::vector<CombiDataType>& current = dsg.getDataVector(i);
+        std::vector<CombiDataType>& reference = previous.getDataVector(i);
+        reference.resize(current.size(), CombiDataType(0));
+
+        for (size_t j = 0; j < current.size(); ++j) {
+          norms[0] += std::pow(std::abs(current[j] - reference[j]), 2);
+          norms[1] += std::pow(std::abs(current[j]), 2);
+        }
+
+        reference = current;
+      }
+    }
+  }
+
+  CommunicatorType lcomm = theMPISystem()->getLocalComm();
+  RankType masterRank = theMPISystem()->getMasterRank();
+
+  MASTER_EXCLUSIVE_SECTION {
+    MPI_Reduce(MPI_IN_PLACE, norms, 2, MPI_DOUBLE, MPI_SUM, masterRank, lcomm);
+
+    // there is nothing to compare to in the first combination (or if the layout of
+    // the sparse grids changed)
+    combinationChange_ = -1.0;
+
+    if (!first) combinationChange_ = (norms[1] > 0.0) ? std::sqrt(norms[0] / norms[1]) : 0.0;
+
+    // the global reduce comm of the masters contains the masters of all groups
+    MPI_Allreduce(MPI_IN_PLACE, &combinationChange_, 1, MPI_DOUBLE, MPI_MAX,
+                  theMPISystem()->getGlobalReduceComm());
+  }
+  else {
+    MPI_Reduce(norms, nullptr, 2, MPI_DOUBLE, MPI_SUM, masterRank, lcomm);
+  }
+
+  MPI_Bcast(&combinationChange_, 1, MPI_DOUBLE, masterRank, lcomm);
+}
+
+int ProcessGroupWorker::adaptCombinationInterval(int interval) const {
+  if (combinationChange_ < 0.0) return interval;
+
+  real tolerance = combiParameters_.getCombinationChangeTolerance();
+
+  if (combinationChange_ < 0.5 * tolerance)
+    interval *= 2;
+  else if (combinationChange_ > tolerance)
+    interval /= 2;
+
+  return clampCombinationInterval(interval);
+}
+
+int ProcessGroupWorker::clampCombinationInterval(int interval) const {
+  int minRuns = int(combiParameters_.getMinRunsPerCombination());
+  int maxRuns = int(combiParameters_.getMaxRunsPerCombination());
+
+  return std::min(std::max(interval, minRuns), maxRuns);
+}
+
+bool ProcessGroupWorker::runTasks() {
+  // check if there are unfinished tasks
+  // all the tasks that are not the first in their process group will be run in this loop
+  for (size_t i = 0; i < tasks_.size(); ++i) {
+    if (!tasks_[i]->isFinished() && !isSubgroupTask(*tasks_[i])) {
+      status_ = PROCESS_GROUP_BUSY;
+
+      // set currentTask
+      currentTask_ = tasks_[i];
+      finishTaskInit(currentTask_);
+
+      // the next task is initialized while this one runs
+      prefetchTaskInit();
+
+      Stats::startEvent("worker run");
+      currentTask_->run(theMPISystem()->getLocalComm());
+      Stats::Event e = Stats::stopEvent("worker run");
+
+      // std::cout << "from ready ";
+      processDuration(*currentTask_, e, getCommSize(theMPISystem()->getLocalComm()));   
+      if (ENABLE_FT) {
+        // with this barrier the local root but also each other process can detect
+        // whether a process in the group has failed
+        int err = simft::Sim_FT_MPI_Barrier(theMPISystem()->getLocalCommFT());
+
+        if (err == MPI_ERR_PROC_FAILED) {
+          status_ = PROCESS_GROUP_FAIL;
+          break;
+        }
+      }
+      // merge problem?
+      // todo: gene specific voodoo
+      if (isGENE && !currentTask_->isFinished()) {
+        return false;
+      }
+      //
+    }
+  }
+
+  // tasks which were not run (e.g. after a fault) still need their grids
+  finishTaskInits();
+
+  if (status_ != PROCESS_GROUP_FAIL) runSubgroupTasks();
+
+  return true;
+}
+
+/**
+ * The small tasks are distributed over the subgroups when they are initialized. Each process
+ * runs the tasks of its own subgroup, so the subgroups work concurrently. The durations are
+ * reported by the first process of each subgroup to the master, which forwards them to the
+ * manager.
+ */
+void ProcessGroupWorker::runSubgroupTasks() {
+  size_t numForwarded = 0;
+
+  for (Task* t : tasks_) {
+    if (t->isFinished() || !isSubgroupTask(*t)) continue;
+
+    status_ = PROCESS_GROUP_BUSY;
+
+    CommunicatorType comm = getTaskComm(*t);
+
+    // computed by another subgroup
+    if (comm == MPI_COMM_NULL) {
+      t->setFinished(true);
+      ++numForwarded;
+      continue;
+    }
+
+    currentTask_ = t;
+    Stats::startEvent("worker run");
+    currentTask_->run(comm);
+    Stats::Event e = Stats::stopEvent("worker run");
+
+    processDuration(*currentTask_, e, getCommSize(comm));
+  }
+
+  MASTER_EXCLUSIVE_SECTION {
+    for (size_t i = 0; i < numForwarded; ++i) {
+      durationInformation info;
+      MPIUtils::receivePOD(&info, MPI_ANY_SOURCE, durationTag, theMPISystem()->getLocalComm());
+      reportDuration(info);
+    }
+  }
+}
+
+void ProcessGroupWorker::initSubgroups() {
+  size_t groupSize = getCommSize(theMPISystem()->getLocalComm());
+  size_t subgroupSize = combiParameters_.getSubgroupSize();
+
+  // a single subgroup would be the whole group
+  if (subgroupSize == 0 || subgroupSize >= groupSize) subgroupSize = groupSize;
+
+  size_t numSubgroups = (groupSize + subgroupSize - 1) / subgroupSize;
+
+  if (numSubgroups == subgroupPoints_.size()) return;
+
+  // the subgroups of the existing small tasks can not be changed
+  assert(subgroupTasks_.empty());
+
+  if (subgroupComm_ != MPI_COMM_NULL) MPI_Comm_free(&subgroupComm_);
+
+  subgroupPoints_.assign(numSubgroups, 0);
+  subgroup_ = theMPISystem()->getLocalRank() / int(subgroupSize);
+
+  if (numSubgroups > 1) {
+    MPI_Comm_split(theMPISystem()->getLocalComm(), subgroup_, theMPISystem()->getLocalRank(),
+                   &subgroupComm_);
+  }
+}
+
+void ProcessGroupWorker::assignSubgroup(const Task& t) {
+  if (subgroupPoints_.size() < 2) return;
+
+  size_t numPoints = t.getNumPoints();
+
+  if (numPoints > combiParameters_.getSubgroupMaxPoints()) return;
+
+  size_t subgroup = std::min_element(subgroupPoints_.begin(), subgroupPoints_.end()) -
+                    subgroupPoints_.begin();
+  subgroupPoints_[subgroup] += numPoints;
+
+  // the decomposition is set after the initialization of the task
+  subgroupTasks_[t.getID()] = {int(subgroup), true};
+}
+
+CommunicatorType ProcessGroupWorker::getTaskComm(const Task& t) const {
+  std::map<int, SubgroupTask>::const_iterator it = subgroupTasks_.find(t.getID());
+
+  if (it == subgroupTasks_.end()) return theMPISystem()->getLocalComm();
+
+  return (it->second.subgroup == subgroup_) ? subgroupComm_ : MPI_COMM_NULL;
+}
+
+DistributedFullGrid<CombiDataType>* ProcessGroupWorker::getTaskGrid(Task* t, int g) const {
+  if (getTaskComm(*t) == MPI_COMM_NULL) return nullptr;
+
+  return &t->getDistributedFullGrid(g);
+}
+
 /* not supported anymore
 void ProcessGroupWorker::combine() {
   assert( false && "not properly implemented" );
@@ -387,18 +844,8 @@ void reduceSparseGridCoefficients(LevelVector& lmax, LevelVector& lmin,
   }
 }
 
-void ProcessGroupWorker::combineUniform() {
-#ifdef DEBUG_OUTPUT
-
-  MASTER_EXCLUSIVE_SECTION { std::cout << "start combining \n"; }
-#endif
-  Stats::startEvent("combine init");
-
-  if (tasks_.size() == 0) {
-    std::cout << "Possible error: task size is 0! \n";
-  }
-  assert(combiParametersSet_);
-  // we assume here that every task has the same number of grids, e.g. species in GENE
+void ProcessGroupWorker::createUniformSG(
+    std::vector<std::unique_ptr<DistributedSparseGridUniform<CombiDataType>>>& dsgs) {
   int numGrids = combiParameters_.getNumGrids();
 
   DimType dim = combiParameters_.getDim();
@@ -422,85 +869,245 @@ void ProcessGroupWorker::combineUniform() {
 #endif
 
   // delete old dsgs
-  combinedUniDSGVector_.clear();
-  // create dsgs
-  combinedUniDSGVector_.resize(numGrids);
-  for (auto& uniDSG : combinedUniDSGVector_) {
+  dsgs.clear();
+  // create dsgs. in larger process groups only the first processes hold parts of the
+  // dsgs, the others keep empty ones to take part in the global reduction
+  CommunicatorType dsgComm = theMPISystem()->getLocalReduceComm();
+
+  if (dsgComm == MPI_COMM_NULL) dsgComm = MPI_COMM_SELF;
+
+  dsgs.resize(numGrids);
+  for (auto& uniDSG : dsgs) {
     uniDSG = std::unique_ptr<DistributedSparseGridUniform<CombiDataType>>(
-        new DistributedSparseGridUniform<CombiDataType>(dim, lmax, lmin, boundary,
-                                                        theMPISystem()->getLocalComm()));
+        new DistributedSparseGridUniform<CombiDataType>(dim, lmax, lmin, boundary, dsgComm));
   }
   // todo: move to init function to avoid reregistering
-  // register dsgs in all dfgs
+  // register dsgs in all dfgs. dfgs with a different parallelization are registered
+  // via a temporary grid when they are added to the dsg
   for (Task* t : tasks_) {
+    if (isSubgroupTask(*t)) continue;
+
     for (int g = 0; g < numGrids; g++) {
       DistributedFullGrid<CombiDataType>& dfg = t->getDistributedFullGrid(g);
 
-      dfg.registerUniformSG(*(combinedUniDSGVector_[g]));
+      if (hasCommonParallelization(dfg)) dfg.registerUniformSG(*(dsgs[g]));
     }
   }
-  Stats::stopEvent("combine init");
-  Stats::startEvent("combine hierarchize");
+}
 
-  real localMax(0.0);
-  // std::vector<CombiDataType> beforeCombi;
-  for (Task* t : tasks_) {
-    for (int g = 0; g < numGrids; g++) {
-      DistributedFullGrid<CombiDataType>& dfg = t->getDistributedFullGrid(g);
-      // std::vector<CombiDataType> datavector(dfg.getElementVector());
-      // beforeCombi = datavector;
-      // compute max norm
-      /*
-      real max = dfg.getLpNorm(0);
-      if( max > localMax )
-        localMax = max;
-        */
+bool ProcessGroupWorker::createPersistentSG(
+    std::vector<std::unique_ptr<DistributedSparseGridUniform<CombiDataType>>>& dsgs) {
+  // (re)create the persistent sparse grids if the layout of the sparse grid changed,
+  // e.g. in the last combination where lmin and lmax are not reduced
+  size_t numGrids = combinedUniDSGVector_.size();
+  bool reset = (dsgs.size() != numGrids);
 
-      // hierarchize dfg
-      DistributedHierarchization::hierarchize<CombiDataType>(
-          dfg, combiParameters_.getHierarchizationDims());
+  for (size_t g = 0; !reset && g < numGrids; ++g) {
+    reset = (dsgs[g]->getNMax() != combinedUniDSGVector_[g]->getNMax() ||
+             dsgs[g]->getNMin() != combinedUniDSGVector_[g]->getNMin());
+  }
 
-      // lokales reduce auf sg ->
-      dfg.addToUniformSG(*combinedUniDSGVector_[g], combiParameters_.getCoeff(t->getID()));
-#ifdef DEBUG_OUTPUT
-      std::cout << "Combination: added task " << t->getID() << " with coefficient "
-                << combiParameters_.getCoeff(t->getID()) << "\n";
-#endif
-    }
+  if (!reset) return false;
+
+  dsgs.clear();
+
+  for (size_t g = 0; g < numGrids; ++g) {
+    const DistributedSparseGridUniform<CombiDataType>& dsg = *combinedUniDSGVector_[g];
+
+    dsgs.emplace_back(new DistributedSparseGridUniform<CombiDataType>(
+        dsg.getDim(), dsg.getNMax(), dsg.getNMin(), dsg.getBoundaryVector(),
+        dsg.getCommunicator()));
   }
-  Stats::stopEvent("combine hierarchize");
 
-  // compute global max norm
-  /*
-  real globalMax_tmp;
-  MPI_Allreduce(  &localMax, &globalMax_tmp, 1, MPI_DOUBLE,
-                  MPI_MAX, theMPISystem()->getGlobalReduceComm() );
+  return true;
+}
 
-  real globalMax;
-  MPI_Allreduce(  &globalMax_tmp, &globalMax, 1, MPI_DOUBLE,
-                    MPI_MAX, theMPISystem()->getLocalComm() );
-                    */
-  Stats::startEvent("combine global reduce");
+bool ProcessGroupWorker::hasCommonParallelization(
+    const DistributedFullGrid<CombiDataType>& dfg) const {
+  bool equalGroupSize =
+      getCommSize(theMPISystem()->getLocalComm()) == int(theMPISystem()->getNumProcs());
 
-  for (int g = 0; g < numGrids; g++) {
-    CombiCom::distributedGlobalReduce(*combinedUniDSGVector_[g]);
+  // without a common parallelization the grids are combined with their own one, which
+  // is only possible if the grids have the same size in all groups
+  if (!combiParameters_.isParallelizationSet()) {
+    assert(equalGroupSize && "groups of different size need a common parallelization");
+    return true;
   }
-  Stats::stopEvent("combine global reduce");
 
-  // std::vector<CombiDataType> afterCombi;
-  Stats::startEvent("combine dehierarchize");
+  bool common = (dfg.getParallelization() == combiParameters_.getParallelization());
 
-  for (Task* t : tasks_) {
-    for (int g = 0; g < numGrids; g++) {
-      // get handle to dfg
-      DistributedFullGrid<CombiDataType>& dfg = t->getDistributedFullGrid(g);
+  // in the uniform mode all tasks have to use the common parallelization, which is
+  // not possible in groups which are larger than the smallest one
+  assert(common || !uniformDecomposition || !equalGroupSize);
 
-      // extract dfg vom dsg
-      dfg.extractFromUniformSG(*combinedUniDSGVector_[g]);
+  return common;
+}
 
-      // dehierarchize dfg
-      DistributedHierarchization::dehierarchize<CombiDataType>(
-          dfg, combiParameters_.getHierarchizationDims());
+/**
+ * The subspaces of a dsg are distributed like the subspaces of the dfgs which have been
+ * registered in it, so all dfgs added to a dsg must have the same decomposition. A dfg with
+ * a different parallelization is redistributed to a temporary grid with the common
+ * parallelization, which is used for the local reduction instead. In process groups which are
+ * larger than the smallest group, the temporary grid only lives on the first processes (the
+ * local reduce comm) and nullptr is returned on the others. The manager only places a task on
+ * a group where the temporary grid fits into the memory per process of the combination
+ * parameters (see ProcessManager::getCommonGridMemoryRequirement).
+ */
+std::unique_ptr<DistributedFullGrid<CombiDataType>> ProcessGroupWorker::createCommonGrid(
+    const Task& t, const DistributedFullGrid<CombiDataType>* dfg,
+    DistributedSparseGridUniform<CombiDataType>& dsg) {
+  if (theMPISystem()->getLocalReduceComm() == MPI_COMM_NULL) return nullptr;
+
+  /* the temporary grid comes on top of the grids of the task on this process. the manager
+   * only places tasks on this group which fit, unless they get here in another way (e.g.
+   * by the recovery of a fault)
+   */
+  size_t memoryPerProcess = combiParameters_.getMemoryPerProcess();
+  size_t groupSize = size_t(getCommSize(theMPISystem()->getLocalComm()));
+
+  if (memoryPerProcess > 0 &&
+      combiParameters_.getCommonGridMemoryRequirement(t, groupSize, isSubgroupTask(t)) >
+          memoryPerProcess) {
+    std::cout << "the temporary grid of task " << t.getID()
+              << " exceeds the memory per process! Aborting! \n";
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+
+  // the decomposition has to match the one of the grids in the other groups
+  bool forwardDecomposition = isSubgroupTask(t)
+                                  ? subgroupTasks_.at(t.getID()).forwardDecomposition
+                                  : dfg->isForwardDecomposition();
+
+  std::unique_ptr<DistributedFullGrid<CombiDataType>> commonDfg(
+      new DistributedFullGrid<CombiDataType>(
+          t.getDim(), t.getLevelVector(), theMPISystem()->getLocalReduceComm(),
+          t.getBoundary(), combiParameters_.getParallelization(), forwardDecomposition));
+
+  commonDfg->registerUniformSG(dsg);
+
+  return commonDfg;
+}
+
+void ProcessGroupWorker::addToUniformSG(Task* t, int g,
+                                        DistributedSparseGridUniform<CombiDataType>& dsg,
+                                        real coeff) {
+  DistributedFullGrid<CombiDataType>* dfg = getTaskGrid(t, g);
+
+  // grids on subgroups always live on other processes than the dsg
+  if (!isSubgroupTask(*t) && hasCommonParallelization(*dfg)) {
+    dfg->addToUniformSG(dsg, coeff);
+    return;
+  }
+
+  std::unique_ptr<DistributedFullGrid<CombiDataType>> commonDfg = createCommonGrid(*t, dfg, dsg);
+  CombiCom::redistribute(dfg, commonDfg.get(), t->getDim(), theMPISystem()->getLocalComm());
+
+  if (commonDfg) commonDfg->addToUniformSG(dsg, coeff);
+}
+
+void ProcessGroupWorker::extractFromUniformSG(Task* t, int g,
+                                              DistributedSparseGridUniform<CombiDataType>& dsg) {
+  DistributedFullGrid<CombiDataType>* dfg = getTaskGrid(t, g);
+
+  if (!isSubgroupTask(*t) && hasCommonParallelization(*dfg)) {
+    dfg->extractFromUniformSG(dsg);
+    return;
+  }
+
+  // the values of subspaces which are not contained in the dsg are kept, so the
+  // temporary grid has to start with the values of dfg
+  std::unique_ptr<DistributedFullGrid<CombiDataType>> commonDfg = createCommonGrid(*t, dfg, dsg);
+  CombiCom::redistribute(dfg, commonDfg.get(), t->getDim(), theMPISystem()->getLocalComm());
+
+  if (commonDfg) commonDfg->extractFromUniformSG(dsg);
+
+  CombiCom::redistribute(commonDfg.get(), dfg, t->getDim(), theMPISystem()->getLocalComm());
+}
+
+void ProcessGroupWorker::combineUniform() {
+#ifdef DEBUG_OUTPUT
+
+  MASTER_EXCLUSIVE_SECTION { std::cout << "start combining \n"; }
+#endif
+  // a pending asynchronous combination has to be applied first
+  finishCombineUniformAsync();
+
+  Stats::startEvent("combine init");
+
+  if (tasks_.size() == 0) {
+    std::cout << "Possible error: task size is 0! \n";
+  }
+  assert(combiParametersSet_);
+  // we assume here that every task has the same number of grids, e.g. species in GENE
+  int numGrids = combiParameters_.getNumGrids();
+
+  createUniformSG(combinedUniDSGVector_);
+  Stats::stopEvent("combine init");
+  Stats::startEvent("combine hierarchize");
+
+  real localMax(0.0);
+  // std::vector<CombiDataType> beforeCombi;
+  for (Task* t : tasks_) {
+    for (int g = 0; g < numGrids; g++) {
+      // small tasks of other subgroups only take part in the redistribution
+      DistributedFullGrid<CombiDataType>* dfg = getTaskGrid(t, g);
+      // std::vector<CombiDataType> datavector(dfg.getElementVector());
+      // beforeCombi = datavector;
+      // compute max norm
+      /*
+      real max = dfg.getLpNorm(0);
+      if( max > localMax )
+        localMax = max;
+        */
+
+      // hierarchize dfg
+      if (dfg != nullptr) {
+        DistributedHierarchization::hierarchize<CombiDataType>(
+            *dfg, combiParameters_.getHierarchizationDims());
+      }
+
+      // lokales reduce auf sg ->
+      addToUniformSG(t, g, *combinedUniDSGVector_[g], combiParameters_.getCoeff(t->getID()));
+#ifdef DEBUG_OUTPUT
+      std::cout << "Combination: added task " << t->getID() << " with coefficient "
+                << combiParameters_.getCoeff(t->getID()) << "\n";
+#endif
+    }
+  }
+  Stats::stopEvent("combine hierarchize");
+
+  // compute global max norm
+  /*
+  real globalMax_tmp;
+  MPI_Allreduce(  &localMax, &globalMax_tmp, 1, MPI_DOUBLE,
+                  MPI_MAX, theMPISystem()->getGlobalReduceComm() );
+
+  real globalMax;
+  MPI_Allreduce(  &globalMax_tmp, &globalMax, 1, MPI_DOUBLE,
+                    MPI_MAX, theMPISystem()->getLocalComm() );
+                    */
+  Stats::startEvent("combine global reduce");
+
+  reduceUniformSG();
+  Stats::stopEvent("combine global reduce");
+
+  if (combiParameters_.isAdaptiveCombination()) computeCombinationChange();
+
+  // std::vector<CombiDataType> afterCombi;
+  Stats::startEvent("combine dehierarchize");
+
+  for (Task* t : tasks_) {
+    for (int g = 0; g < numGrids; g++) {
+      // extract dfg vom dsg
+      extractFromUniformSG(t, g, *combinedUniDSGVector_[g]);
+
+      // dehierarchize dfg
+      DistributedFullGrid<CombiDataType>* dfg = getTaskGrid(t, g);
+
+      if (dfg != nullptr) {
+        DistributedHierarchization::dehierarchize<CombiDataType>(
+            *dfg, combiParameters_.getHierarchizationDims());
+      }
 
       // std::vector<CombiDataType> datavector(dfg.getElementVector());
       // afterCombi = datavector;
@@ -554,15 +1161,289 @@ void ProcessGroupWorker::combineUniform() {
    */
 }
 
+void ProcessGroupWorker::reduceUniformSG() {
+  int numGrids = combiParameters_.getNumGrids();
+
+  assert(!(combiParameters_.isDeltaCombination() && combiParameters_.isReducedPrecisionReduce()));
+
+  // the delta and reduced precision reductions are allreduces
+  combinedUniDSGComplete_ = true;
+
+  if (combiParameters_.isDeltaCombination()) {
+    createPersistentSG(deltaSentDSGVector_);
+    createPersistentSG(deltaCombinedDSGVector_);
+
+    for (int g = 0; g < numGrids; g++) {
+      CombiCom::distributedGlobalReduceDelta(*combinedUniDSGVector_[g], *deltaSentDSGVector_[g],
+                                             *deltaCombinedDSGVector_[g],
+                                             combiParameters_.getDeltaCombinationTolerance());
+    }
+    return;
+  }
+
+  if (combiParameters_.isReducedPrecisionReduce()) {
+    createPersistentSG(reducedPrecisionResidualDSGVector_);
+
+    for (int g = 0; g < numGrids; g++) {
+      CombiCom::distributedGlobalReduceReducedPrecision(
+          *combinedUniDSGVector_[g], *reducedPrecisionResidualDSGVector_[g],
+          combiParameters_.getReducedPrecisionMinLevelSum());
+    }
+    return;
+  }
+
+  if (combiParameters_.getGlobalReduceType() == GLOBAL_REDUCE_AUTOTUNE) {
+    autotuneReduceUniformSG();
+    return;
+  }
+
+  reduceUniformSG(combiParameters_.getGlobalReduceType());
+}
+
+void ProcessGroupWorker::reduceUniformSG(GlobalReduceType reduceType) {
+  int numGrids = combiParameters_.getNumGrids();
+
+  combinedUniDSGComplete_ =
+      (reduceType != GLOBAL_REDUCE_REDUCE_SCATTER && reduceType != GLOBAL_REDUCE_RMA);
+
+  // with several grids (e.g. species in GENE) all reductions are started at once, each on
+  // its own communicator. the reduction of one grid then overlaps with the packing and
+  // unpacking of the others instead of numGrids allreduces in a row
+  if (reduceType == GLOBAL_REDUCE_ALLREDUCE && numGrids > 1 && USE_NONBLOCKING_MPI_COLLECTIVE) {
+    std::vector<GlobalReduceRequest<CombiDataType>> requests(numGrids);
+
+    for (int g = 0; g < numGrids; g++) {
+      CombiCom::startDistributedGlobalReduce(*combinedUniDSGVector_[g], requests[g],
+                                             theMPISystem()->getGlobalReduceGridComm(g));
+    }
+
+    for (int g = 0; g < numGrids; g++) {
+      CombiCom::finishDistributedGlobalReduce(*combinedUniDSGVector_[g], requests[g]);
+    }
+    return;
+  }
+
+  for (int g = 0; g < numGrids; g++) {
+    switch (reduceType) {
+      case GLOBAL_REDUCE_REDUCE_SCATTER:
+        CombiCom::distributedGlobalReduceScatter(*combinedUniDSGVector_[g]);
+        break;
+      case GLOBAL_REDUCE_HIERARCHICAL:
+        globalReduceSharedWindows_.resize(numGrids);
+        CombiCom::distributedGlobalReduceHierarchical(*combinedUniDSGVector_[g],
+                                                      globalReduceSharedWindows_[g]);
+        break;
+      case GLOBAL_REDUCE_RMA:
+        globalReduceWindows_.resize(numGrids);
+        CombiCom::distributedGlobalReduceRMA(*combinedUniDSGVector_[g], globalReduceWindows_[g]);
+        break;
+      default:
+        CombiCom::distributedGlobalReduce(*combinedUniDSGVector_[g]);
+        break;
+    }
+  }
+}
+
+void ProcessGroupWorker::checkCombinedUniDSGComplete(const std::string& operation) const {
+  // the subspaces of other groups would be read as zeros
+  if (!combinedUniDSGComplete_) {
+    std::cout << operation << " needs the full combined solution, which the reduce-scatter "
+              << "and RMA global reductions do not provide! Aborting! \n";
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+}
+
+void ProcessGroupWorker::autotuneReduceUniformSG() {
+  if (!globalReduceAutotuner_) {
+    globalReduceAutotuner_.reset(
+        new GlobalReduceAutotuner(combiParameters_.getGlobalReduceTuningFile()));
+  }
+
+  // the class of the reduction is given by the sparse grid (which changes if lmin and
+  // lmax are reduced), the decomposition and the number of groups
+  const DistributedSparseGridUniform<CombiDataType>& dsg = *combinedUniDSGVector_[0];
+  // without a common parallelization the decomposition is not part of the key, it has
+  // to be the same in all groups
+  IndexVector parallelization;
+
+  if (combiParameters_.isParallelizationSet())
+    parallelization = combiParameters_.getParallelization();
+
+  std::string key =
+      GlobalReduceAutotuner::getKey(dsg.getNMin(), dsg.getNMax(), parallelization,
+                                    static_cast<int>(theMPISystem()->getNumGroups()));
+
+  GlobalReduceType reduceType = globalReduceAutotuner_->select(key);
+
+  if (globalReduceAutotuner_->isTuned(key)) {
+    reduceUniformSG(reduceType);
+    return;
+  }
+
+  MPI_Comm globalReduceComm = theMPISystem()->getGlobalReduceComm();
+
+  MPI_Barrier(globalReduceComm);
+  double time = MPI_Wtime();
+
+  reduceUniformSG(reduceType);
+
+  time = MPI_Wtime() - time;
+
+  // use the maximum over all workers, so that all processes take the same decision
+  MPI_Allreduce(MPI_IN_PLACE, &time, 1, MPI_DOUBLE, MPI_MAX, theMPISystem()->getLocalComm());
+  MPI_Allreduce(MPI_IN_PLACE, &time, 1, MPI_DOUBLE, MPI_MAX, globalReduceComm);
+
+  // only one process writes the tuning file
+  bool write = (theMPISystem()->getLocalRank() == 0 && getCommRank(globalReduceComm) == 0);
+  globalReduceAutotuner_->record(key, reduceType, time, write);
+
+#ifdef DEBUG_OUTPUT
+  MASTER_EXCLUSIVE_SECTION {
+    std::cout << "global reduce " << reduceType << " for " << key << ": " << time << " s"
+              << std::endl;
+  }
+#endif
+}
+
+/**
+ * In the asynchronous (lagged) combination the hierarchical surpluses of the current state are
+ * added to the sparse grid and the global reduction is started without waiting for it. The
+ * component grids are restored immediately, so that the tasks can continue with the next time
+ * steps while the reduction is in progress. The combined solution is applied by
+ * finishCombineUniformAsync at the beginning of the next combination (or at exit, or when
+ * the combined solution is read by parallelEval or to initialize a task).
+ * Only the nonblocking allreduce can run in the background, the other reduce types,
+ * the delta combination and the reduced precision are not available here.
+ */
+void ProcessGroupWorker::combineUniformAsync() {
+  if (!combiParameters_.isAsyncCombinationSupported()) {
+    std::cout << "the asynchronous combination only supports the plain allreduce! "
+              << "Aborting! \n";
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+
+  // apply the previous asynchronous combination first
+  finishCombineUniformAsync();
+
+  Stats::startEvent("combine init");
+
+  if (tasks_.size() == 0) {
+    std::cout << "Possible error: task size is 0! \n";
+  }
+  assert(combiParametersSet_);
+  int numGrids = combiParameters_.getNumGrids();
+
+  createUniformSG(asyncUniDSGVector_);
+  Stats::stopEvent("combine init");
+
+  Stats::startEvent("combine hierarchize");
+
+  for (Task* t : tasks_) {
+    std::vector<std::vector<CombiDataType>>& snapshots = asyncSnapshots_[t->getID()];
+    snapshots.resize(numGrids);
+
+    for (int g = 0; g < numGrids; g++) {
+      DistributedFullGrid<CombiDataType>* dfg = getTaskGrid(t, g);
+
+      if (dfg != nullptr) {
+        DistributedHierarchization::hierarchize<CombiDataType>(
+            *dfg, combiParameters_.getHierarchizationDims());
+      }
+
+      addToUniformSG(t, g, *asyncUniDSGVector_[g], combiParameters_.getCoeff(t->getID()));
+
+      if (dfg == nullptr) continue;
+
+      // keep the surpluses of this state to compute the correction later
+      snapshots[g] = dfg->getElementVector();
+
+      DistributedHierarchization::dehierarchize<CombiDataType>(
+          *dfg, combiParameters_.getHierarchizationDims());
+    }
+  }
+  Stats::stopEvent("combine hierarchize");
+
+  Stats::startEvent("combine global reduce start");
+  asyncReduceRequests_.resize(numGrids);
+
+  for (int g = 0; g < numGrids; g++) {
+    CombiCom::startDistributedGlobalReduce(*asyncUniDSGVector_[g], asyncReduceRequests_[g],
+                                           theMPISystem()->getGlobalReduceGridComm(g));
+  }
+  Stats::stopEvent("combine global reduce start");
+}
+
+/**
+ * The tasks have advanced since the asynchronous combination was started. Instead of replacing
+ * their state, the difference between the combined solution and the own contribution at the
+ * time of the snapshot is added to the current state (as hierarchization is linear, this can be
+ * done in the nodal basis).
+ */
+void ProcessGroupWorker::finishCombineUniformAsync() {
+  if (asyncUniDSGVector_.empty()) return;
+
+  int numGrids = combiParameters_.getNumGrids();
+
+  Stats::startEvent("combine global reduce finish");
+
+  for (int g = 0; g < numGrids; g++) {
+    CombiCom::finishDistributedGlobalReduce(*asyncUniDSGVector_[g], asyncReduceRequests_[g]);
+  }
+  Stats::stopEvent("combine global reduce finish");
+
+  Stats::startEvent("combine dehierarchize");
+
+  for (Task* t : tasks_) {
+    auto snapshots = asyncSnapshots_.find(t->getID());
+
+    // tasks which were added after the start of the combination are not corrected
+    if (snapshots == asyncSnapshots_.end()) continue;
+
+    for (int g = 0; g < numGrids; g++) {
+      DistributedFullGrid<CombiDataType>* dfg = getTaskGrid(t, g);
+
+      // small tasks of other subgroups only take part in the redistribution
+      if (dfg == nullptr) {
+        extractFromUniformSG(t, g, *asyncUniDSGVector_[g]);
+        continue;
+      }
+
+      std::vector<CombiDataType>& elements = dfg->getElementVector();
+      const std::vector<CombiDataType>& snapshot = snapshots->second[g];
+
+      std::vector<CombiDataType> current(elements);
+
+      // correction = combined solution - own surpluses at the time of the snapshot
+      elements = snapshot;
+      extractFromUniformSG(t, g, *asyncUniDSGVector_[g]);
+
+      for (size_t i = 0; i < elements.size(); ++i) elements[i] -= snapshot[i];
+
+      DistributedHierarchization::dehierarchize<CombiDataType>(
+          *dfg, combiParameters_.getHierarchizationDims());
+
+      for (size_t i = 0; i < elements.size(); ++i) elements[i] += current[i];
+    }
+  }
+  Stats::stopEvent("combine dehierarchize");
+
+  // the reduced sparse grids are the current combined solution
+  combinedUniDSGVector_ = std::move(asyncUniDSGVector_);
+  combinedUniDSGComplete_ = true;
+  asyncUniDSGVector_.clear();
+  asyncReduceRequests_.clear();
+  asyncSnapshots_.clear();
+}
+
 void ProcessGroupWorker::parallelEval() {
-  if (uniformDecomposition)
-    parallelEvalUniform();
-  else
-    assert(false && "not yet implemented");
+  // the plot grid always uses the common parallelization of the sparse grids, so
+  // the uniform operation works for both decompositions
+  parallelEvalUniform();
 }
 
 void ProcessGroupWorker::parallelEvalUniform() {
-  assert(uniformDecomposition);
+  // a pending asynchronous combination holds the latest combined solution
+  finishCombineUniformAsync();
 
   assert(combiParametersSet_);
   int numGrids = combiParameters_
@@ -572,6 +1453,7 @@ void ProcessGroupWorker::parallelEvalUniform() {
 
   // combine must have been called before this function
   assert(combinedUniDSGVector_.size() != 0 && "you must combine before you can eval");
+  checkCombinedUniDSGComplete("parallel eval");
 
   // receive leval and broadcast to group members
   std::vector<int> tmp(dim);
@@ -593,11 +1475,14 @@ void ProcessGroupWorker::parallelEvalUniform() {
   MPIUtils::broadcastClass(&filename, theMPISystem()->getMasterRank(),
                            theMPISystem()->getLocalComm());
 
+  // in larger process groups only the processes which hold the dsgs take part
+  if (theMPISystem()->getLocalReduceComm() == MPI_COMM_NULL) return;
+
   for (int g = 0; g < numGrids; g++) {  // loop over all grids and plot them
     // create dfg
     bool forwardDecomposition = !isGENE;
     DistributedFullGrid<CombiDataType> dfg(
-        dim, leval, theMPISystem()->getLocalComm(), combiParameters_.getBoundary(),
+        dim, leval, theMPISystem()->getLocalReduceComm(), combiParameters_.getBoundary(),
         combiParameters_.getParallelization(), forwardDecomposition);
 
     // register dsg
@@ -617,14 +1502,9 @@ void ProcessGroupWorker::parallelEvalUniform() {
 }
 
 void ProcessGroupWorker::gridEval() {  // not supported anymore
-  /* error if no tasks available
-   * todo: however, this is not a real problem, we could can create an empty
-   * grid an contribute to the reduce operation. at the moment even the dim
-   * parameter is stored in the tasks, so if no task available we have no access
-   * to this parameter.
+  /* a group without tasks (e.g. after task migration) contributes an empty grid
+   * to the reduce operation. the dimension is taken from the combi parameters
    */
-  assert(tasks_.size() > 0);
-
   assert(combiParametersSet_);
   const DimType dim = combiParameters_.getDim();
 
@@ -661,7 +1541,11 @@ void ProcessGroupWorker::gridEval() {  // not supported anymore
 
     MASTER_EXCLUSIVE_SECTION { fg.createFullGrid(); }
 
-    t->getFullGrid(fg, theMPISystem()->getMasterRank(), theMPISystem()->getLocalComm());
+    if (isSubgroupTask(*t)) {
+      gatherSubgroupFullGrid(t, fg);
+    } else {
+      t->getFullGrid(fg, theMPISystem()->getMasterRank(), theMPISystem()->getLocalComm());
+    }
 
     MASTER_EXCLUSIVE_SECTION { fg_red.add(fg, combiParameters_.getCoeff(t->getID())); }
   }
@@ -671,6 +1555,39 @@ void ProcessGroupWorker::gridEval() {  // not supported anymore
   }
 }
 
+void ProcessGroupWorker::gatherSubgroupFullGrid(Task* t, FullGrid<CombiDataType>& fg) {
+  // the first process of the subgroup gathers the grid and sends it to the master
+  RankType root = RankType(subgroupTasks_.at(t->getID()).subgroup) *
+                  RankType(combiParameters_.getSubgroupSize());
+  CommunicatorType comm = getTaskComm(*t);
+
+  if (comm != MPI_COMM_NULL) {
+    if (getCommRank(comm) == 0 && !fg.isGridCreated()) fg.createFullGrid();
+
+    t->getFullGrid(fg, 0, comm);
+  }
+
+  if (root == theMPISystem()->getMasterRank()) return;
+
+  MPI_Datatype dtype = abstraction::getMPIDatatype(
+      abstraction::getabstractionDataType<CombiDataType>());
+
+  MPI_Datatype largeType;
+  int count = MPILargeCount::createLargeType(fg.getNrElements(), dtype, &largeType);
+
+  if (theMPISystem()->getLocalRank() == root) {
+    MPI_Send(fg.getData(), count, largeType, theMPISystem()->getMasterRank(), infoTag,
+             theMPISystem()->getLocalComm());
+  }
+
+  MASTER_EXCLUSIVE_SECTION {
+    MPI_Recv(fg.getData(), count, largeType, root, infoTag, theMPISystem()->getLocalComm(),
+             MPI_STATUS_IGNORE);
+  }
+
+  MPILargeCount::freeLargeType(&largeType, dtype);
+}
+
 void ProcessGroupWorker::initializeTaskAndFaults(bool mayAlreadyExist /*=true*/) {
   Task* t;
 
@@ -704,6 +1621,454 @@ void ProcessGroupWorker::initializeTaskAndFaults(bool mayAlreadyExist /*=true*/)
   Stats::stopEvent("task init in worker");
 }
 
+void ProcessGroupWorker::initializeTasks() {
+  TaskContainer tasks;
+
+  // local root receives all tasks in one message
+  MASTER_EXCLUSIVE_SECTION {
+    MPIUtils::receiveClass(&tasks, theMPISystem()->getManagerRank(),
+                           theMPISystem()->getGlobalComm());
+  }
+
+  MPIUtils::broadcastClass(&tasks, theMPISystem()->getMasterRank(),
+                           theMPISystem()->getLocalComm());
+
+  initializeTasks(tasks);
+}
+
+void ProcessGroupWorker::initializeTasks(const TaskContainer& tasks) {
+  status_ = PROCESS_GROUP_BUSY;
+
+  Stats::startEvent("task init in worker");
+
+  const bool prefetch = isPrefetchTaskInit();
+
+  for (Task* t : tasks) {
+    tasks_.push_back(t);
+
+    // small tasks are only initialized on their subgroup
+    assignSubgroup(*t);
+    CommunicatorType comm = getTaskComm(*t);
+
+    currentTask_ = t;
+
+    // the tasks of the whole group are initialized while the previous one runs
+    if (prefetch && !isSubgroupTask(*t))
+      uninitializedTasks_.push_back(t);
+    else if (comm != MPI_COMM_NULL)
+      currentTask_->init(comm);
+
+    t_fault_ = currentTask_->initFaults(t_fault_, startTimeIteration_);
+    currentTask_->setFinished(false);
+  }
+
+  // all processes need the decomposition of the small tasks for the combination
+  std::vector<int> forward;
+
+  for (Task* t : tasks) {
+    if (!isSubgroupTask(*t)) continue;
+
+    bool owner = (getTaskComm(*t) != MPI_COMM_NULL);
+    forward.push_back(owner && t->getDistributedFullGrid(0).isForwardDecomposition());
+  }
+
+  if (!forward.empty()) {
+    MPI_Allreduce(MPI_IN_PLACE, forward.data(), static_cast<int>(forward.size()), MPI_INT,
+                  MPI_MAX, theMPISystem()->getLocalComm());
+
+    std::vector<int>::const_iterator it = forward.begin();
+
+    for (Task* t : tasks) {
+      if (isSubgroupTask(*t)) subgroupTasks_[t->getID()].forwardDecomposition = *it++;
+    }
+  }
+
+  Stats::stopEvent("task init in worker");
+
+  // the first task is initialized while the status is reported
+  if (prefetch) prefetchTaskInit();
+}
+
+bool ProcessGroupWorker::isPrefetchTaskInit() const {
+  if (!combiParameters_.isPrefetchTaskInit() || isGENE) return false;
+
+  int provided;
+  MPI_Query_thread(&provided);
+
+  return provided == MPI_THREAD_MULTIPLE;
+}
+
+void ProcessGroupWorker::prefetchTaskInit() {
+  if (prefetchThread_.joinable() || uninitializedTasks_.empty()) return;
+
+  prefetchTask_ = uninitializedTasks_.front();
+  uninitializedTasks_.pop_front();
+
+  MPI_Comm_dup(theMPISystem()->getLocalComm(), &prefetchComm_);
+
+  Task* t = prefetchTask_;
+  CommunicatorType comm = prefetchComm_;
+  prefetchThread_ = std::thread([t, comm]() { t->init(comm); });
+}
+
+void ProcessGroupWorker::finishTaskInit(Task* t) {
+  auto it = std::find(uninitializedTasks_.begin(), uninitializedTasks_.end(), t);
+
+  if (t != prefetchTask_ && it == uninitializedTasks_.end()) return;
+
+  // only the time which is not hidden behind the previous task is measured
+  Stats::startEvent("task init in worker");
+
+  if (t == prefetchTask_) {
+    prefetchThread_.join();
+    prefetchTask_ = nullptr;
+    MPI_Comm_free(&prefetchComm_);
+  } else {
+    uninitializedTasks_.erase(it);
+    t->init(theMPISystem()->getLocalComm());
+  }
+
+  Stats::stopEvent("task init in worker");
+}
+
+void ProcessGroupWorker::finishTaskInits() {
+  if (prefetchTask_ != nullptr) finishTaskInit(prefetchTask_);
+
+  while (!uninitializedTasks_.empty()) finishTaskInit(uninitializedTasks_.front());
+}
+
+void ProcessGroupWorker::abortTaskInits() {
+  /* the simulated faults happen in the run of a task, i.e. after the initialization of
+   * the next task was started on all processes of the group. the helper thread of a
+   * failed process still takes part in its collectives, so the join does not block
+   */
+  if (prefetchTask_ != nullptr) finishTaskInit(prefetchTask_);
+
+  uninitializedTasks_.clear();
+}
+
+std::string ProcessGroupWorker::receiveCheckpointFilename() {
+  std::string filename;
+
+  MASTER_EXCLUSIVE_SECTION {
+    MPIUtils::receiveClass(&filename, theMPISystem()->getManagerRank(),
+                           theMPISystem()->getGlobalComm());
+
+    // the rank of the master in the global comm is the index of the group
+    filename += "_group" + std::to_string(theMPISystem()->getGlobalRank()) + ".dcg";
+  }
+
+  MPIUtils::broadcastClass(&filename, theMPISystem()->getMasterRank(),
+                           theMPISystem()->getLocalComm());
+
+  return filename;
+}
+
+/**
+ * The checkpoint of a group consists of
+ * - a header: the size of the serialized tasks, the index of the next combination, the
+ *   number of processes of the group, whether the combined sparse grids are complete
+ *   and the serialized tasks of the group
+ * - the values of each grid of each task in the order of the global full grid
+ * - the local parts of the sparse grids which are kept between the combinations
+ * The master writes the header, all processes of the group write their parts of the
+ * grids collectively. The file is written to filename.tmp, so an interrupted checkpoint
+ * does not destroy the previous one.
+ */
+void ProcessGroupWorker::writeCheckpoint(const std::string& filename) {
+  // the GENE tasks are computed outside of the worker and have checkpoints of their own
+  assert(!isGENE);
+
+  // a pending lagged combination becomes part of the checkpoint
+  finishCombineUniformAsync();
+
+  Stats::startEvent("write checkpoint");
+
+  CommunicatorType lcomm = theMPISystem()->getLocalComm();
+
+  MPI_File fh;
+  MPI_File_open(lcomm, (filename + ".tmp").c_str(), MPI_MODE_WRONLY | MPI_MODE_CREATE,
+                MPI_INFO_NULL, &fh);
+  MPI_File_set_size(fh, 0);
+
+  MPI_Offset offset = 0;
+
+  MASTER_EXCLUSIVE_SECTION {
+    std::vector<char> buf;
+    MPIUtils::serialize(&tasks_, buf);
+
+    uint64_t header[4] = {buf.size(), uint64_t(currentCombi_),
+                          uint64_t(getCommSize(lcomm)), uint64_t(combinedUniDSGComplete_)};
+    MPI_File_write_at(fh, 0, header, int(sizeof(header)), MPI_BYTE, MPI_STATUS_IGNORE);
+    MPI_File_write_at(fh, sizeof(header), buf.data(), int(buf.size()), MPI_BYTE,
+                      MPI_STATUS_IGNORE);
+
+    offset = sizeof(header) + buf.size();
+  }
+
+  MPI_Bcast(&offset, 1, MPI_OFFSET, theMPISystem()->getMasterRank(), lcomm);
+
+  int numGrids = combiParameters_.getNumGrids();
+
+  for (Task* t : tasks_) {
+    for (int g = 0; g < numGrids; ++g) {
+      // the processes of other subgroups take part without data
+      DistributedFullGrid<CombiDataType>* dfg = getTaskGrid(t, g);
+
+      if (dfg != nullptr)
+        dfg->writeToFile(fh, offset);
+      else
+        DistributedFullGrid<CombiDataType>::writeEmptyToFile(fh);
+
+      offset += t->getNumPoints() * sizeof(CombiDataType);
+    }
+  }
+
+  offset = writeSparseGrids(fh, offset, combinedUniDSGVector_);
+  offset = writeSparseGrids(fh, offset, deltaSentDSGVector_);
+  offset = writeSparseGrids(fh, offset, deltaCombinedDSGVector_);
+  offset = writeSparseGrids(fh, offset, reducedPrecisionResidualDSGVector_);
+  offset = writeSparseGrids(fh, offset, previousCombinedDSGVector_);
+
+  MPI_File_close(&fh);
+
+  Stats::stopEvent("write checkpoint");
+}
+
+void ProcessGroupWorker::readCheckpoint(const std::string& filename) {
+  assert(!isGENE);
+  assert(tasks_.empty() && "the tasks of a checkpoint replace the initialization of the group");
+
+  Stats::startEvent("read checkpoint");
+
+  MPI_File fh;
+  int err = MPI_File_open(theMPISystem()->getLocalComm(), filename.c_str(), MPI_MODE_RDONLY,
+                          MPI_INFO_NULL, &fh);
+
+  // the manager checks the files before the restart, so they disappeared in between
+  if (err != MPI_SUCCESS) {
+    std::cout << "could not open checkpoint " << filename << "! Aborting! \n";
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+
+  // every process reads the header on its own
+  uint64_t header[4];
+  MPI_File_read_at(fh, 0, header, int(sizeof(header)), MPI_BYTE, MPI_STATUS_IGNORE);
+
+  // the sparse grids are stored in the decomposition of the group which wrote them
+  int size = getCommSize(theMPISystem()->getLocalComm());
+
+  if (header[2] != uint64_t(size)) {
+    std::cout << "checkpoint " << filename << " was written by a group of " << header[2]
+              << " processes, it can not be read by a group of " << size
+              << " processes! Aborting! \n";
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+
+  std::vector<char> buf(header[0]);
+  MPI_File_read_at(fh, sizeof(header), buf.data(), int(buf.size()), MPI_BYTE,
+                   MPI_STATUS_IGNORE);
+
+  TaskContainer tasks;
+  MPIUtils::deserialize(&tasks, buf.data(), buf.size());
+
+  currentCombi_ = IndexType(header[1]);
+
+  /* the state of the last combination is replaced by the one of the checkpoint. the
+   * windows of the global reduction belong to the sparse grids which are read below and
+   * are created again in the next combination
+   */
+  finishCombineUniformAsync();
+
+  for (auto& window : globalReduceWindows_) CombiCom::freeGlobalReduceWindow(window);
+  globalReduceWindows_.clear();
+
+  for (auto& window : globalReduceSharedWindows_) CombiCom::freeGlobalReduceSharedWindow(window);
+  globalReduceSharedWindows_.clear();
+
+  combinedUniDSGComplete_ = (header[3] != 0);
+
+  // not part of the checkpoint, the adaptive combination starts from the given interval
+  combinationChange_ = -1.0;
+
+  // the tasks are initialized as in a RUN_FIRST_BATCH, but filled from the file
+  initializeTasks(tasks);
+  finishTaskInits();
+
+  MPI_Offset offset = sizeof(header) + buf.size();
+  int numGrids = combiParameters_.getNumGrids();
+
+  for (Task* t : tasks_) {
+    for (int g = 0; g < numGrids; ++g) {
+      DistributedFullGrid<CombiDataType>* dfg = getTaskGrid(t, g);
+
+      if (dfg != nullptr)
+        dfg->readFromFile(fh, offset);
+      else
+        DistributedFullGrid<CombiDataType>::readEmptyFromFile(fh);
+
+      offset += t->getNumPoints() * sizeof(CombiDataType);
+    }
+
+    // the tasks are not run again before the next combination
+    t->setFinished(true);
+  }
+
+  offset = readSparseGrids(fh, offset, combinedUniDSGVector_, false);
+  offset = readSparseGrids(fh, offset, deltaSentDSGVector_, true);
+  offset = readSparseGrids(fh, offset, deltaCombinedDSGVector_, true);
+  offset = readSparseGrids(fh, offset, reducedPrecisionResidualDSGVector_, true);
+  offset = readSparseGrids(fh, offset, previousCombinedDSGVector_, true);
+
+  MPI_File_close(&fh);
+
+  Stats::stopEvent("read checkpoint");
+}
+
+/**
+ * A section of sparse grids starts with the number of grids and the number of processes
+ * of the group. For each grid follows a table with the size of the part of each process
+ * and the parts themselves, which consist of the sizes of the subspaces and their data.
+ */
+MPI_Offset ProcessGroupWorker::writeSparseGrids(
+    MPI_File fh, MPI_Offset offset,
+    const std::vector<std::unique_ptr<DistributedSparseGridUniform<CombiDataType>>>& dsgs) {
+  CommunicatorType lcomm = theMPISystem()->getLocalComm();
+  int size = getCommSize(lcomm);
+  int rank = getCommRank(lcomm);
+
+  uint64_t header[2] = {dsgs.size(), uint64_t(size)};
+
+  MASTER_EXCLUSIVE_SECTION {
+    MPI_File_write_at(fh, offset, header, int(sizeof(header)), MPI_BYTE, MPI_STATUS_IGNORE);
+  }
+
+  offset += sizeof(header);
+
+  for (const auto& dsg : dsgs) {
+    uint64_t numSubspaces = dsg->getNumSubspaces();
+    std::vector<uint64_t> subspaceSizes(numSubspaces);
+
+    for (size_t i = 0; i < numSubspaces; ++i) subspaceSizes[i] = dsg->getDataVector(i).size();
+
+    uint64_t dataSize = std::accumulate(subspaceSizes.begin(), subspaceSizes.end(), uint64_t(0));
+
+    std::vector<char> block(sizeof(uint64_t) * (numSubspaces + 1) +
+                            sizeof(CombiDataType) * dataSize);
+    char* it = block.data();
+
+    std::memcpy(it, &numSubspaces, sizeof(uint64_t));
+    it += sizeof(uint64_t);
+    std::memcpy(it, subspaceSizes.data(), sizeof(uint64_t) * numSubspaces);
+    it += sizeof(uint64_t) * numSubspaces;
+
+    for (size_t i = 0; i < numSubspaces; ++i) {
+      const std::vector<CombiDataType>& data = dsg->getDataVector(i);
+      std::memcpy(it, data.data(), sizeof(CombiDataType) * data.size());
+      it += sizeof(CombiDataType) * data.size();
+    }
+
+    uint64_t blockSize = block.size();
+    std::vector<uint64_t> blockSizes(size);
+    MPI_Allgather(&blockSize, 1, MPI_UINT64_T, blockSizes.data(), 1, MPI_UINT64_T, lcomm);
+
+    MASTER_EXCLUSIVE_SECTION {
+      MPI_File_write_at(fh, offset, blockSizes.data(), int(sizeof(uint64_t) * size), MPI_BYTE,
+                        MPI_STATUS_IGNORE);
+    }
+
+    offset += sizeof(uint64_t) * size;
+
+    MPI_Offset blockOffset =
+        offset + std::accumulate(blockSizes.begin(), blockSizes.begin() + rank, uint64_t(0));
+
+    MPI_Datatype writeType;
+    int writeCount = MPILargeCount::createLargeType(block.size(), MPI_BYTE, &writeType);
+    MPI_File_write_at_all(fh, blockOffset, block.data(), writeCount, writeType,
+                          MPI_STATUS_IGNORE);
+    MPILargeCount::freeLargeType(&writeType, MPI_BYTE);
+
+    offset += std::accumulate(blockSizes.begin(), blockSizes.end(), uint64_t(0));
+  }
+
+  return offset;
+}
+
+MPI_Offset ProcessGroupWorker::readSparseGrids(
+    MPI_File fh, MPI_Offset offset,
+    std::vector<std::unique_ptr<DistributedSparseGridUniform<CombiDataType>>>& dsgs,
+    bool persistent) {
+  CommunicatorType lcomm = theMPISystem()->getLocalComm();
+  int size = getCommSize(lcomm);
+  int rank = getCommRank(lcomm);
+
+  uint64_t header[2];
+  MPI_File_read_at(fh, offset, header, int(sizeof(header)), MPI_BYTE, MPI_STATUS_IGNORE);
+  offset += sizeof(header);
+
+  // not created before the checkpoint
+  if (header[0] == 0) {
+    dsgs.clear();
+    return offset;
+  }
+
+  if (header[0] != uint64_t(combiParameters_.getNumGrids()) || header[1] != uint64_t(size)) {
+    std::cout << "the checkpoint contains " << header[0] << " sparse grids of a group of "
+              << header[1] << " processes instead of " << combiParameters_.getNumGrids()
+              << " of a group of " << size << " processes! Aborting! \n";
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+
+  if (persistent)
+    createPersistentSG(dsgs);
+  else
+    createUniformSG(dsgs);
+
+  for (const auto& dsg : dsgs) {
+    std::vector<uint64_t> blockSizes(size);
+    MPI_File_read_at(fh, offset, blockSizes.data(), int(sizeof(uint64_t) * size), MPI_BYTE,
+                     MPI_STATUS_IGNORE);
+    offset += sizeof(uint64_t) * size;
+
+    MPI_Offset blockOffset =
+        offset + std::accumulate(blockSizes.begin(), blockSizes.begin() + rank, uint64_t(0));
+
+    std::vector<char> block(blockSizes[rank]);
+
+    MPI_Datatype readType;
+    int readCount = MPILargeCount::createLargeType(block.size(), MPI_BYTE, &readType);
+    MPI_File_read_at_all(fh, blockOffset, block.data(), readCount, readType, MPI_STATUS_IGNORE);
+    MPILargeCount::freeLargeType(&readType, MPI_BYTE);
+
+    const char* it = block.data();
+    uint64_t numSubspaces;
+    std::memcpy(&numSubspaces, it, sizeof(uint64_t));
+    it += sizeof(uint64_t);
+
+    // the sparse grid is given by the combination scheme of the parameters
+    if (numSubspaces != dsg->getNumSubspaces()) {
+      std::cout << "the checkpoint contains a sparse grid with " << numSubspaces
+                << " subspaces instead of " << dsg->getNumSubspaces() << "! Aborting! \n";
+      MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    std::vector<uint64_t> subspaceSizes(numSubspaces);
+    std::memcpy(subspaceSizes.data(), it, sizeof(uint64_t) * numSubspaces);
+    it += sizeof(uint64_t) * numSubspaces;
+
+    for (size_t i = 0; i < numSubspaces; ++i) {
+      std::vector<CombiDataType>& data = dsg->getDataVector(i);
+      data.resize(subspaceSizes[i]);
+      std::memcpy(data.data(), it, sizeof(CombiDataType) * data.size());
+      it += sizeof(CombiDataType) * data.size();
+    }
+
+    offset += std::accumulate(blockSizes.begin(), blockSizes.end(), uint64_t(0));
+  }
+
+  return offset;
+}
+
 // todo: this is just a temporary function which will drop out some day
 // also this function requires a modified fgreduce method which uses allreduce
 // instead reduce in manger
@@ -728,11 +2093,128 @@ void ProcessGroupWorker::updateCombiParameters() {
   combiParameters_ = tmp;
 
   combiParametersSet_ = true;
+
+  initSubgroups();
+}
+
+/**
+ * Task migration between two groups. The task object (with the state of the worker) is sent
+ * from master to master, the component grids are sent by each process to the process with the
+ * same local rank in the other group. Both use the migration communicator, which (unlike the
+ * global reduce communicator) also connects the ranks >= getNumProcs() of larger groups. As
+ * the task determines the decomposition of its grids, the local parts are the same on both
+ * sides.
+ */
+void ProcessGroupWorker::migrateTaskSend() {
+  // the correction of a pending asynchronous combination refers to the tasks of this group,
+  // so it is applied before the task leaves
+  finishCombineUniformAsync();
+
+  // receive task id and destination group
+  int info[2];
+  MASTER_EXCLUSIVE_SECTION {
+    MPI_Recv(info, 2, MPI_INT, theMPISystem()->getManagerRank(), 0,
+             theMPISystem()->getGlobalComm(), MPI_STATUS_IGNORE);
+  }
+  MPI_Bcast(info, 2, MPI_INT, theMPISystem()->getMasterRank(), theMPISystem()->getLocalComm());
+
+  TaskContainer::iterator it = std::find_if(
+      tasks_.begin(), tasks_.end(), [&info](const Task* t) { return t->getID() == info[0]; });
+  assert(it != tasks_.end());
+
+  Task* t = *it;
+  RankType dst = theMPISystem()->getMigrationRank(size_t(info[1]));
+
+  // the grids are sent process by process, which requires them on the whole group
+  assert(!isSubgroupTask(*t) && "small tasks on subgroups can not be migrated");
+  MPI_Comm comm = theMPISystem()->getMigrationComm();
+
+  MASTER_EXCLUSIVE_SECTION { Task::send(&t, dst, comm); }
+
+  for (int g = 0; g < combiParameters_.getNumGrids(); g++) {
+    DistributedFullGrid<CombiDataType>& dfg = t->getDistributedFullGrid(g);
+
+    // the receiving process checks that its part of the grid covers the same points
+    IndexVector box(dfg.getLowerBounds());
+    box.insert(box.end(), dfg.getUpperBounds().begin(), dfg.getUpperBounds().end());
+    MPI_Send(box.data(), static_cast<int>(box.size()), MPI_INT64_T, dst, migrationTag, comm);
+
+    MPI_Datatype dtype;
+    int count = MPILargeCount::createLargeType(dfg.getNrLocalElements(), dfg.getMPIDatatype(),
+                                               &dtype);
+    MPI_Send(dfg.getData(), count, dtype, dst, migrationTag, comm);
+    MPILargeCount::freeLargeType(&dtype, dfg.getMPIDatatype());
+  }
+
+  tasks_.erase(it);
+  delete t;
+}
+
+void ProcessGroupWorker::migrateTaskReceive() {
+  // the migrated task is not part of a pending asynchronous combination of this group
+  finishCombineUniformAsync();
+
+  // receive source group
+  int srcGroup;
+  MASTER_EXCLUSIVE_SECTION {
+    MPI_Recv(&srcGroup, 1, MPI_INT, theMPISystem()->getManagerRank(), 0,
+             theMPISystem()->getGlobalComm(), MPI_STATUS_IGNORE);
+  }
+  MPI_Bcast(&srcGroup, 1, MPI_INT, theMPISystem()->getMasterRank(),
+            theMPISystem()->getLocalComm());
+
+  RankType src = theMPISystem()->getMigrationRank(size_t(srcGroup));
+  MPI_Comm comm = theMPISystem()->getMigrationComm();
+
+  Task* t;
+  MASTER_EXCLUSIVE_SECTION { Task::receive(&t, src, comm); }
+  Task::broadcast(&t, theMPISystem()->getMasterRank(), theMPISystem()->getLocalComm());
+
+  tasks_.push_back(t);
+
+  // the task keeps the state it had in the sending group, which init might reset
+  bool finished = t->isFinished();
+
+  Stats::startEvent("task init in worker");
+  t->init(theMPISystem()->getLocalComm());
+  t_fault_ = t->initFaults(t_fault_, startTimeIteration_);
+  Stats::stopEvent("task init in worker");
+
+  t->setFinished(finished);
+
+  for (int g = 0; g < combiParameters_.getNumGrids(); g++) {
+    DistributedFullGrid<CombiDataType>& dfg = t->getDistributedFullGrid(g);
+
+    // the grid data is copied as is, which requires the decomposition of the sender
+    DimType dim = dfg.getDimension();
+    IndexVector box(2 * dim);
+    MPI_Recv(box.data(), static_cast<int>(box.size()), MPI_INT64_T, src, migrationTag, comm,
+             MPI_STATUS_IGNORE);
+
+    if (!std::equal(box.begin(), box.begin() + dim, dfg.getLowerBounds().begin()) ||
+        !std::equal(box.begin() + dim, box.end(), dfg.getUpperBounds().begin())) {
+      std::cout << "task " << t->getID() << " has a different decomposition in group "
+                << srcGroup << ", it can not be migrated! Aborting! \n";
+      MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    MPI_Datatype dtype;
+    int count = MPILargeCount::createLargeType(dfg.getNrLocalElements(), dfg.getMPIDatatype(),
+                                               &dtype);
+    MPI_Recv(dfg.getData(), count, dtype, src, migrationTag, comm, MPI_STATUS_IGNORE);
+    MPILargeCount::freeLargeType(&dtype, dfg.getMPIDatatype());
+  }
 }
 
 void ProcessGroupWorker::setCombinedSolutionUniform(Task* t) {
+  // a pending asynchronous combination holds the latest combined solution
+  finishCombineUniformAsync();
+
   assert(combinedUniDSGVector_.size() != 0);
   assert(combiParametersSet_);
+  // the task may need subspaces which no task of this group contained in the combination
+  checkCombinedUniDSGComplete("setting the combined solution of task " +
+                              std::to_string(t->getID()));
 
   int numGrids = combiParameters_
                      .getNumGrids();  // we assume here that every task has the same number of grids
@@ -740,15 +2222,12 @@ void ProcessGroupWorker::setCombinedSolutionUniform(Task* t) {
   for (int g = 0; g < numGrids; g++) {
     assert(combinedUniDSGVector_[g] != NULL);
 
-    // get handle to dfg
-    DistributedFullGrid<CombiDataType>& dfg = t->getDistributedFullGrid(g);
-
     // extract dfg vom dsg
-    dfg.extractFromUniformSG(*combinedUniDSGVector_[g]);
+    extractFromUniformSG(t, g, *combinedUniDSGVector_[g]);
 
     // dehierarchize dfg
     DistributedHierarchization::dehierarchize<CombiDataType>(
-        dfg, combiParameters_.getHierarchizationDims());
+        t->getDistributedFullGrid(g), combiParameters_.getHierarchizationDims());
   }
 }
 
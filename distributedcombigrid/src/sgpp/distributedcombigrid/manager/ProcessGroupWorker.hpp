@@ -2,6 +2,12 @@
 #define PROCESSGROUPWORKER_HPP_
 
 #include <chrono>
+#include <deque>
+#include <map>
+#include <string>
+#include <thread>
+#include "sgpp/distributedcombigrid/combicom/CombiCom.hpp"
+#include "sgpp/distributedcombigrid/combicom/GlobalReduceAutotuner.hpp"
 #include "sgpp/distributedcombigrid/fullgrid/FullGrid.hpp"
 #include "sgpp/distributedcombigrid/manager/CombiParameters.hpp"
 #include "sgpp/distributedcombigrid/manager/ProcessGroupSignals.hpp"
@@ -34,12 +40,22 @@ class ProcessGroupWorker {
   // todo: maybe only needed for gene?
   inline Task* getCurrentTask();
 
+  // the tasks of the group
+  inline const TaskContainer& getTaskContainer() const;
+
   // Perform combination
   void combine();
 
   // combine on sparse grid with uniform decomposition of domain
   void combineUniform();
 
+  // start a lagged combination: the global reduction runs in the background and the
+  // combined solution is applied with the next combination (or exit)
+  void combineUniformAsync();
+
+  // wait for an asynchronous combination and apply the correction to the component grids
+  void finishCombineUniformAsync();
+
   // outdated!
   void combineFG();
 
@@ -60,6 +76,12 @@ class ProcessGroupWorker {
   // initializes the component grid from the sparse grid; used to reinitialize tasks after fault
   void setCombinedSolutionUniform(Task* t);
 
+  // send a task including the data of its component grids to another group and remove it
+  void migrateTaskSend();
+
+  // receive a task including the data of its component grids from another group
+  void migrateTaskReceive();
+
  private:
   TaskContainer tasks_;  // task storage
 
@@ -74,6 +96,50 @@ class ProcessGroupWorker {
    */
   std::vector<std::unique_ptr<DistributedSparseGridUniform<CombiDataType>>> combinedUniDSGVector_;
 
+  // false if the last global reduction only filled the subspaces which are needed on
+  // this process group (reduce-scatter and RMA), the others are zero
+  bool combinedUniDSGComplete_;
+
+  /**
+   * state of the asynchronous combination: the sparse grids which are reduced in the
+   * background, the corresponding requests and the hierarchical surpluses of each
+   * task (per grid) at the time the combination was started
+   */
+  std::vector<std::unique_ptr<DistributedSparseGridUniform<CombiDataType>>> asyncUniDSGVector_;
+
+  std::vector<GlobalReduceRequest<CombiDataType>> asyncReduceRequests_;
+
+  std::map<int, std::vector<std::vector<CombiDataType>>> asyncSnapshots_;
+
+  /**
+   * state of the delta combination: the contributions of this group that were
+   * already exchanged and the accumulated combined solution (one per grid)
+   */
+  std::vector<std::unique_ptr<DistributedSparseGridUniform<CombiDataType>>> deltaSentDSGVector_;
+
+  std::vector<std::unique_ptr<DistributedSparseGridUniform<CombiDataType>>>
+      deltaCombinedDSGVector_;
+
+  // rounding errors of the reduced precision global reduction (one per grid)
+  std::vector<std::unique_ptr<DistributedSparseGridUniform<CombiDataType>>>
+      reducedPrecisionResidualDSGVector_;
+
+  // combined surpluses of the last combination for the adaptive combination (one per grid)
+  std::vector<std::unique_ptr<DistributedSparseGridUniform<CombiDataType>>>
+      previousCombinedDSGVector_;
+
+  // relative change of the combined surpluses in the last combination, negative if unknown
+  real combinationChange_;
+
+  // windows of the one-sided global reduction (one per grid), freed at exit
+  std::vector<GlobalReduceWindow<CombiDataType>> globalReduceWindows_;
+
+  // shared memory of the node-aware global reduction (one per grid), freed at exit
+  std::vector<GlobalReduceSharedWindow<CombiDataType>> globalReduceSharedWindows_;
+
+  // selects the global reduce strategy for GLOBAL_REDUCE_AUTOTUNE
+  std::unique_ptr<GlobalReduceAutotuner> globalReduceAutotuner_;
+
   bool combinedFGexists_;
 
   CombiParameters combiParameters_;
@@ -85,18 +151,210 @@ class ProcessGroupWorker {
 
   IndexType currentCombi_;  // current combination; increased after every combination
 
+  // durations which are sent to the manager without blocking. a deque keeps the
+  // addresses of the pending elements valid
+  std::deque<durationInformation> durations_;
+
+  std::vector<MPI_Request> durationRequests_;
+
+  // true while the status and the durations of the current signal are collected by the
+  // sub-managers instead of being sent to the manager directly
+  bool reportToSubmanager_;
+
+  // durations of the master which are sent with the status to the sub-manager
+  std::vector<durationInformation> pendingDurations_;
+
   std::chrono::high_resolution_clock::time_point
       startTimeIteration_;  // starting time of process computation
 
+  /**
+   * small tasks are computed on sub-communicators of the local communicator (see
+   * CombiParameters::setTaskSubgroups). subgroupTasks_ contains the index of the subgroup
+   * of each small task and the decomposition style of its grids, which is needed by all
+   * processes of the group to create the common grids for the combination
+   */
+  struct SubgroupTask {
+    int subgroup;
+    bool forwardDecomposition;
+  };
+
+  std::map<int, SubgroupTask> subgroupTasks_;
+
+  std::vector<size_t> subgroupPoints_;  // number of grid points of the tasks of each subgroup
+
+  CommunicatorType subgroupComm_;  // the subgroup of this process
+
+  int subgroup_;  // index of the subgroup of this process
+
+  /**
+   * with CombiParameters::setPrefetchTaskInit the tasks of a RUN_FIRST_BATCH are
+   * initialized one after another on prefetchThread_, each while the previous task runs.
+   * every prefetched task gets its own duplicate of the local communicator, so the
+   * collectives of the initialization never mix with those of a running task. the grids
+   * create their own communicators, so the duplicate is freed after the initialization
+   */
+  std::deque<Task*> uninitializedTasks_;
+
+  Task* prefetchTask_;  // task which is initialized by prefetchThread_
+
+  std::thread prefetchThread_;
+
+  CommunicatorType prefetchComm_;  // duplicate of the local comm used by prefetchThread_
+
   // std::ofstream betasFile_;
 
   void initializeTaskAndFaults(bool mayAlreadyExist = true);
 
+  // receive all tasks of a RUN_FIRST_BATCH in one message and initialize them
+  void initializeTasks();
+
+  // initialize tasks and add them to the tasks of the group
+  void initializeTasks(const TaskContainer& tasks);
+
+  // true if the tasks are initialized on the helper thread
+  bool isPrefetchTaskInit() const;
+
+  // start the initialization of the next uninitialized task on the helper thread
+  void prefetchTaskInit();
+
+  // wait for the initialization of t or initialize it now
+  void finishTaskInit(Task* t);
+
+  // finish the initialization of all tasks
+  void finishTaskInits();
+
+  // wait for the task on the helper thread and drop the uninitialized ones (after a fault)
+  void abortTaskInits();
+
+  // (re)create the subgroups after the combi parameters changed
+  void initSubgroups();
+
+  // small tasks are assigned to the subgroup with the fewest grid points
+  void assignSubgroup(const Task& t);
+
+  // true if t is computed on a subgroup
+  inline bool isSubgroupTask(const Task& t) const;
+
+  // communicator on which t is computed. MPI_COMM_NULL if t belongs to another subgroup
+  CommunicatorType getTaskComm(const Task& t) const;
+
+  // grid g of t on this process. nullptr if t belongs to another subgroup
+  DistributedFullGrid<CombiDataType>* getTaskGrid(Task* t, int g) const;
+
+  // run all unfinished tasks. returns false if a GENE task is not finished yet
+  bool runTasks();
+
+  // receive the parameters of a RUN_AUTONOMOUS loop and execute it. returns false if a
+  // GENE task is not finished yet
+  bool runAutonomous();
+
+  // run the unfinished small tasks concurrently on the subgroups
+  void runSubgroupTasks();
+
+  // set combinationChange_ from the reduced combinedUniDSGVector_ and keep its surpluses
+  void computeCombinationChange();
+
+  // number of runs until the next combination according to combinationChange_
+  int adaptCombinationInterval(int interval) const;
+
+  // interval limited to the range of runs per combination of the combination parameters
+  int clampCombinationInterval(int interval) const;
+
+  // gather the full grid of a small task on the master. fg has to be created on the master
+  void gatherSubgroupFullGrid(Task* t, FullGrid<CombiDataType>& fg);
+
+  // global reduction of combinedUniDSGVector_ with the configured strategy
+  void reduceUniformSG();
+
+  // global reduction of combinedUniDSGVector_ with the given strategy
+  void reduceUniformSG(GlobalReduceType reduceType);
+
+  // aborts if combinedUniDSGVector_ does not hold the full combined solution, which
+  // operation needs
+  void checkCombinedUniDSGComplete(const std::string& operation) const;
+
+  // global reduction with the strategy selected by the autotuner. as long as the
+  // class of the reduction is not tuned, the candidates are measured
+  void autotuneReduceUniformSG();
+
+  // create one sparse grid per grid of the tasks and register it in all dfgs
+  void createUniformSG(
+      std::vector<std::unique_ptr<DistributedSparseGridUniform<CombiDataType>>>& dsgs);
+
+  // create sparse grids like combinedUniDSGVector_ which are kept between the
+  // combinations. existing ones are only replaced if the layout changed, in which
+  // case true is returned
+  bool createPersistentSG(
+      std::vector<std::unique_ptr<DistributedSparseGridUniform<CombiDataType>>>& dsgs);
+
+  // true if dfg has the common parallelization of the sparse grids
+  bool hasCommonParallelization(const DistributedFullGrid<CombiDataType>& dfg) const;
+
+  // create a grid like dfg (the grid of t on this process or nullptr) with the common
+  // parallelization and register it in dsg
+  std::unique_ptr<DistributedFullGrid<CombiDataType>> createCommonGrid(
+      const Task& t, const DistributedFullGrid<CombiDataType>* dfg,
+      DistributedSparseGridUniform<CombiDataType>& dsg);
+
+  // local reduction of grid g of t into dsg, t can have any parallelization
+  void addToUniformSG(Task* t, int g, DistributedSparseGridUniform<CombiDataType>& dsg,
+                      real coeff);
+
+  // fill grid g of t with the coefficients of dsg, t can have any parallelization
+  void extractFromUniformSG(Task* t, int g, DistributedSparseGridUniform<CombiDataType>& dsg);
+
   void processDuration(const Task& t, const Stats::Event e, size_t numProcs);
+
+  // send info to dst without blocking
+  void sendDuration(const durationInformation& info, RankType dst, CommunicatorType comm);
+
+  // report info of a task of this group to the manager (only master)
+  void reportDuration(const durationInformation& info);
+
+  // send the status and the pending durations through the sub-managers (only master)
+  void reportStatusToSubmanager();
+
+  // send a signal to all groups on to the other masters of the block (only sub-manager)
+  void forwardSignalToSubmanagerGroup(SignalType signal);
+
+  // receive the prefix of a checkpoint and return the name of the file of this group
+  std::string receiveCheckpointFilename();
+
+  /* write the tasks of the group, the data of their grids and the sparse grids to
+   * filename.tmp with MPI-IO. the grids of the tasks are stored independent of their
+   * decomposition, the sparse grids in the decomposition of the group. the manager
+   * renames the file once the whole checkpoint is complete
+   */
+  void writeCheckpoint(const std::string& filename);
+
+  /* take over the tasks and the state of the group from a checkpoint. aborts if the
+   * checkpoint was written by a group of another size. pending reductions and the
+   * windows of the global reduction are released
+   */
+  void readCheckpoint(const std::string& filename);
+
+  // write the local parts of dsgs to fh, starting at offset. returns the end offset
+  MPI_Offset writeSparseGrids(
+      MPI_File fh, MPI_Offset offset,
+      const std::vector<std::unique_ptr<DistributedSparseGridUniform<CombiDataType>>>& dsgs);
+
+  /* create dsgs (persistent or uniform ones) and read them from fh, starting at offset.
+   * returns the end offset
+   */
+  MPI_Offset readSparseGrids(
+      MPI_File fh, MPI_Offset offset,
+      std::vector<std::unique_ptr<DistributedSparseGridUniform<CombiDataType>>>& dsgs,
+      bool persistent);
 };
 
 inline Task* ProcessGroupWorker::getCurrentTask() { return currentTask_; }
 
+inline const TaskContainer& ProcessGroupWorker::getTaskContainer() const { return tasks_; }
+
+inline bool ProcessGroupWorker::isSubgroupTask(const Task& t) const {
+  return subgroupTasks_.find(t.getID()) != subgroupTasks_.end();
+}
+
 inline CombiParameters& ProcessGroupWorker::getCombiParameters() {
   assert(combiParametersSet_);
 
@@ -1,6 +1,14 @@
 #include "sgpp/distributedcombigrid/manager/ProcessManager.hpp"
 #include <algorithm>
+#include <boost/serialization/map.hpp>
+#include <boost/serialization/vector.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <map>
+#include <thread>
 #include "sgpp/distributedcombigrid/combicom/CombiCom.hpp"
 #include "sgpp/distributedcombigrid/utils/Types.hpp"
 
@@ -23,12 +31,72 @@ bool ProcessManager::runfirst() {
   // sort instances in decreasing order
   sortTasks();
 
+  // the assignment is computed in advance, so it does not depend on which group
+  // happens to be idle first
+  std::vector<real> loads(tasks_.size());
+
   for (size_t i = 0; i < tasks_.size(); ++i) {
-    // wait for available process group
-    ProcessGroupManagerID g = wait();
+    loads[i] = loadModel_->eval(tasks_[i]->getLevelVector());
+  }
 
-    // assign instance to group
-    g->runfirst(tasks_[i]);
+  // the capacity of a group is its number of processes
+  std::vector<real> capacities(pgroups_.size());
+
+  for (size_t i = 0; i < pgroups_.size(); ++i) capacities[i] = real(getGroupSize(pgroups_[i]));
+
+  // a task can only be placed on groups which have enough memory for its grids, and
+  // for the temporary grid of the combination in larger groups
+  if (params_.getMemoryPerProcess() > 0) {
+    std::vector<real> minCapacities(tasks_.size());
+    std::vector<std::vector<bool>> allowedGroups(tasks_.size(),
+                                                 std::vector<bool>(pgroups_.size()));
+
+    for (size_t i = 0; i < tasks_.size(); ++i) {
+      minCapacities[i] = std::ceil(real(getMemoryRequirement(*tasks_[i])) /
+                                   real(params_.getMemoryPerProcess()));
+
+      for (size_t g = 0; g < pgroups_.size(); ++g) {
+        allowedGroups[i][g] = getCommonGridMemoryRequirement(*tasks_[i], pgroups_[g]) <=
+                              params_.getMemoryPerProcess();
+      }
+    }
+
+    scheduler_->setMinCapacities(minCapacities);
+    scheduler_->setAllowedGroups(allowedGroups);
+  }
+
+  std::vector<size_t> assignment = scheduler_->schedule(loads, capacities);
+
+  std::vector<TaskContainer> groupTasks(pgroups_.size());
+
+  for (size_t i = 0; i < tasks_.size(); ++i) groupTasks[assignment[i]].push_back(tasks_[i]);
+
+  if (!isGENE) {
+    // each group receives all its tasks in one message and acknowledges once
+    for (size_t i = 0; i < pgroups_.size(); ++i) {
+      if (groupTasks[i].empty()) continue;
+
+      bool success = pgroups_[i]->runfirst(groupTasks[i]);
+      assert(success);
+    }
+  } else {
+    // GENE expects the tasks one after another. a group receives its next task
+    // as soon as it has finished the previous one
+    std::vector<size_t> next(pgroups_.size(), 0);
+    std::vector<ProcessGroupManagerID> doneGroups;
+
+    for (size_t i = 0; i < pgroups_.size(); ++i) {
+      if (groupTasks[i].empty()) doneGroups.push_back(pgroups_[i]);
+    }
+
+    while (doneGroups.size() < pgroups_.size()) {
+      ProcessGroupManagerID g = waitAny(doneGroups);
+      size_t i = std::find(pgroups_.begin(), pgroups_.end(), g) - pgroups_.begin();
+
+      g->runfirst(groupTasks[i][next[i]++]);
+
+      if (next[i] == groupTasks[i].size()) doneGroups.push_back(g);
+    }
   }
 
   bool group_failed = waitAllFinished();
@@ -39,6 +107,38 @@ bool ProcessManager::runfirst() {
   return !group_failed;
 }
 
+size_t ProcessManager::getGroupSize(const ProcessGroupManagerID& g) const {
+  // the master rank of a group in the global comm is its index
+  return theMPISystem()->getGroupSizes()[g->getMasterRank()];
+}
+
+size_t ProcessManager::getMemoryRequirement(const Task& t) const {
+  return t.getNumPoints() * params_.getNumGrids() * sizeof(CombiDataType);
+}
+
+size_t ProcessManager::getCommonGridMemoryRequirement(const Task& t,
+                                                      const ProcessGroupManagerID& g) const {
+  size_t groupSize = getGroupSize(g);
+  bool subgroupTask = isSubgroupTask(t, g);
+
+  // in groups of the smallest size the tasks use the common parallelization
+  if (!params_.isParallelizationSet() ||
+      (groupSize == theMPISystem()->getNumProcs() && !subgroupTask))
+    return 0;
+
+  // the workers check the same requirement for the temporary grids
+  return params_.getCommonGridMemoryRequirement(t, groupSize, subgroupTask);
+}
+
+bool ProcessManager::isSubgroupTask(const Task& t, const ProcessGroupManagerID& g) const {
+  // same decision as in ProcessGroupWorker::initSubgroups and assignSubgroup
+  size_t subgroupSize = params_.getSubgroupSize();
+
+  if (subgroupSize == 0 || subgroupSize >= getGroupSize(g)) return false;
+
+  return t.getNumPoints() <= params_.getSubgroupMaxPoints();
+}
+
 void ProcessManager::receiveDurationsOfTasksFromGroupMasters(size_t numDurationsToReceive = 0){
   if (numDurationsToReceive == 0){
     numDurationsToReceive = tasks_.size();
@@ -46,14 +146,59 @@ void ProcessManager::receiveDurationsOfTasksFromGroupMasters(size_t numDurations
   for (size_t i = 0; i < numDurationsToReceive; ++i) {
     durationInformation recvbuf;
 
-    MPIUtils::receiveClass(&recvbuf, MPI_ANY_SOURCE, theMPISystem()->getGlobalComm());
-    
-    if(LearningLoadModel* llm = dynamic_cast<LearningLoadModel*>(loadModel_.get())){
-      llm->addDataPoint(recvbuf, getLevelVectorFromTaskID(tasks_, recvbuf.task_id));
-    }
+    MPIUtils::receivePOD(&recvbuf, MPI_ANY_SOURCE, durationTag, theMPISystem()->getGlobalComm());
+
+    addDuration(recvbuf);
+  }
+}
+
+void ProcessManager::addDuration(const durationInformation& info) {
+  taskDurations_[info.task_id] = info.duration;
+
+  if (LearningLoadModel* llm = dynamic_cast<LearningLoadModel*>(loadModel_.get())) {
+    llm->addDataPoint(info, getLevelVectorFromTaskID(tasks_, info.task_id));
   }
 }
 
+/* With sub-managers, the groups answer a signal which was sent to all of them in a tree:
+ * the masters gather their status and durations at their sub-manager, and the manager
+ * receives one message per sub-manager instead of one per group and task.
+ */
+bool ProcessManager::collectStatus(size_t numDurations) {
+  if (!theMPISystem()->hasSubmanagers()) {
+    bool group_failed = waitAllFinished();
+
+    if (numDurations > 0) receiveDurationsOfTasksFromGroupMasters(numDurations);
+
+    return group_failed;
+  }
+
+  CommunicatorType comm = theMPISystem()->getSubmanagerComm();
+  RankType managerRank = getCommSize(comm) - 1;
+
+  // ordered by the ranks of the masters in the global comm, which are the group indices
+  std::vector<StatusType> noStatus, status;
+  MPIUtils::gatherPODs(noStatus, status, managerRank, comm);
+
+  std::vector<durationInformation> noDurations, durations;
+  MPIUtils::gatherPODs(noDurations, durations, managerRank, comm);
+
+  assert(status.size() == pgroups_.size());
+  assert(durations.size() == numDurations);
+
+  bool group_failed = false;
+
+  for (auto p : pgroups_) {
+    p->setStatus(status[p->getMasterRank()]);
+
+    if (p->getStatus() == PROCESS_GROUP_FAIL) group_failed = true;
+  }
+
+  for (const durationInformation& info : durations) addDuration(info);
+
+  return group_failed;
+}
+
 bool ProcessManager::runnext() {
   bool group_failed = waitAllFinished();
 
@@ -71,21 +216,240 @@ bool ProcessManager::runnext() {
   return !group_failed;
 }
 
-void ProcessManager::exit() {
-  // wait until all process groups are in wait state
-  // after sending the exit signal checking the status might not be possible
-  size_t numWaiting = 0;
+/* The groups run their tasks and start the local part of the combination (hierarchization
+ * and reduction into the sparse grid) as soon as their own tasks are finished. Only the
+ * global reduction synchronizes the groups, so groups which finish early do not wait for
+ * the combine signal.
+ */
+bool ProcessManager::runnextAndCombine() {
+  /* a failed group would not take part in the global reduction the other groups are
+   * waiting in. with fault tolerance, the status is checked between runnext and combine
+   */
+  if (ENABLE_FT) {
+    if (!runnext()) return false;
+
+    return combine();
+  }
 
-  while (numWaiting != pgroups_.size()) {
-    numWaiting = 0;
+  bool group_failed = waitAllFinished();
 
-    for (size_t i = 0; i < pgroups_.size(); ++i) {
-      if (pgroups_[i]->getStatus() == PROCESS_GROUP_WAIT) ++numWaiting;
+  assert(!group_failed && "runnextAndCombine must not be called when there are failed groups");
+
+  for (size_t i = 0; i < pgroups_.size(); ++i) {
+    bool success = pgroups_[i]->runnextAndCombine();
+    assert(success);
+  }
+
+  group_failed = collectStatus(tasks_.size());
+
+  if (params_.isTaskMigration()) rebalance(params_.getTaskMigrationTolerance());
+
+  // return true if no group failed
+  return !group_failed;
+}
+
+bool ProcessManager::runAutonomous(int numCombinations, int runsPerCombination) {
+  assert(numCombinations >= 0 && runsPerCombination >= 0);
+
+  /* a failed group would leave the loop while the others wait for it in the global
+   * reduction. with fault tolerance, the manager drives the loop and checks the status
+   * of the groups after each step instead, the interval stays runsPerCombination
+   */
+  if (ENABLE_FT) {
+    if (params_.isAdaptiveCombination()) {
+      std::cout << "the adaptive combination interval is not available with fault "
+                << "tolerance! Aborting! \n";
+      MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    for (int c = 0; c < numCombinations; ++c) {
+      for (int r = 0; r < runsPerCombination; ++r) {
+        if (!runnext()) return false;
+      }
+
+      if (!combine()) return false;
+    }
+
+    return true;
+  }
+
+  bool group_failed = waitAllFinished();
+
+  assert(!group_failed && "runAutonomous must not be called when there are failed groups");
+
+  for (size_t i = 0; i < pgroups_.size(); ++i) {
+    bool success = pgroups_[i]->runAutonomous(numCombinations, runsPerCombination);
+    assert(success);
+  }
+
+  // the durations of all runs were sent during the loop
+  size_t numDurations = size_t(numCombinations) * size_t(runsPerCombination) * tasks_.size();
+
+  group_failed = collectStatus(numDurations);
+
+  if (params_.isTaskMigration()) rebalance(params_.getTaskMigrationTolerance());
+
+  // return true if no group failed
+  return !group_failed;
+}
+
+namespace {
+// same names as in ProcessGroupWorker::receiveCheckpointFilename
+std::string getGroupCheckpointFilename(const std::string& prefix, size_t group) {
+  return prefix + "_group" + std::to_string(group) + ".dcg";
+}
+
+std::string getManagerCheckpointFilename(const std::string& prefix) {
+  return prefix + "_manager.dcg";
+}
+}  // namespace
+
+bool ProcessManager::writeCheckpoint(const std::string& prefix) {
+  if (waitAllFinished()) return false;
+
+  for (size_t i = 0; i < pgroups_.size(); ++i) {
+    bool success = pgroups_[i]->writeCheckpoint(prefix);
+    assert(success);
+  }
+
+  // the manager writes its part while the groups write theirs
+  std::vector<std::vector<int>> groupTaskIDs(pgroups_.size());
+  std::vector<size_t> groupSizes(pgroups_.size());
+
+  for (size_t i = 0; i < pgroups_.size(); ++i) {
+    for (Task* t : pgroups_[i]->getTaskContainer()) groupTaskIDs[i].push_back(t->getID());
+
+    groupSizes[i] = getGroupSize(pgroups_[i]);
+  }
+
+  {
+    std::ofstream ofs(getManagerCheckpointFilename(prefix) + ".tmp", std::ios::binary);
+    MPIUtils::OArchive oa(ofs);
+    oa << params_ << tasks_ << groupTaskIDs << groupSizes << taskDurations_;
+  }
+
+  // the learning load model keeps its measurements in files
+  if (LearningLoadModel* llm = dynamic_cast<LearningLoadModel*>(loadModel_.get())) {
+    llm->writeDurationsToFiles();
+  }
+
+  // an incomplete checkpoint does not replace the previous one
+  if (waitAllFinished()) return false;
+
+  /* the file of the manager, which is read first by restart, is replaced last. the
+   * master rank of a group in the global comm is its index
+   */
+  std::vector<std::string> filenames;
+
+  for (size_t i = 0; i < pgroups_.size(); ++i)
+    filenames.push_back(getGroupCheckpointFilename(prefix, pgroups_[i]->getMasterRank()));
+
+  filenames.push_back(getManagerCheckpointFilename(prefix));
+
+  for (const std::string& filename : filenames) {
+    if (std::rename((filename + ".tmp").c_str(), filename.c_str()) != 0) {
+      std::cout << "could not replace checkpoint " << filename << std::endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool ProcessManager::restart(const std::string& prefix) {
+  std::ifstream ifs(getManagerCheckpointFilename(prefix), std::ios::binary);
+
+  if (!ifs.good()) {
+    std::cout << "could not open checkpoint " << getManagerCheckpointFilename(prefix) << std::endl;
+    return false;
+  }
+
+  CombiParameters params;
+  TaskContainer tasks;
+  std::vector<std::vector<int>> groupTaskIDs;
+  std::vector<size_t> groupSizes;
+  std::map<int, unsigned long> taskDurations;
+
+  {
+    MPIUtils::IArchive ia(ifs);
+    ia >> params >> tasks >> groupTaskIDs >> groupSizes >> taskDurations;
+  }
+
+  // nothing is changed or sent to the groups before the checkpoint is known to fit
+  bool valid = (groupTaskIDs.size() == pgroups_.size());
+
+  if (!valid) std::cout << "restart requires the groups of the checkpoint" << std::endl;
+
+  // the grids and sparse grids of a group are stored in the decomposition of its processes
+  for (size_t i = 0; i < pgroups_.size() && valid; ++i) {
+    if (groupSizes[i] != getGroupSize(pgroups_[i])) {
+      std::cout << "restart requires the group sizes of the checkpoint, group " << i << " has "
+                << getGroupSize(pgroups_[i]) << " processes instead of " << groupSizes[i]
+                << std::endl;
+      valid = false;
     }
   }
 
+  for (size_t i = 0; i < pgroups_.size() && valid; ++i) {
+    std::string filename = getGroupCheckpointFilename(prefix, pgroups_[i]->getMasterRank());
+
+    if (!std::ifstream(filename).good()) {
+      std::cout << "could not open checkpoint " << filename << std::endl;
+      valid = false;
+    }
+  }
+
+  // the tasks of the application have to be the ones of the checkpoint
+  const TaskContainer& knownTasks = tasks_.empty() ? tasks : tasks_;
+
+  for (size_t i = 0; i < groupTaskIDs.size() && valid; ++i) {
+    for (int id : groupTaskIDs[i]) {
+      if (std::none_of(knownTasks.begin(), knownTasks.end(),
+                       [id](Task* t) { return t->getID() == id; })) {
+        std::cout << "task " << id << " of the checkpoint not found" << std::endl;
+        valid = false;
+      }
+    }
+  }
+
+  if (!valid || !tasks_.empty()) {
+    for (Task* t : tasks) delete t;
+  } else {
+    tasks_ = tasks;
+  }
+
+  if (!valid) return false;
+
+  params_ = params;
+  taskDurations_ = taskDurations;
+
+  updateCombiParameters();
+
+  for (size_t i = 0; i < pgroups_.size(); ++i) {
+    TaskContainer groupTasks;
+
+    for (int id : groupTaskIDs[i]) groupTasks.push_back(getTask(id));
+
+    bool success = pgroups_[i]->restart(groupTasks, prefix);
+    assert(success);
+  }
+
+  bool group_failed = waitAllFinished();
+
+  // return true if no group failed
+  return !group_failed;
+}
+
+void ProcessManager::exit() {
+  // wait until all process groups are in wait state
+  // after sending the exit signal checking the status might not be possible.
+  // failed groups do not block here (see waitAll) and can not receive the signal anymore
+  waitAll();
+
   // send exit signal to each group
   for (size_t i = 0; i < pgroups_.size(); ++i) {
+    if (pgroups_[i]->getStatus() == PROCESS_GROUP_FAIL) continue;
+
     bool success = pgroups_[i]->exit();
     assert(success);
   }
@@ -141,15 +505,9 @@ void ProcessManager::redistribute(std::vector<int>& taskID) {
     g->addTask(t);
   }
 
-  size_t numWaiting = 0;
-
-  while (numWaiting != pgroups_.size()) {
-    numWaiting = 0;
-
-    for (size_t i = 0; i < pgroups_.size(); ++i) {
-      if (pgroups_[i]->getStatus() == PROCESS_GROUP_WAIT) ++numWaiting;
-    }
-  }
+  // a group which fails meanwhile does not block here (see waitAll), the caller
+  // finds it in FAIL state with the next waitAllFinished
+  waitAll();
 
   std::cout << "Redistribute finished" << std::endl;
 }
@@ -182,14 +540,8 @@ void ProcessManager::reInitializeGroup(std::vector<ProcessGroupManagerID>& recov
     removeTasks.clear();
   }
 
-  size_t numWaiting = 0;
-
-  while (numWaiting != pgroups_.size()) {
-    numWaiting = 0;
-    for (size_t i = 0; i < pgroups_.size(); ++i) {
-      if (pgroups_[i]->getStatus() == PROCESS_GROUP_WAIT) ++numWaiting;
-    }
-  }
+  // as in redistribute, failed groups do not block here
+  waitAll();
 
   std::cout << "Reinitialization finished" << std::endl;
 }
@@ -221,15 +573,8 @@ void ProcessManager::recompute(std::vector<int>& taskID, bool failedRecovery,
     }
   }
 
-  size_t numWaiting = 0;
-
-  while (numWaiting != pgroups_.size()) {
-    numWaiting = 0;
-
-    for (size_t i = 0; i < pgroups_.size(); ++i) {
-      if (pgroups_[i]->getStatus() == PROCESS_GROUP_WAIT) ++numWaiting;
-    }
-  }
+  // as in redistribute, failed groups do not block here
+  waitAll();
 
   std::cout << "Recompute finished" << std::endl;
 }
@@ -332,10 +677,11 @@ void ProcessManager::restoreCombischeme() {
 }
 
 bool ProcessManager::waitAllFinished() {
+  waitAll();
+
   bool group_failed = false;
   for (auto p : pgroups_) {
-    StatusType status = p->waitStatus();
-    if (status == PROCESS_GROUP_FAIL) {
+    if (p->getStatus() == PROCESS_GROUP_FAIL) {
       group_failed = true;
     }
   }
@@ -343,6 +689,223 @@ bool ProcessManager::waitAllFinished() {
   return group_failed;
 }
 
+namespace {
+// exponential backoff for the polling loops, starting at 1 microsecond up to 1 millisecond
+void sleepBackoff(int& backoff) {
+  std::this_thread::sleep_for(std::chrono::microseconds(backoff));
+  backoff = std::min(2 * backoff, 1000);
+}
+}  // namespace
+
+size_t ProcessManager::progressStatus(const std::vector<ProcessGroupManagerID>& busyGroups,
+                                      bool block) {
+  if (busyGroups.empty()) return 0;
+
+  if (ENABLE_FT) {
+    // the fault simulator only provides test and wait for single requests
+    int backoff = 1;
+
+    while (true) {
+      size_t numReceived = 0;
+
+      for (auto g : busyGroups) {
+        if (g->getStatus() != PROCESS_GROUP_BUSY) ++numReceived;
+      }
+
+      if (numReceived > 0 || !block) return numReceived;
+
+      sleepBackoff(backoff);
+    }
+  }
+
+  std::vector<MPI_Request> requests(busyGroups.size());
+
+  for (size_t i = 0; i < busyGroups.size(); ++i) requests[i] = busyGroups[i]->statusRequest_;
+
+  int outcount;
+  std::vector<int> indices(busyGroups.size());
+
+  if (block) {
+    MPI_Waitsome(int(requests.size()), requests.data(), &outcount, indices.data(),
+                 MPI_STATUSES_IGNORE);
+  } else {
+    MPI_Testsome(int(requests.size()), requests.data(), &outcount, indices.data(),
+                 MPI_STATUSES_IGNORE);
+  }
+
+  assert(outcount != MPI_UNDEFINED);
+
+  // completed requests are set to MPI_REQUEST_NULL, the received status is already
+  // stored in the group
+  for (int i = 0; i < outcount; ++i) busyGroups[indices[i]]->statusRequest_ = requests[indices[i]];
+
+  return size_t(outcount);
+}
+
+ProcessGroupManagerID ProcessManager::waitAny(
+    const std::vector<ProcessGroupManagerID>& avoidGroups, double timeout) {
+  double start = MPI_Wtime();
+  int backoff = 1;
+  std::vector<ProcessGroupManagerID> busyGroups;
+
+  while (true) {
+    busyGroups.clear();
+
+    for (auto g : pgroups_) {
+      // ignore groups in which tasks are recomputed
+      if (std::find(avoidGroups.begin(), avoidGroups.end(), g) != avoidGroups.end()) continue;
+
+      if (g->status_ == PROCESS_GROUP_WAIT) return g;
+
+      if (g->status_ == PROCESS_GROUP_BUSY) busyGroups.push_back(g);
+    }
+
+    // all candidates failed, waiting longer would not help
+    if (busyGroups.empty()) {
+      std::cout << "no process group can become idle! Aborting! \n";
+      MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    if (progressStatus(busyGroups, timeout < 0.0) > 0) continue;
+
+    if (timeout >= 0.0 && MPI_Wtime() - start >= timeout) return nullptr;
+
+    sleepBackoff(backoff);
+  }
+}
+
+bool ProcessManager::waitAll(double timeout) {
+  double start = MPI_Wtime();
+  int backoff = 1;
+  std::vector<ProcessGroupManagerID> busyGroups;
+
+  while (true) {
+    busyGroups.clear();
+
+    for (auto g : pgroups_) {
+      if (g->status_ == PROCESS_GROUP_BUSY) busyGroups.push_back(g);
+    }
+
+    if (busyGroups.empty()) return true;
+
+    if (progressStatus(busyGroups, timeout < 0.0) > 0) continue;
+
+    if (timeout >= 0.0 && MPI_Wtime() - start >= timeout) return false;
+
+    sleepBackoff(backoff);
+  }
+}
+
+void ProcessManager::migrateTask(int taskID, size_t dstGroup) {
+  assert(dstGroup < pgroups_.size());
+
+  Task* t = getTask(taskID);
+  assert(t != nullptr);
+
+  ProcessGroupManagerID dst = pgroups_[dstGroup];
+  size_t srcGroup = pgroups_.size();
+
+  for (size_t i = 0; i < pgroups_.size(); ++i) {
+    const TaskContainer& groupTasks = pgroups_[i]->getTaskContainer();
+
+    if (std::find(groupTasks.begin(), groupTasks.end(), t) != groupTasks.end()) srcGroup = i;
+  }
+
+  assert(srcGroup < pgroups_.size());
+
+  if (srcGroup == dstGroup) return;
+
+  ProcessGroupManagerID src = pgroups_[srcGroup];
+
+  // the grids are sent process by process, so both groups need the same layout. the
+  // workers check that the task is decomposed in the same way in both groups
+  if (getGroupSize(src) != getGroupSize(dst) || isSubgroupTask(*t, src)) {
+    std::cout << "task " << taskID << " can only be migrated between groups of the same "
+              << "size and not from a subgroup! Aborting! \n";
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+
+  waitAll();
+
+  src->migrateTaskSend(t, dstGroup);
+  dst->migrateTaskReceive(t, srcGroup);
+
+  waitAll();
+}
+
+/* Greedy rebalancing: in each step the task of the most loaded group whose duration is
+ * closest to half the load difference to the least loaded group is moved. This reduces the
+ * maximum of both loads as much as possible with a single migration.
+ */
+size_t ProcessManager::rebalance(real tolerance) {
+  std::vector<double> loads(pgroups_.size(), 0.0);
+
+  for (size_t i = 0; i < pgroups_.size(); ++i) {
+    for (Task* t : pgroups_[i]->getTaskContainer()) {
+      // without measurements there is no reliable information
+      if (taskDurations_.find(t->getID()) == taskDurations_.end()) return 0;
+
+      loads[i] += double(taskDurations_[t->getID()]);
+    }
+  }
+
+  // tasks can only be migrated between groups of the same size, so the groups of each
+  // size are balanced on their own
+  std::map<size_t, std::vector<size_t>> sizeClasses;
+
+  for (size_t i = 0; i < pgroups_.size(); ++i)
+    sizeClasses[getGroupSize(pgroups_[i])].push_back(i);
+
+  size_t numMigrations = 0;
+
+  for (const auto& sizeClass : sizeClasses) {
+    const std::vector<size_t>& groups = sizeClass.second;
+
+    // at most as many migrations as there are tasks
+    for (size_t step = 0; groups.size() > 1 && step < tasks_.size(); ++step) {
+      size_t maxGroup = groups[0];
+      size_t minGroup = groups[0];
+
+      for (size_t i : groups) {
+        if (loads[i] > loads[maxGroup]) maxGroup = i;
+        if (loads[i] < loads[minGroup]) minGroup = i;
+      }
+
+      double diff = loads[maxGroup] - loads[minGroup];
+
+      Task* best = nullptr;
+      double bestDuration = 0.0;
+
+      for (Task* t : pgroups_[maxGroup]->getTaskContainer()) {
+        // small tasks on subgroups can not be migrated
+        if (isSubgroupTask(*t, pgroups_[maxGroup])) continue;
+
+        double duration = double(taskDurations_[t->getID()]);
+
+        if (duration < diff &&
+            std::abs(duration - diff / 2) < std::abs(bestDuration - diff / 2)) {
+          best = t;
+          bestDuration = duration;
+        }
+      }
+
+      if (best == nullptr) break;
+
+      double newMax = std::max(loads[maxGroup] - bestDuration, loads[minGroup] + bestDuration);
+
+      if (loads[maxGroup] - newMax <= tolerance * loads[maxGroup]) break;
+
+      migrateTask(best->getID(), minGroup);
+
+      loads[maxGroup] -= bestDuration;
+      loads[minGroup] += bestDuration;
+      ++numMigrations;
+    }
+  }
+
+  return numMigrations;
+}
+
 void ProcessManager::parallelEval(const LevelVector& leval, std::string& filename, size_t groupID) {
   // actually it would be enough to wait for the group which does the eval
   {
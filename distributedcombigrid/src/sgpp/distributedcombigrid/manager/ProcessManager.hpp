@@ -1,6 +1,7 @@
 #ifndef PROCESSMANAGER_HPP_
 #define PROCESSMANAGER_HPP_
 
+#include <map>
 #include <vector>
 
 #include "sgpp/distributedcombigrid/combischeme/CombiMinMaxScheme.hpp"
@@ -10,6 +11,8 @@
 #include "sgpp/distributedcombigrid/loadmodel/LoadModel.hpp"
 #include "sgpp/distributedcombigrid/loadmodel/LearningLoadModel.hpp"
 #include "sgpp/distributedcombigrid/mpi/MPISystem.hpp"
+#include "sgpp/distributedcombigrid/scheduler/LPTScheduler.hpp"
+#include "sgpp/distributedcombigrid/scheduler/TaskScheduler.hpp"
 #include "sgpp/distributedcombigrid/task/Task.hpp"
 
 namespace combigrid {
@@ -18,7 +21,7 @@ class ProcessManager {
  public:
   ProcessManager(ProcessGroupManagerContainer& pgroups, TaskContainer& instances,
                  CombiParameters& params, std::unique_ptr<LoadModel> loadModel)
-    : pgroups_(pgroups), tasks_(instances), params_(params)
+    : pgroups_(pgroups), tasks_(instances), params_(params), scheduler_(new LPTScheduler())
     {
       loadModel_ = std::move(loadModel);
   }
@@ -29,8 +32,12 @@ class ProcessManager {
   // todo: add remove function
   inline void addTask(Task* t);
 
+  // distribute the tasks to the groups with the scheduler and run them
   bool runfirst();
 
+  // replace the scheduler used by runfirst (LPT by default)
+  inline void setScheduler(std::unique_ptr<TaskScheduler> scheduler);
+
   void exit();
 
   virtual ~ProcessManager();
@@ -40,13 +47,56 @@ class ProcessManager {
 
   bool runnext();
 
-  inline void combine();
+  /* the combinations and evaluations below need all groups. like runnext, they return
+   * false without sending a signal to any group if a group is in FAIL state, the failed
+   * groups have to be recovered (or removed) before
+   */
+  inline bool combine();
+
+  /* runnext followed by combine, without waiting for all groups in between. with
+   * ENABLE_FT, this is only a fallback: the manager waits for all groups in between (as
+   * runnext and combine do) and returns false without combining if a group failed, so
+   * the combination does not overlap with the runs
+   */
+  bool runnextAndCombine();
+
+  /* numCombinations times runsPerCombination times runnext followed by combine. the
+   * groups execute the whole loop on their own and only synchronize in the global
+   * reduction. the manager is involved again once all groups are finished.
+   * with ENABLE_FT, this is only a fallback: the manager sends the single steps (and
+   * waits for all groups after each of them) and returns false after the first step in
+   * which a group failed. the adaptive combination interval is not available then and
+   * aborts the run
+   */
+  bool runAutonomous(int numCombinations, int runsPerCombination);
+
+  // start a lagged combination which is applied with the next combination. this keeps a
+  // copy of every task grid until then, see the definition below
+  inline bool combineAsync();
+
+  /* write a checkpoint of the combination between two combinations. each group writes
+   * its tasks, the data of their grids and its sparse grids to prefix_group<i>.dcg with
+   * MPI-IO, the manager writes the combination parameters, the tasks, their assignment
+   * to the groups and the measured durations to prefix_manager.dcg. all files are
+   * written to .tmp files first, which replace the previous checkpoint once all of them
+   * are complete. returns false if a group failed, the previous checkpoint is kept then
+   */
+  bool writeCheckpoint(const std::string& prefix);
+
+  /* replaces runfirst: the groups take over their tasks and grids from the checkpoint
+   * with the given prefix. requires the number and the sizes of the groups of the
+   * checkpoint, the grids are read in the decomposition they were written in. if the
+   * application did not create tasks, the tasks of the checkpoint are used. returns false
+   * without changing the state of the manager and the groups if the checkpoint is missing
+   * or does not fit
+   */
+  bool restart(const std::string& prefix);
 
   template <typename FG_ELEMENT>
-  inline void combineFG(FullGrid<FG_ELEMENT>& fg);
+  inline bool combineFG(FullGrid<FG_ELEMENT>& fg);
 
   template <typename FG_ELEMENT>
-  inline void gridEval(FullGrid<FG_ELEMENT>& fg);
+  inline bool gridEval(FullGrid<FG_ELEMENT>& fg);
 
   /* Generates no_faults random faults from the combischeme */
   inline void createRandomFaults(std::vector<int>& faultIds, int no_faults);
@@ -82,6 +132,39 @@ class ProcessManager {
    * to the original combination technique*/
   void restoreCombischeme();
 
+  /* blocks until one of the groups which are not in avoidGroups is in WAIT state
+   * and returns it. instead of polling, the manager sleeps in MPI until a group
+   * reports its status (with ENABLE_FT the status is polled with a backoff).
+   * a non-negative timeout (in seconds) limits the waiting time, a nullptr is
+   * returned if no group became idle in time. if all groups which are not avoided
+   * have failed, no group can become idle and the run is aborted
+   */
+  ProcessGroupManagerID waitAny(
+      const std::vector<ProcessGroupManagerID>& avoidGroups = std::vector<ProcessGroupManagerID>(),
+      double timeout = -1.0);
+
+  /* blocks until no group is busy anymore (i.e. all groups are in WAIT or FAIL
+   * state). returns false if the timeout (in seconds, if non-negative) expired before.
+   * as in waitAny, the status is polled with a backoff with ENABLE_FT. a failed group
+   * does not block the call, callers which need all groups in WAIT state have to check
+   * for PROCESS_GROUP_FAIL (e.g. with waitAllFinished)
+   */
+  bool waitAll(double timeout = -1.0);
+
+  /* move the task with the given id (including its current state) to the group
+   * pgroups_[dstGroup]. has to be called between combinations. both groups need the
+   * same size and the task the same decomposition in both of them, otherwise the run is
+   * aborted. a pending asynchronous combination is applied in both groups before
+   */
+  void migrateTask(int taskID, size_t dstGroup);
+
+  /* move tasks from the group with the highest to the one with the lowest
+   * measured load as long as the maximum load decreases by more than tolerance
+   * (relative). tasks only move between groups of the same size, so this is done
+   * for the groups of each size separately. returns the number of migrated tasks
+   */
+  size_t rebalance(real tolerance);
+
  private:
   ProcessGroupManagerContainer& pgroups_;
 
@@ -91,64 +174,73 @@ class ProcessManager {
 
   std::unique_ptr<LoadModel> loadModel_;
 
-  // periodically checks status of all process groups. returns until at least
-  // one group is in WAIT state
+  std::unique_ptr<TaskScheduler> scheduler_;
+
+  // last measured duration (in usec) of each task
+  std::map<int, unsigned long> taskDurations_;
+
+  // blocks until at least one group is in WAIT state and returns it
   inline ProcessGroupManagerID wait();
   inline ProcessGroupManagerID waitAvoid(std::vector<ProcessGroupManagerID>& avoidGroups);
+  // waits for all busy groups. returns true if a group failed
   bool waitAllFinished();
 
+  /* receive the status of the given busy groups. if block is true, the call
+   * returns after at least one status has been received. returns the number
+   * of received status messages
+   */
+  size_t progressStatus(const std::vector<ProcessGroupManagerID>& busyGroups, bool block);
+
   void receiveDurationsOfTasksFromGroupMasters(size_t numDurationsToReceive);
 
+  // store the duration of a task and pass it to the load model
+  void addDuration(const durationInformation& info);
+
+  /* waits for all groups after a signal which was sent to all of them and receives
+   * numDurations task durations, through the sub-managers if there are any. returns
+   * true if a group failed
+   */
+  bool collectStatus(size_t numDurations);
+
+  // number of processes of the group
+  size_t getGroupSize(const ProcessGroupManagerID& g) const;
+
+  // memory (in bytes) of the grids of a task
+  size_t getMemoryRequirement(const Task& t) const;
+
+  /* memory (in bytes) on one of the processes which hold the sparse grids in group g
+   * while a grid of the task is added to them via a temporary grid with the common
+   * parallelization (see ProcessGroupWorker::createCommonGrid). 0 if the task does not
+   * need a temporary grid in g
+   */
+  size_t getCommonGridMemoryRequirement(const Task& t, const ProcessGroupManagerID& g) const;
+
+  // true if the task runs on a subgroup of group g, see CombiParameters::setTaskSubgroups
+  bool isSubgroupTask(const Task& t, const ProcessGroupManagerID& g) const;
+
   void sortTasks();
 };
 
 inline void ProcessManager::addTask(Task* t) { tasks_.push_back(t); }
 
-inline ProcessGroupManagerID ProcessManager::wait() {
-  while (true) {
-    for (size_t i = 0; i < pgroups_.size(); ++i) {
-      StatusType status = pgroups_[i]->getStatus();
-      //      std::cout << status << " is the status of : "<< i << "\n";
-      assert(status >= 0);  // check for invalid values
-      assert(status <= 2);
-      if (status == PROCESS_GROUP_WAIT) {
-        return pgroups_[i];
-      }
-    }
-  }
+inline void ProcessManager::setScheduler(std::unique_ptr<TaskScheduler> scheduler) {
+  assert(scheduler);
+
+  scheduler_ = std::move(scheduler);
 }
 
+inline ProcessGroupManagerID ProcessManager::wait() { return waitAny(); }
+
 inline ProcessGroupManagerID ProcessManager::waitAvoid(
     std::vector<ProcessGroupManagerID>& avoidGroups) {
-  while (true) {
-    for (size_t i = 0; i < pgroups_.size(); ++i) {
-      if (std::find(avoidGroups.begin(), avoidGroups.end(), pgroups_[i]) ==
-          avoidGroups.end()) {  // ignore tasks that are recomputed
-        StatusType status = pgroups_[i]->getStatus();
-        //      std::cout << status << " is the status of : "<< i << "\n";
-        assert(status >= 0);  // check for invalid values
-        assert(status <= 2);
-        if (status == PROCESS_GROUP_WAIT) {
-          return pgroups_[i];
-        }
-      }
-    }
-  }
+  return waitAny(avoidGroups);
 }
 
 template <typename FG_ELEMENT>
 inline FG_ELEMENT ProcessManager::eval(const std::vector<real>& coords) {
   // wait until all process groups are in wait state
   // after sending the exit signal checking the status might not be possible
-  size_t numWaiting = 0;
-
-  while (numWaiting != pgroups_.size()) {
-    numWaiting = 0;
-
-    for (size_t i = 0; i < pgroups_.size(); ++i) {
-      if (pgroups_[i]->getStatus() == PROCESS_GROUP_WAIT) ++numWaiting;
-    }
-  }
+  waitAll();
 
   FG_ELEMENT res(0);
 
@@ -164,26 +256,52 @@ inline FG_ELEMENT ProcessManager::eval(const std::vector<real>& coords) {
  * solution. The combination solution will also be available on the manager
  * process.
  */
-void ProcessManager::combine() {
+bool ProcessManager::combine() {
   // wait until all process groups are in wait state
   // after sending the exit signal checking the status might not be possible
-  size_t numWaiting = 0;
+  if (waitAllFinished()) return false;
+
+  // send signal to each group
+  for (size_t i = 0; i < pgroups_.size(); ++i) {
+    bool success = pgroups_[i]->combine();
+    assert(success);
+  }
 
-  while (numWaiting != pgroups_.size()) {
-    numWaiting = 0;
+  collectStatus(0);
 
-    for (size_t i = 0; i < pgroups_.size(); ++i) {
-      if (pgroups_[i]->getStatus() == PROCESS_GROUP_WAIT) ++numWaiting;
-    }
+  if (params_.isTaskMigration()) rebalance(params_.getTaskMigrationTolerance());
+
+  return true;
+}
+
+/* Like combine, but the global reduction is not awaited by the process groups.
+ * The groups continue with the next runnext while the combined solution is
+ * reduced in the background. It is applied (as a correction to the advanced
+ * component grids) at the beginning of the next combine or combineAsync.
+ * The background reduction is always a nonblocking allreduce, so other global
+ * reduce types, the delta combination and the reduced precision are not supported.
+ * The workers keep a copy of the hierarchized state of every task grid until the
+ * correction is applied, which doubles the memory of the component grids.
+ */
+bool ProcessManager::combineAsync() {
+  if (!params_.isAsyncCombinationSupported()) {
+    std::cout << "the asynchronous combination only supports the plain allreduce! "
+              << "Aborting! \n";
+    MPI_Abort(MPI_COMM_WORLD, 1);
   }
 
+  // wait until all process groups are in wait state
+  if (waitAllFinished()) return false;
+
   // send signal to each group
   for (size_t i = 0; i < pgroups_.size(); ++i) {
-    bool success = pgroups_[i]->combine();
+    bool success = pgroups_[i]->combineAsync();
     assert(success);
   }
 
-  waitAllFinished();
+  collectStatus(0);
+
+  return true;
 }
 
 /* This function performs the so-called recombination. First, the combination
@@ -193,18 +311,10 @@ void ProcessManager::combine() {
  * process.
  */
 template <typename FG_ELEMENT>
-void ProcessManager::combineFG(FullGrid<FG_ELEMENT>& fg) {
+bool ProcessManager::combineFG(FullGrid<FG_ELEMENT>& fg) {
   // wait until all process groups are in wait state
   // after sending the exit signal checking the status might not be possible
-  size_t numWaiting = 0;
-
-  while (numWaiting != pgroups_.size()) {
-    numWaiting = 0;
-
-    for (size_t i = 0; i < pgroups_.size(); ++i) {
-      if (pgroups_[i]->getStatus() == PROCESS_GROUP_WAIT) ++numWaiting;
-    }
-  }
+  if (waitAllFinished()) return false;
 
   // send signal to each group
   for (size_t i = 0; i < pgroups_.size(); ++i) {
@@ -213,6 +323,8 @@ void ProcessManager::combineFG(FullGrid<FG_ELEMENT>& fg) {
   }
 
   CombiCom::FGAllreduce<FG_ELEMENT>(fg, theMPISystem()->getGlobalComm());
+
+  return true;
 }
 
 /* Evaluate the combination solution with the resolution of the given full grid.
@@ -221,18 +333,10 @@ void ProcessManager::combineFG(FullGrid<FG_ELEMENT>& fg) {
  * won't be updated.
  */
 template <typename FG_ELEMENT>
-void ProcessManager::gridEval(FullGrid<FG_ELEMENT>& fg) {
+bool ProcessManager::gridEval(FullGrid<FG_ELEMENT>& fg) {
   // wait until all process groups are in wait state
   // after sending the exit signal checking the status might not be possible
-  size_t numWaiting = 0;
-
-  while (numWaiting != pgroups_.size()) {
-    numWaiting = 0;
-
-    for (size_t i = 0; i < pgroups_.size(); ++i) {
-      if (pgroups_[i]->getStatus() == PROCESS_GROUP_WAIT) ++numWaiting;
-    }
-  }
+  if (waitAllFinished()) return false;
 
   // send signal to each group
   for (size_t i = 0; i < pgroups_.size(); ++i) {
@@ -242,6 +346,8 @@ void ProcessManager::gridEval(FullGrid<FG_ELEMENT>& fg) {
 
   CombiCom::FGReduce<FG_ELEMENT>(fg, theMPISystem()->getManagerRank(),
                                  theMPISystem()->getGlobalComm());
+
+  return true;
 }
 
 CombiParameters& ProcessManager::getCombiParameters() { return params_; }
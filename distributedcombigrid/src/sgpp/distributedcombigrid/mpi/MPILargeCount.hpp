@@ -0,0 +1,269 @@
+#ifndef SRC_SGPP_COMBIGRID_MPI_MPILARGECOUNT_HPP_
+#define SRC_SGPP_COMBIGRID_MPI_MPILARGECOUNT_HPP_
+
+#include <mpi.h>
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cstring>
+#include <vector>
+
+namespace combigrid {
+
+/* MPI uses int for element counts and displacements. the following helpers
+ * allow to transfer buffers with more than INT_MAX elements, either by splitting
+ * the operation into chunks (reductions) or by describing the whole buffer with
+ * a derived contiguous datatype (point to point and MPI-IO).
+ * as long as all counts are below getMaxChunkSize() the plain MPI call is used.
+ */
+class MPILargeCount {
+ public:
+  // maximum number of elements which is passed to a single MPI call. can be
+  // lowered to test the chunked code paths with small buffers
+  static size_t& getMaxChunkSize() {
+    static size_t maxChunkSize = size_t(1) << 30;
+    return maxChunkSize;
+  }
+
+  // creates a datatype which describes count contiguous elements of type dtype and
+  // returns the count which has to be used together with the datatype. if count is
+  // small enough dtype itself is returned in largeType. a derived datatype has to
+  // be released with freeLargeType
+  static int createLargeType(size_t count, MPI_Datatype dtype, MPI_Datatype* largeType) {
+    size_t chunkSize = getMaxChunkSize();
+
+    if (count <= chunkSize) {
+      *largeType = dtype;
+      return static_cast<int>(count);
+    }
+
+    size_t numChunks = count / chunkSize;
+    size_t rest = count % chunkSize;
+    assert(numChunks <= size_t(INT_MAX));
+
+    MPI_Datatype chunkType, chunksType;
+    MPI_Type_contiguous(static_cast<int>(chunkSize), dtype, &chunkType);
+    MPI_Type_contiguous(static_cast<int>(numChunks), chunkType, &chunksType);
+    MPI_Type_free(&chunkType);
+
+    if (rest == 0) {
+      *largeType = chunksType;
+    } else {
+      // append the remaining elements after the chunks
+      int blocklengths[2] = {1, static_cast<int>(rest)};
+      MPI_Aint displacements[2] = {0, MPI_Aint(numChunks * chunkSize) * getExtent(dtype)};
+      MPI_Datatype types[2] = {chunksType, dtype};
+
+      MPI_Type_create_struct(2, blocklengths, displacements, types, largeType);
+      MPI_Type_free(&chunksType);
+    }
+
+    MPI_Type_commit(largeType);
+
+    return 1;
+  }
+
+  // release a datatype created by createLargeType
+  static void freeLargeType(MPI_Datatype* largeType, MPI_Datatype dtype) {
+    if (*largeType != dtype) MPI_Type_free(largeType);
+  }
+
+  // MPI_Allreduce for count elements. the predefined reduction operations only work
+  // on predefined datatypes, so large buffers are reduced chunk by chunk.
+  // sendbuf can be MPI_IN_PLACE
+  static void allreduce(const void* sendbuf, void* recvbuf, size_t count, MPI_Datatype dtype,
+                        MPI_Op op, MPI_Comm comm) {
+    size_t chunkSize = getMaxChunkSize();
+    MPI_Aint extent = getExtent(dtype);
+
+    size_t offset = 0;
+
+    do {
+      int chunk = static_cast<int>(std::min(chunkSize, count - offset));
+      const void* chunkSendbuf =
+          (sendbuf == MPI_IN_PLACE)
+              ? MPI_IN_PLACE
+              : static_cast<const char*>(sendbuf) + MPI_Aint(offset) * extent;
+
+      MPI_Allreduce(chunkSendbuf, static_cast<char*>(recvbuf) + MPI_Aint(offset) * extent, chunk,
+                    dtype, op, comm);
+
+      offset += chunk;
+    } while (offset < count);
+  }
+
+  // MPI_Reduce for count elements in chunks, see allreduce
+  static void reduce(const void* sendbuf, void* recvbuf, size_t count, MPI_Datatype dtype,
+                     MPI_Op op, int root, MPI_Comm comm) {
+    size_t chunkSize = getMaxChunkSize();
+    MPI_Aint extent = getExtent(dtype);
+
+    size_t offset = 0;
+
+    do {
+      int chunk = static_cast<int>(std::min(chunkSize, count - offset));
+      const void* chunkSendbuf =
+          (sendbuf == MPI_IN_PLACE)
+              ? MPI_IN_PLACE
+              : static_cast<const char*>(sendbuf) + MPI_Aint(offset) * extent;
+
+      MPI_Reduce(chunkSendbuf, static_cast<char*>(recvbuf) + MPI_Aint(offset) * extent, chunk,
+                 dtype, op, root, comm);
+
+      offset += chunk;
+    } while (offset < count);
+  }
+
+  // non-blocking in-place MPI_Allreduce for count elements. one request per chunk
+  // is appended to requests
+  static void iallreduce(void* buf, size_t count, MPI_Datatype dtype, MPI_Op op, MPI_Comm comm,
+                         std::vector<MPI_Request>& requests) {
+    size_t chunkSize = getMaxChunkSize();
+    MPI_Aint extent = getExtent(dtype);
+
+    size_t offset = 0;
+
+    do {
+      int chunk = static_cast<int>(std::min(chunkSize, count - offset));
+
+      MPI_Request request;
+      MPI_Iallreduce(MPI_IN_PLACE, static_cast<char*>(buf) + MPI_Aint(offset) * extent, chunk,
+                     dtype, op, comm, &request);
+      requests.push_back(request);
+
+      offset += chunk;
+    } while (offset < count);
+  }
+
+  // MPI_Reduce_scatter for 64 bit counts. recvCounts has to be the same on all
+  // processes. if a count is too large, the operation is split into rounds in each of
+  // which every process receives at most getMaxChunkSize() elements
+  static void reduceScatter(const void* sendbuf, void* recvbuf,
+                            const std::vector<size_t>& recvCounts, MPI_Datatype dtype, MPI_Op op,
+                            MPI_Comm comm) {
+    size_t chunkSize = getMaxChunkSize();
+    size_t maxCount = *std::max_element(recvCounts.begin(), recvCounts.end());
+
+    if (maxCount <= chunkSize) {
+      std::vector<int> counts(recvCounts.begin(), recvCounts.end());
+      MPI_Reduce_scatter(sendbuf, recvbuf, counts.data(), dtype, op, comm);
+      return;
+    }
+
+    MPI_Aint extent = getExtent(dtype);
+    int commSize = static_cast<int>(recvCounts.size());
+
+    std::vector<size_t> sendOffsets(commSize, 0);
+
+    for (int r = 1; r < commSize; ++r) sendOffsets[r] = sendOffsets[r - 1] + recvCounts[r - 1];
+
+    std::vector<int> counts(commSize);
+    std::vector<char> roundBuf;
+
+    for (size_t offset = 0; offset < maxCount; offset += chunkSize) {
+      // pack the part of each block which is reduced in this round
+      size_t roundSize = 0;
+
+      for (int r = 0; r < commSize; ++r) {
+        size_t remaining = recvCounts[r] > offset ? recvCounts[r] - offset : 0;
+        counts[r] = static_cast<int>(std::min(chunkSize, remaining));
+        roundSize += counts[r];
+      }
+
+      roundBuf.resize(roundSize * extent);
+      char* roundIt = roundBuf.data();
+
+      for (int r = 0; r < commSize; ++r) {
+        size_t bytes = size_t(counts[r]) * extent;
+        std::memcpy(roundIt,
+                    static_cast<const char*>(sendbuf) + (sendOffsets[r] + offset) * extent,
+                    bytes);
+        roundIt += bytes;
+      }
+
+      MPI_Reduce_scatter(roundBuf.data(), static_cast<char*>(recvbuf) + offset * extent,
+                         counts.data(), dtype, op, comm);
+    }
+  }
+
+  // MPI_Alltoallv for 64 bit counts and displacements (in elements). if a count or
+  // displacement is too large, the exchange is done with point to point messages
+  // which use a large datatype
+  static void alltoallv(const void* sendbuf, const std::vector<size_t>& sendCounts,
+                        const std::vector<size_t>& sendDispls, void* recvbuf,
+                        const std::vector<size_t>& recvCounts,
+                        const std::vector<size_t>& recvDispls, MPI_Datatype dtype,
+                        MPI_Comm comm) {
+    size_t chunkSize = getMaxChunkSize();
+    int commSize = static_cast<int>(sendCounts.size());
+
+    bool fitsInt = true;
+
+    for (int r = 0; r < commSize; ++r) {
+      fitsInt = fitsInt && sendCounts[r] + sendDispls[r] <= chunkSize &&
+                recvCounts[r] + recvDispls[r] <= chunkSize;
+    }
+
+    // the result of the logical and has to be the same on all processes
+    int allFitInt = fitsInt;
+    MPI_Allreduce(MPI_IN_PLACE, &allFitInt, 1, MPI_INT, MPI_LAND, comm);
+
+    if (allFitInt) {
+      std::vector<int> sc(sendCounts.begin(), sendCounts.end());
+      std::vector<int> sd(sendDispls.begin(), sendDispls.end());
+      std::vector<int> rc(recvCounts.begin(), recvCounts.end());
+      std::vector<int> rd(recvDispls.begin(), recvDispls.end());
+
+      MPI_Alltoallv(sendbuf, sc.data(), sd.data(), dtype, recvbuf, rc.data(), rd.data(), dtype,
+                    comm);
+      return;
+    }
+
+    MPI_Aint extent = getExtent(dtype);
+
+    std::vector<MPI_Request> requests;
+    std::vector<MPI_Datatype> types;
+
+    for (int r = 0; r < commSize; ++r) {
+      if (recvCounts[r] == 0) continue;
+
+      MPI_Datatype type;
+      int count = createLargeType(recvCounts[r], dtype, &type);
+
+      MPI_Request request;
+      MPI_Irecv(static_cast<char*>(recvbuf) + recvDispls[r] * extent, count, type, r, 0, comm,
+                &request);
+      requests.push_back(request);
+      types.push_back(type);
+    }
+
+    for (int r = 0; r < commSize; ++r) {
+      if (sendCounts[r] == 0) continue;
+
+      MPI_Datatype type;
+      int count = createLargeType(sendCounts[r], dtype, &type);
+
+      MPI_Request request;
+      MPI_Isend(static_cast<const char*>(sendbuf) + sendDispls[r] * extent, count, type, r, 0,
+                comm, &request);
+      requests.push_back(request);
+      types.push_back(type);
+    }
+
+    if (requests.size() > 0)
+      MPI_Waitall(static_cast<int>(requests.size()), &requests[0], MPI_STATUSES_IGNORE);
+
+    for (size_t i = 0; i < types.size(); ++i) freeLargeType(&types[i], dtype);
+  }
+
+ private:
+  static MPI_Aint getExtent(MPI_Datatype dtype) {
+    MPI_Aint lb, extent;
+    MPI_Type_get_extent(dtype, &lb, &extent);
+    return extent;
+  }
+};
+
+} /* namespace combigrid */
+
+#endif /* SRC_SGPP_COMBIGRID_MPI_MPILARGECOUNT_HPP_ */
@@ -2,6 +2,7 @@
 #include "sgpp/distributedcombigrid/manager/ProcessGroupManager.hpp"
 #include "sgpp/distributedcombigrid/utils/Stats.hpp"
 
+#include <algorithm>
 #include <iostream>
 
 namespace {
@@ -44,7 +45,13 @@ MPISystem::MPISystem()
       worldComm_(MPI_COMM_NULL),
       globalComm_(MPI_COMM_NULL),
       localComm_(MPI_COMM_NULL),
+      localReduceComm_(MPI_COMM_NULL),
       globalReduceComm_(MPI_COMM_NULL),
+      globalReduceNodeComm_(MPI_COMM_NULL),
+      globalReduceNodeLeaderComm_(MPI_COMM_NULL),
+      migrationComm_(MPI_COMM_NULL),
+      submanagerGroupComm_(MPI_COMM_NULL),
+      submanagerComm_(MPI_COMM_NULL),
       worldCommFT_(nullptr),
       globalCommFT_(nullptr),
       spareCommFT_(nullptr),
@@ -57,6 +64,7 @@ MPISystem::MPISystem()
       managerRank_(MPI_UNDEFINED),
       managerRankWorld_(MPI_UNDEFINED),
       masterRank_(MPI_UNDEFINED),
+      groupsPerSubmanager_(0),
       reusableRanks_(std::vector<RankType>(0)) {
   // check if MPI was initialized (e.g. by MPI_Init or similar)
   int mpiInitialized(0);
@@ -70,18 +78,21 @@ MPISystem::~MPISystem() {
   // todo: the fault tolerant communicator are initialized with new -> delete
 }
 
-void MPISystem::initSystemConstants(size_t ngroup, size_t nprocs, CommunicatorType worldComm = MPI_COMM_WORLD, bool reusable = false) {
+void MPISystem::initSystemConstants(const std::vector<size_t>& groupSizes, CommunicatorType worldComm = MPI_COMM_WORLD, bool reusable = false) {
   assert(reusable || !initialized_ && "MPISystem already initialized!");
   
-  ngroup_ = ngroup;
-  nprocs_ = nprocs;
+  setGroupSizes(groupSizes);
+
+  // the recovery of failed groups assumes groups of equal size
+  assert(!ENABLE_FT || *std::min_element(groupSizes.begin(), groupSizes.end()) ==
+                           *std::max_element(groupSizes.begin(), groupSizes.end()));
 
   /* init worldComm
    * the manager has highest rank here
    */
   worldComm_ = worldComm;  
   int worldSize = getCommSize(worldComm_);
-  assert(worldSize == int(ngroup_ * nprocs_ + 1));
+  assert(worldSize == groupOffsets_.back() + int(groupSizes_.back()) + 1);
 
   worldRank_ = getCommRank(worldComm_);
   managerRankWorld_ = worldSize - 1;
@@ -98,8 +109,33 @@ void MPISystem::initSystemConstants(size_t ngroup, size_t nprocs, CommunicatorTy
   // worldCommFT_->Root_Rank = worldSize - 1;
 }
 
+void MPISystem::setGroupSizes(const std::vector<size_t>& groupSizes) {
+  assert(groupSizes.size() > 0);
+
+  groupSizes_ = groupSizes;
+  ngroup_ = groupSizes_.size();
+  nprocs_ = *std::min_element(groupSizes_.begin(), groupSizes_.end());
+
+  groupOffsets_.resize(ngroup_);
+  groupOffsets_[0] = 0;
+
+  for (size_t i = 1; i < ngroup_; ++i)
+    groupOffsets_[i] = groupOffsets_[i - 1] + RankType(groupSizes_[i - 1]);
+}
+
+size_t MPISystem::getGroupOfWorldRank(RankType worldRank) const {
+  assert(worldRank < managerRankWorld_);
+
+  return std::upper_bound(groupOffsets_.begin(), groupOffsets_.end(), worldRank) -
+         groupOffsets_.begin() - 1;
+}
+
 void MPISystem::init(size_t ngroup, size_t nprocs) {
-  initSystemConstants(ngroup, nprocs);
+  init(std::vector<size_t>(ngroup, nprocs));
+}
+
+void MPISystem::init(const std::vector<size_t>& groupSizes) {
+  initSystemConstants(groupSizes);
 
   /* init localComm
    * lcomm is the local communicator of its own process group for each worker process.
@@ -107,6 +143,8 @@ void MPISystem::init(size_t ngroup, size_t nprocs) {
    */
   initLocalComm();
 
+  initLocalReduceComm();
+
   /* create global communicator which contains only the manager and the master
    * process of each process group
    * the master processes of the process groups are the processes which have
@@ -123,7 +161,7 @@ void MPISystem::init(size_t ngroup, size_t nprocs) {
 
 /*  here the local communicator has already been created by the application */
 void MPISystem::init(size_t ngroup, size_t nprocs, CommunicatorType lcomm) {
-  initSystemConstants(ngroup, nprocs);
+  initSystemConstants(std::vector<size_t>(ngroup, nprocs));
 
   storeLocalComm(lcomm);
 
@@ -145,8 +183,11 @@ void MPISystem::init(size_t ngroup, size_t nprocs, CommunicatorType lcomm) {
  * this method can be called multiple times (needed for tests)
  */
 void MPISystem::initWorldReusable(CommunicatorType wcomm, size_t ngroup, size_t nprocs) {
-  
-  initSystemConstants(ngroup, nprocs, wcomm, true);
+  initWorldReusable(wcomm, std::vector<size_t>(ngroup, nprocs));
+}
+
+void MPISystem::initWorldReusable(CommunicatorType wcomm, const std::vector<size_t>& groupSizes) {
+  initSystemConstants(groupSizes, wcomm, true);
 
   /* init localComm
    * lcomm is the local communicator of its own process group for each worker process.
@@ -154,6 +195,8 @@ void MPISystem::initWorldReusable(CommunicatorType wcomm, size_t ngroup, size_t
    */
   initLocalComm();
 
+  initLocalReduceComm();
+
   /* create global communicator which contains only the manager and the master
    * process of each process group
    * the master processes of the process groups are the processes which have
@@ -169,8 +212,15 @@ void MPISystem::initWorldReusable(CommunicatorType wcomm, size_t ngroup, size_t
 }
 
 void MPISystem::initLocalComm() {
-  int color = worldRank_ / int(nprocs_);
-  int key = worldRank_ - color * int(nprocs_);
+  // the manager forms a group of its own
+  int color = int(ngroup_);
+  int key = 0;
+
+  if (worldRank_ != managerRankWorld_) {
+    color = int(getGroupOfWorldRank(worldRank_));
+    key = worldRank_ - groupOffsets_[color];
+  }
+
   MPI_Comm_split(worldComm_, color, key, &localComm_);
 
   /* set group number in Stats. this is necessary for postprocessing */
@@ -206,6 +256,20 @@ void MPISystem::storeLocalComm(CommunicatorType lcomm_optional /*= MPI_COMM_NULL
   }
 }
 
+void MPISystem::initLocalReduceComm() {
+  if (localReduceComm_ != MPI_COMM_NULL) MPI_Comm_free(&localReduceComm_);
+
+  bool heterogeneous = (*std::max_element(groupSizes_.begin(), groupSizes_.end()) != nprocs_);
+
+  if (!heterogeneous) return;
+
+  // the manager has no local comm
+  if (localComm_ == MPI_COMM_NULL) return;
+
+  int color = (localRank_ < RankType(nprocs_)) ? 0 : MPI_UNDEFINED;
+  MPI_Comm_split(localComm_, color, localRank_, &localReduceComm_);
+}
+
 /**
 * create global communicator which contains only the manager and the master
 * process of each process group
@@ -215,12 +279,15 @@ void MPISystem::storeLocalComm(CommunicatorType lcomm_optional /*= MPI_COMM_NULL
 * process groups and the manager and the master processes to each other
 */
 void MPISystem::initGlobalComm() {
+  // the sub-managers have to be set up again for the new global comm
+  freeSubmanagerComms();
+
   MPI_Group worldGroup;
   MPI_Comm_group(worldComm_, &worldGroup);
 
   std::vector<int> ranks(ngroup_ + 1);
   for (size_t i = 0; i < ngroup_; i++) {
-    ranks[i] = int(i * nprocs_);
+    ranks[i] = groupOffsets_[i];
   }
   ranks.back() = managerRankWorld_;
 
@@ -247,13 +314,17 @@ void MPISystem::initGlobalComm() {
 }
 
 void MPISystem::initGlobalReduceCommm() {
+  if (migrationComm_ != MPI_COMM_NULL) MPI_Comm_free(&migrationComm_);
 
   if (worldRank_ != managerRankWorld_) {
     int workerID = getCommRank(worldComm_);
+    size_t group = getGroupOfWorldRank(workerID);
+    int localRank = workerID - groupOffsets_[group];
 
-    //      MPI_Comm globalReduceComm;
-    int color = workerID % int(nprocs_);
-    int key = workerID / int(nprocs_);
+    // only the first nprocs_ processes of each group take part in the global
+    // reduction. the other processes of larger groups get a communicator of their own
+    int color = (localRank < int(nprocs_)) ? localRank : int(nprocs_) + workerID;
+    int key = int(group);
     MPI_Comm_split(worldComm_, color, key, &globalReduceComm_);
 
     if (ENABLE_FT) {
@@ -262,9 +333,109 @@ void MPISystem::initGlobalReduceCommm() {
     int size = getCommSize(globalReduceComm_);
     //std::cout << "size if global reduce comm " << size << "\n";
     MPI_Barrier(globalReduceComm_);
+
+    // all processes of larger groups can exchange data with the other groups
+    MPI_Comm_split(worldComm_, localRank, key, &migrationComm_);
   } else {
     MPI_Comm_split(worldComm_, MPI_UNDEFINED, -1, &globalReduceComm_);
+    MPI_Comm_split(worldComm_, MPI_UNDEFINED, -1, &migrationComm_);
+  }
+
+  initGlobalReduceNodeComms();
+
+  // the duplicates are recreated on demand
+  for (CommunicatorType& comm : globalReduceGridComms_) {
+    if (comm != MPI_COMM_NULL) MPI_Comm_free(&comm);
+  }
+
+  globalReduceGridComms_.clear();
+}
+
+RankType MPISystem::getMigrationRank(size_t group) const {
+  checkPreconditions();
+  assert(group < ngroup_ && RankType(groupSizes_[group]) > localRank_);
+
+  RankType rank = 0;
+
+  for (size_t i = 0; i < group; ++i) {
+    if (RankType(groupSizes_[i]) > localRank_) ++rank;
+  }
+
+  return rank;
+}
+
+void MPISystem::initSubmanagers(size_t groupsPerSubmanager) {
+  checkPreconditions();
+
+  // the recovery of failed groups does not know about the sub-managers
+  if (ENABLE_FT && groupsPerSubmanager > 0) {
+    std::cout << "the sub-managers are not available with fault tolerance! Aborting! \n";
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+
+  freeSubmanagerComms();
+
+  groupsPerSubmanager_ = groupsPerSubmanager;
+
+  if (groupsPerSubmanager_ == 0) return;
+
+  // only the manager and the masters of the groups take part
+  int color = MPI_UNDEFINED;
+  int key = 0;
+
+  if (globalComm_ != MPI_COMM_NULL) {
+    key = globalRank_;
+
+    // the group index equals the rank of the master in the global comm
+    if (globalRank_ != managerRank_) color = globalRank_ / int(groupsPerSubmanager_);
   }
+
+  MPI_Comm_split(worldComm_, color, key, &submanagerGroupComm_);
+
+  color = MPI_UNDEFINED;
+
+  if (globalComm_ != MPI_COMM_NULL &&
+      (globalRank_ == managerRank_ || globalRank_ % int(groupsPerSubmanager_) == 0))
+    color = 0;
+
+  MPI_Comm_split(worldComm_, color, key, &submanagerComm_);
+}
+
+void MPISystem::freeSubmanagerComms() {
+  if (submanagerGroupComm_ != MPI_COMM_NULL) MPI_Comm_free(&submanagerGroupComm_);
+
+  if (submanagerComm_ != MPI_COMM_NULL) MPI_Comm_free(&submanagerComm_);
+
+  groupsPerSubmanager_ = 0;
+}
+
+const CommunicatorType& MPISystem::getGlobalReduceGridComm(size_t grid) {
+  checkPreconditions();
+
+  if (globalReduceComm_ == MPI_COMM_NULL) return globalReduceComm_;
+
+  while (globalReduceGridComms_.size() <= grid) {
+    CommunicatorType comm;
+    MPI_Comm_dup(globalReduceComm_, &comm);
+    globalReduceGridComms_.push_back(comm);
+  }
+
+  return globalReduceGridComms_[grid];
+}
+
+void MPISystem::initGlobalReduceNodeComms() {
+  if (globalReduceNodeComm_ != MPI_COMM_NULL) MPI_Comm_free(&globalReduceNodeComm_);
+
+  if (globalReduceNodeLeaderComm_ != MPI_COMM_NULL) MPI_Comm_free(&globalReduceNodeLeaderComm_);
+
+  if (globalReduceComm_ == MPI_COMM_NULL) return;
+
+  int reduceRank = getCommRank(globalReduceComm_);
+  MPI_Comm_split_type(globalReduceComm_, MPI_COMM_TYPE_SHARED, reduceRank, MPI_INFO_NULL,
+                      &globalReduceNodeComm_);
+
+  int color = (getCommRank(globalReduceNodeComm_) == 0) ? 0 : MPI_UNDEFINED;
+  MPI_Comm_split(globalReduceComm_, color, reduceRank, &globalReduceNodeLeaderComm_);
 }
 
 void MPISystem::createCommFT(simft::Sim_FT_MPI_Comm* commFT, CommunicatorType comm) {
@@ -640,6 +811,7 @@ bool MPISystem::recoverCommunicators(bool groupAlive,
   int worldSize = getWorldSize();
   assert((worldSize - 1) % nprocs_ == 0);
   ngroup_ = (worldSize - 1) / nprocs_;
+  setGroupSizes(std::vector<size_t>(ngroup_, nprocs_));
 
   worldRank_ = getWorldRank();
   managerRankWorld_ = worldSize - 1;
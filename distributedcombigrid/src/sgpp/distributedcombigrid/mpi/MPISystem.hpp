@@ -2,6 +2,7 @@
 #define MPISYSTEM_HPP
 
 #include <assert.h>
+#include <algorithm>
 #include <mpi.h>
 #include <ostream>
 #include <vector>
@@ -43,6 +44,12 @@ namespace combigrid {
  * this communicator contains all processes which have the same rank in
  * LocalComm. it is MPI_COMM_NULL on the manager.
  *
+ * GlobalReduceNodeComm: contains the processes of GlobalReduceComm which share a
+ * node (and thus memory). it is MPI_COMM_NULL on the manager.
+ *
+ * GlobalReduceNodeLeaderComm: contains the first process of each
+ * GlobalReduceNodeComm. it is MPI_COMM_NULL on all other processes.
+ *
  * getXXXCommFT returns the fault tolerant equivalent of Communicator XXX
  *
  * getXXXRank return the rank of the process in the Communicator XXX. If the
@@ -87,6 +94,20 @@ class MPISystem {
    */
   void initWorldReusable(CommunicatorType wcomm, size_t ngroups, size_t nprocs);
 
+  /**
+   * initializes MPI system for process groups of different sizes. groupSizes[i] is
+   * the number of processes of group i. only the first getNumProcs() processes of
+   * each group (the size of the smallest group) take part in the global reduction.
+   * not available with ENABLE_FT, the recovery of failed groups assumes that all
+   * groups have the same size
+   */
+  void init(const std::vector<size_t>& groupSizes);
+
+  /**
+   * like initWorldReusable, for process groups of different sizes
+   */
+  void initWorldReusable(CommunicatorType wcomm, const std::vector<size_t>& groupSizes);
+
   /**
   * returns the world communicator which contains all ranks (excluding spare ranks)
   */
@@ -102,6 +123,13 @@ class MPISystem {
    */
   inline const CommunicatorType& getLocalComm() const;
 
+  /**
+   * returns the part of the local communicator which takes part in the global reduction,
+   * i.e. the first getNumProcs() ranks of the process group. this is the local
+   * communicator if all groups have the same size. the other ranks get MPI_COMM_NULL
+   */
+  inline const CommunicatorType& getLocalReduceComm() const;
+
   /**
    * returns the global reduce communicator which contains all ranks with wich the rank needs to
    * communicate in global allreduce step
@@ -109,6 +137,74 @@ class MPISystem {
    */
   inline const CommunicatorType& getGlobalReduceComm() const;
 
+  /**
+   * returns a duplicate of the global reduce communicator for the grid with the given
+   * index. this allows to reduce several grids concurrently without the collectives
+   * being ordered with respect to each other. the communicator is created the first
+   * time it is requested, so the first call is collective over the global reduce comm
+   */
+  const CommunicatorType& getGlobalReduceGridComm(size_t grid);
+
+  /**
+   * returns the part of the global reduce communicator which is located on the same node
+   */
+  inline const CommunicatorType& getGlobalReduceNodeComm() const;
+
+  /**
+   * returns the communicator of the node leaders of the global reduce communicator
+   * (MPI_COMM_NULL if caller is not a node leader)
+   */
+  inline const CommunicatorType& getGlobalReduceNodeLeaderComm() const;
+
+  /**
+   * returns the communicator of the worker processes with the same local rank in all
+   * process groups, ordered by group. unlike the global reduce communicator it also
+   * contains the ranks >= getNumProcs() of larger groups (MPI_COMM_NULL for the manager)
+   */
+  inline const CommunicatorType& getMigrationComm() const;
+
+  /**
+   * returns the rank of the process of the given group in the migration communicator of
+   * the caller. groups which are too small for the local rank of the caller are not part
+   * of it
+   */
+  RankType getMigrationRank(size_t group) const;
+
+  /**
+   * sets up a two-level tree for the operations on all process groups. the manager sends
+   * the signal only to the first of groupsPerSubmanager consecutive groups (the
+   * sub-manager), which forwards it to the other masters of its block. the masters report
+   * their status and durations to the sub-manager, which forwards the reports of its block
+   * to the manager in one message. 0 disables the tree.
+   * has to be called by all processes of the world comm after init. not available
+   * with ENABLE_FT (the run is aborted), the recovery of failed groups does not know about
+   * the sub-managers and would remove groups from the blocks
+   */
+  void initSubmanagers(size_t groupsPerSubmanager);
+
+  /**
+   * returns the communicator of the masters which report to the same sub-manager
+   * (MPI_COMM_NULL if caller is not a master or no sub-managers are used)
+   */
+  inline const CommunicatorType& getSubmanagerGroupComm() const;
+
+  /**
+   * returns the communicator of the sub-managers and the manager, the manager has the
+   * highest rank (MPI_COMM_NULL if caller is neither)
+   */
+  inline const CommunicatorType& getSubmanagerComm() const;
+
+  /**
+   * returns boolean that indicates if the reports are collected by sub-managers
+   */
+  inline bool hasSubmanagers() const;
+
+  /**
+   * returns boolean that indicates if the master with the given rank in the global comm
+   * is a sub-manager
+   */
+  inline bool isSubmanager(RankType globalRank) const;
+
   /**
    * returns the fault tolerant version of the world comm (excluding spare ranks)
    */
@@ -187,10 +283,21 @@ class MPISystem {
   inline size_t getNumGroups() const;
 
   /**
-   * returns the number of processors per process group
+   * returns the number of processors per process group (the size of the smallest
+   * group if the groups have different sizes)
    */
   inline size_t getNumProcs() const;
 
+  /**
+   * returns the number of processors of each process group
+   */
+  inline const std::vector<size_t>& getGroupSizes() const;
+
+  /**
+   * returns boolean that indicates if the process groups have different sizes
+   */
+  inline bool isHeterogeneous() const;
+
   /**
    * returns boolean that indicates if MPISystem is initialized
    */
@@ -253,21 +360,44 @@ class MPISystem {
    */
   void initGlobalReduceCommm();
 
+  /* split the global reduce communicator into the processes on the same node
+   * and create a communicator which contains one leader per node
+   */
+  void initGlobalReduceNodeComms();
+
   /**
    * creates a FT communicator associated with comm
    */
   void createCommFT(simft::Sim_FT_MPI_Comm* commFT, CommunicatorType comm);
 
   /**
-   * initializes the members ngroup_, nprocs_, worldComm_,  managerRankWorld_, managerRankFT_
+   * initializes the members ngroup_, nprocs_, groupSizes_, worldComm_,  managerRankWorld_,
+   * managerRankFT_
    */
-  void initSystemConstants(size_t ngroup, size_t nprocs, CommunicatorType comm, bool reusable);
+  void initSystemConstants(const std::vector<size_t>& groupSizes, CommunicatorType comm,
+                           bool reusable);
+
+  /**
+   * sets ngroup_, nprocs_, groupSizes_ and groupOffsets_
+   */
+  void setGroupSizes(const std::vector<size_t>& groupSizes);
+
+  /**
+   * returns the process group of a worker rank in world comm
+   */
+  size_t getGroupOfWorldRank(RankType worldRank) const;
 
   /**
    * sets up the local comm by splitting from worldComm and stores it
    */
   void initLocalComm();
 
+  /**
+   * sets up the local reduce comm by splitting from localComm if the groups have
+   * different sizes
+   */
+  void initLocalReduceComm();
+
   /**
    * stores local comm + FT version if FT_ENABLED
    */
@@ -283,6 +413,11 @@ class MPISystem {
    */
   void initGlobalComm();
 
+  /**
+   * frees the sub-manager comms and disables the sub-managers
+   */
+  void freeSubmanagerComms();
+
   /**
    * Send signal to manager that this rank is reusable -> becomes spare process
    * The message is send in world comm
@@ -356,12 +491,33 @@ class MPISystem {
 
   CommunicatorType localComm_;  // contains all processes in process group
 
+  // first nprocs_ processes of localComm_ if the groups have different sizes
+  CommunicatorType localReduceComm_;
+
   /**
    * contains all processes that share same domain in other process groups
    * -> only communicate with these ranks during allreduce
    */
   CommunicatorType globalReduceComm_;
 
+  // duplicates of globalReduceComm_, one for each grid
+  std::vector<CommunicatorType> globalReduceGridComms_;
+
+  // processes of globalReduceComm_ on the same node
+  CommunicatorType globalReduceNodeComm_;
+
+  // first process of globalReduceNodeComm_ on each node
+  CommunicatorType globalReduceNodeLeaderComm_;
+
+  // processes with the same local rank in all groups
+  CommunicatorType migrationComm_;
+
+  // masters of the groups of one sub-manager
+  CommunicatorType submanagerGroupComm_;
+
+  // sub-managers and manager
+  CommunicatorType submanagerComm_;
+
   simft::Sim_FT_MPI_Comm worldCommFT_;  // FT version of world comm
 
   simft::Sim_FT_MPI_Comm globalCommFT_;  // FT version of global comm
@@ -391,7 +547,13 @@ class MPISystem {
 
   size_t ngroup_;  // number of process groups
 
-  size_t nprocs_;  // number of processes per process group
+  size_t nprocs_;  // number of processes per process group (of the smallest group)
+
+  std::vector<size_t> groupSizes_;  // number of processes of each process group
+
+  std::vector<RankType> groupOffsets_;  // rank in world comm of the first process of each group
+
+  size_t groupsPerSubmanager_;  // number of groups reporting to one sub-manager (0 if none)
 
   // ranks that er still functional but not assigned to any process group
   std::vector<RankType> reusableRanks_;
@@ -445,12 +607,60 @@ inline const CommunicatorType& MPISystem::getLocalComm() const {
   return localComm_;
 }
 
+inline const CommunicatorType& MPISystem::getLocalReduceComm() const {
+  checkPreconditions();
+
+  return isHeterogeneous() ? localReduceComm_ : localComm_;
+}
+
 inline const CommunicatorType& MPISystem::getGlobalReduceComm() const {
   checkPreconditions();
 
   return globalReduceComm_;
 }
 
+inline const CommunicatorType& MPISystem::getGlobalReduceNodeComm() const {
+  checkPreconditions();
+
+  return globalReduceNodeComm_;
+}
+
+inline const CommunicatorType& MPISystem::getGlobalReduceNodeLeaderComm() const {
+  checkPreconditions();
+
+  return globalReduceNodeLeaderComm_;
+}
+
+inline const CommunicatorType& MPISystem::getMigrationComm() const {
+  checkPreconditions();
+
+  return migrationComm_;
+}
+
+inline const CommunicatorType& MPISystem::getSubmanagerGroupComm() const {
+  checkPreconditions();
+
+  return submanagerGroupComm_;
+}
+
+inline const CommunicatorType& MPISystem::getSubmanagerComm() const {
+  checkPreconditions();
+
+  return submanagerComm_;
+}
+
+inline bool MPISystem::hasSubmanagers() const {
+  checkPreconditions();
+
+  return groupsPerSubmanager_ > 0;
+}
+
+inline bool MPISystem::isSubmanager(RankType globalRank) const {
+  checkPreconditions();
+
+  return hasSubmanagers() && globalRank % RankType(groupsPerSubmanager_) == 0;
+}
+
 inline simft::Sim_FT_MPI_Comm MPISystem::getWorldCommFT() {
   checkPreconditionsFT();
 
@@ -535,6 +745,19 @@ inline size_t MPISystem::getNumProcs() const {
   return nprocs_;
 }
 
+inline const std::vector<size_t>& MPISystem::getGroupSizes() const {
+  checkPreconditions();
+
+  return groupSizes_;
+}
+
+inline bool MPISystem::isHeterogeneous() const {
+  checkPreconditions();
+
+  return std::any_of(groupSizes_.begin(), groupSizes_.end(),
+                     [this](size_t size) { return size != nprocs_; });
+}
+
 inline bool MPISystem::isInitialized() const { return initialized_; }
 
 /*
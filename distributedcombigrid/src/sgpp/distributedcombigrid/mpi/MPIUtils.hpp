@@ -2,103 +2,176 @@
 #define SRC_SGPP_COMBIGRID_MPI_MPIUTILS_HPP_
 
 #include <mpi.h>
-#include <boost/archive/text_iarchive.hpp>
-#include <boost/archive/text_oarchive.hpp>
-#include <sstream>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <cassert>
 #include <string>
+#include <type_traits>
+#include <vector>
+
+#include "sgpp/distributedcombigrid/utils/Types.hpp"
 
 namespace combigrid {
 
+/* transfer of classes which support boost serialization.
+ *
+ * classes are written to binary archives, which are much smaller and faster to
+ * create than text archives, but require the same data representation on all
+ * processes. the archives are written directly into a char buffer. the variants
+ * which take a buffer argument reuse its capacity, so repeated transfers of the
+ * same type do not allocate.
+ *
+ * trivially copyable types (e.g. durationInformation) do not need serialization
+ * at all and can be transferred with sendPOD/isendPOD/receivePOD.
+ */
 class MPIUtils {
  public:
+  typedef boost::archive::binary_oarchive OArchive;
+  typedef boost::archive::binary_iarchive IArchive;
+
+  // write t to buf. the previous content of buf is discarded
   template <typename T>
-  static void sendClass(T* t, RankType dst, CommunicatorType comm) {
-    // save data to archive
-    std::stringstream ss;
+  static void serialize(T* t, std::vector<char>& buf) {
+    buf.clear();
     {
-      boost::archive::text_oarchive oa(ss);
+      boost::iostreams::back_insert_device<std::vector<char> > device(buf);
+      boost::iostreams::stream<boost::iostreams::back_insert_device<std::vector<char> > > os(
+          device);
+      OArchive oa(os);
       // write class instance to archive
       oa << *t;
     }
-    // create mpi buffer of archive
-    std::string s = ss.str();
-    int bsize = static_cast<int>(s.size());
-    char* buf = const_cast<char*>(s.c_str());
-    MPI_Send(buf, bsize, MPI_CHAR, dst, 0, comm);
+  }
+
+  // read t from the first size bytes of buf
+  template <typename T>
+  static void deserialize(T* t, const char* buf, size_t size) {
+    boost::iostreams::stream<boost::iostreams::array_source> is(buf, size);
+    IArchive ia(is);
+    // read class state from archive
+    ia >> *t;
+  }
+
+  template <typename T>
+  static void sendClass(T* t, RankType dst, CommunicatorType comm) {
+    std::vector<char> buf;
+    sendClass(t, dst, comm, buf);
+  }
+
+  template <typename T>
+  static void sendClass(T* t, RankType dst, CommunicatorType comm, std::vector<char>& buf) {
+    serialize(t, buf);
+    MPI_Send(buf.data(), static_cast<int>(buf.size()), MPI_CHAR, dst, 0, comm);
+  }
+
+  // non-blocking send. buf must not be modified or destroyed until request has
+  // completed
+  template <typename T>
+  static void isendClass(T* t, RankType dst, CommunicatorType comm, std::vector<char>& buf,
+                         MPI_Request* request) {
+    serialize(t, buf);
+    MPI_Isend(buf.data(), static_cast<int>(buf.size()), MPI_CHAR, dst, 0, comm, request);
   }
 
   template <typename T>
   static void receiveClass(T* t, RankType src, CommunicatorType comm) {
-    // receive size of message
-    // todo: not really necessary since size known at compile time
+    std::vector<char> buf;
+    receiveClass(t, src, comm, buf);
+  }
+
+  template <typename T>
+  static void receiveClass(T* t, RankType src, CommunicatorType comm, std::vector<char>& buf) {
+    // the matched probe removes the message from the queue, so it can not be
+    // received by another call in between (important if src is MPI_ANY_SOURCE)
+    MPI_Message message;
     MPI_Status status;
     int bsize;
-    MPI_Probe(src, 0, comm, &status);
+    MPI_Mprobe(src, 0, comm, &message, &status);
     MPI_Get_count(&status, MPI_CHAR, &bsize);
 
-    // create buffer of appropriate size and receive
-    std::vector<char> buf(bsize);
-    MPI_Recv(&buf[0], bsize, MPI_CHAR, src, 0, comm, MPI_STATUS_IGNORE);
+    buf.resize(bsize);
+    MPI_Mrecv(buf.data(), bsize, MPI_CHAR, &message, MPI_STATUS_IGNORE);
 
-    // create and open an archive for input
-    std::string s(&buf[0], bsize);
-    std::stringstream ss(s);
-    {
-      boost::archive::text_iarchive ia(ss);
-      // read class state from archive
-      ia >> *t;
-    }
+    deserialize(t, buf.data(), bsize);
   }
 
   template <typename T>
   static void broadcastClass(T* t, RankType root, CommunicatorType comm) {
+    std::vector<char> buf;
+    broadcastClass(t, root, comm, buf);
+  }
+
+  template <typename T>
+  static void broadcastClass(T* t, RankType root, CommunicatorType comm,
+                             std::vector<char>& buf) {
     RankType myID;
     MPI_Comm_rank(comm, &myID);
 
-    char* buf = NULL;
-    int bsize;
-
     // root writes object data into buffer
-    std::string s;
-
-    if (myID == root) {
-      // save data to archive
-      std::stringstream ss;
-      {
-        boost::archive::text_oarchive oa(ss);
-        // write class instance to archive
-        oa << *t;
-      }
-      // create mpi buffer of archive
-      s = ss.str();
-      bsize = static_cast<int>(s.size());
-      buf = const_cast<char*>(s.c_str());
-    }
+    if (myID == root) serialize(t, buf);
 
     // root broadcasts object size
+    int bsize = static_cast<int>(buf.size());
     MPI_Bcast(&bsize, 1, MPI_INT, root, comm);
 
     // non-root procs create buffer which is large enough
-    std::vector<char> tmp(bsize);
-
-    if (myID != root) {
-      buf = &tmp[0];
-    }
+    if (myID != root) buf.resize(bsize);
 
     // broadcast of buffer
-    MPI_Bcast(buf, bsize, MPI_CHAR, root, comm);
+    MPI_Bcast(buf.data(), bsize, MPI_CHAR, root, comm);
 
     // non-root procs write buffer to object
-    if (myID != root) {
-      // create and open an archive for input
-      std::string s(buf, bsize);
-      std::stringstream ss(s);
-      {
-        boost::archive::text_iarchive ia(ss);
-        // read class state from archive
-        ia >> *t;
-      }
-    }
+    if (myID != root) deserialize(t, buf.data(), bsize);
+  }
+
+  template <typename T>
+  static void sendPOD(const T* t, RankType dst, int tag, CommunicatorType comm) {
+    static_assert(std::is_trivially_copyable<T>::value, "type has to be trivially copyable");
+    MPI_Send(t, static_cast<int>(sizeof(T)), MPI_BYTE, dst, tag, comm);
+  }
+
+  // non-blocking send. t must not be modified or destroyed until request has
+  // completed
+  template <typename T>
+  static void isendPOD(const T* t, RankType dst, int tag, CommunicatorType comm,
+                       MPI_Request* request) {
+    static_assert(std::is_trivially_copyable<T>::value, "type has to be trivially copyable");
+    MPI_Isend(t, static_cast<int>(sizeof(T)), MPI_BYTE, dst, tag, comm, request);
+  }
+
+  template <typename T>
+  static void receivePOD(T* t, RankType src, int tag, CommunicatorType comm) {
+    static_assert(std::is_trivially_copyable<T>::value, "type has to be trivially copyable");
+    MPI_Recv(t, static_cast<int>(sizeof(T)), MPI_BYTE, src, tag, comm, MPI_STATUS_IGNORE);
+  }
+
+  // gathers the elements of all processes in the order of their ranks. the number of
+  // elements may differ between the processes. result is only written on root
+  template <typename T>
+  static void gatherPODs(const std::vector<T>& send, std::vector<T>& result, RankType root,
+                         CommunicatorType comm) {
+    static_assert(std::is_trivially_copyable<T>::value, "type has to be trivially copyable");
+
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    int sendBytes = static_cast<int>(send.size() * sizeof(T));
+    std::vector<int> recvBytes(rank == root ? size : 0);
+    MPI_Gather(&sendBytes, 1, MPI_INT, recvBytes.data(), 1, MPI_INT, root, comm);
+
+    std::vector<int> displacements(recvBytes.size(), 0);
+
+    for (size_t i = 1; i < displacements.size(); ++i)
+      displacements[i] = displacements[i - 1] + recvBytes[i - 1];
+
+    if (rank == root) result.resize((displacements.back() + recvBytes.back()) / sizeof(T));
+
+    MPI_Gatherv(send.data(), sendBytes, MPI_BYTE, result.data(), recvBytes.data(),
+                displacements.data(), MPI_BYTE, root, comm);
   }
 };
 }
@@ -0,0 +1,114 @@
+#include "sgpp/distributedcombigrid/scheduler/ILPScheduler.hpp"
+
+#include <utility>
+
+#include "glpk.h"
+#include "sgpp/distributedcombigrid/scheduler/LocalSearchScheduler.hpp"
+
+namespace combigrid {
+
+namespace {
+
+// branch and bound callback: stop once the tree has more than maxNodes subproblems
+void terminateAfterNodes(glp_tree* tree, void* info) {
+  if (glp_ios_reason(tree) != GLP_ISELECT) return;
+
+  int numNodes = 0;
+  glp_ios_tree_size(tree, nullptr, nullptr, &numNodes);
+
+  if (static_cast<size_t>(numNodes) > *static_cast<size_t*>(info)) glp_ios_terminate(tree);
+}
+
+}  // namespace
+
+ILPScheduler::ILPScheduler(std::unique_ptr<TaskScheduler> initial, size_t maxNodes)
+    : initial_(std::move(initial)), maxNodes_(maxNodes) {
+  if (!initial_) initial_.reset(new LocalSearchScheduler());
+}
+
+std::vector<size_t> ILPScheduler::schedule(const std::vector<real>& loads,
+                                           const std::vector<real>& capacities) {
+  copyRequirements(*initial_);
+
+  std::vector<size_t> assignment = initial_->schedule(loads, capacities);
+
+  if (loads.empty() || capacities.size() < 2) return assignment;
+
+  const real initialMakespan = getMakespan(loads, capacities, assignment);
+  const int numTasks = static_cast<int>(loads.size());
+
+  glp_prob* lp = glp_create_prob();
+  glp_set_obj_dir(lp, GLP_MIN);
+
+  // rows 1..numTasks assign each task once, the following rows bound the group times
+  glp_add_rows(lp, numTasks + static_cast<int>(capacities.size()));
+
+  for (int t = 1; t <= numTasks; ++t) glp_set_row_bnds(lp, t, GLP_FX, 1.0, 1.0);
+
+  for (size_t g = 0; g < capacities.size(); ++g)
+    glp_set_row_bnds(lp, numTasks + static_cast<int>(g) + 1, GLP_UP, 0.0, 0.0);
+
+  // column 1 is the makespan C, the initial assignment stays feasible
+  glp_add_cols(lp, 1);
+  glp_set_col_bnds(lp, 1, GLP_DB, 0.0, initialMakespan * (1.0 + 1e-9));
+  glp_set_obj_coef(lp, 1, 1.0);
+
+  // glpk uses 1-based arrays
+  std::vector<int> ia(1, 0), ja(1, 0);
+  std::vector<double> ar(1, 0.0);
+  std::vector<std::pair<size_t, size_t>> variables;
+
+  for (size_t g = 0; g < capacities.size(); ++g) {
+    ia.push_back(numTasks + static_cast<int>(g) + 1);
+    ja.push_back(1);
+    ar.push_back(-1.0);
+  }
+
+  for (size_t t = 0; t < loads.size(); ++t) {
+    for (size_t g = 0; g < capacities.size(); ++g) {
+      if (!fits(t, g, capacities[g])) continue;
+
+      int col = glp_add_cols(lp, 1);
+      glp_set_col_kind(lp, col, GLP_BV);
+      variables.push_back(std::make_pair(t, g));
+
+      ia.push_back(static_cast<int>(t) + 1);
+      ja.push_back(col);
+      ar.push_back(1.0);
+
+      ia.push_back(numTasks + static_cast<int>(g) + 1);
+      ja.push_back(col);
+      ar.push_back(loads[t] / capacities[g]);
+    }
+  }
+
+  glp_load_matrix(lp, static_cast<int>(ia.size()) - 1, &ia[0], &ja[0], &ar[0]);
+
+  glp_iocp parm;
+  glp_init_iocp(&parm);
+  parm.msg_lev = GLP_MSG_OFF;
+  parm.presolve = GLP_ON;
+  parm.cb_func = terminateAfterNodes;
+  parm.cb_info = &maxNodes_;
+
+  int err = glp_intopt(lp, &parm);
+  int status = glp_mip_status(lp);
+
+  if ((err == 0 || err == GLP_ESTOP) && (status == GLP_OPT || status == GLP_FEAS)) {
+    std::vector<size_t> refined(assignment);
+
+    for (size_t i = 0; i < variables.size(); ++i) {
+      if (glp_mip_col_val(lp, static_cast<int>(i) + 2) > 0.5)
+        refined[variables[i].first] = variables[i].second;
+    }
+
+    if (getMakespan(loads, capacities, refined) < initialMakespan * (1.0 - 1e-12))
+      assignment = refined;
+  }
+
+  glp_delete_prob(lp);
+
+  return assignment;
+}
+
+} /* namespace combigrid */
@@ -0,0 +1,34 @@
+#ifndef SRC_SGPP_COMBIGRID_SCHEDULER_ILPSCHEDULER_HPP_
+#define SRC_SGPP_COMBIGRID_SCHEDULER_ILPSCHEDULER_HPP_
+
+#include <memory>
+
+#include "sgpp/distributedcombigrid/scheduler/TaskScheduler.hpp"
+
+namespace combigrid {
+
+/* refines the assignment of another scheduler (local search by default) by
+ * solving the makespan minimization as an integer linear program with GLPK:
+ * binary x_tg for each task t and each group g it fits on, minimize C subject to
+ * sum_g x_tg = 1 and sum_t load_t / capacity_g * x_tg <= C. C is bounded by the
+ * makespan of the initial assignment. branch and bound stops after maxNodes
+ * subproblems (instead of a time limit, so the result is reproducible); the
+ * best assignment found so far is returned if it is better than the initial one.
+ */
+class ILPScheduler : public TaskScheduler {
+ public:
+  explicit ILPScheduler(std::unique_ptr<TaskScheduler> initial = nullptr,
+                        size_t maxNodes = 10000);
+
+  std::vector<size_t> schedule(const std::vector<real>& loads,
+                               const std::vector<real>& capacities) override;
+
+ private:
+  std::unique_ptr<TaskScheduler> initial_;
+
+  size_t maxNodes_;
+};
+
+} /* namespace combigrid */
+
+#endif /* SRC_SGPP_COMBIGRID_SCHEDULER_ILPSCHEDULER_HPP_ */
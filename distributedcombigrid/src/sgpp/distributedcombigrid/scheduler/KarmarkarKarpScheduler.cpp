@@ -0,0 +1,89 @@
+#include "sgpp/distributedcombigrid/scheduler/KarmarkarKarpScheduler.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+
+#include "sgpp/distributedcombigrid/scheduler/LPTScheduler.hpp"
+
+namespace combigrid {
+
+namespace {
+
+struct Subset {
+  real load;
+  std::vector<size_t> tasks;
+};
+
+// k subsets sorted by decreasing load
+typedef std::vector<Subset> PartialSolution;
+
+real getDifference(const PartialSolution& s) { return s.front().load - s.back().load; }
+
+void sortSubsets(PartialSolution& s) {
+  std::stable_sort(s.begin(), s.end(),
+                   [](const Subset& a, const Subset& b) { return a.load > b.load; });
+}
+
+}  // namespace
+
+std::vector<size_t> KarmarkarKarpScheduler::schedule(const std::vector<real>& loads,
+                                                     const std::vector<real>& capacities) {
+  assert(!capacities.empty());
+
+  // the differencing method treats all groups alike
+  if (std::adjacent_find(capacities.begin(), capacities.end(), std::not_equal_to<real>()) !=
+          capacities.end() ||
+      !allowedGroups_.empty()) {
+    LPTScheduler lpt;
+    copyRequirements(lpt);
+    return lpt.schedule(loads, capacities);
+  }
+
+  // all groups have the same capacity, so every task has to fit on each of them
+  for (size_t i = 0; i < loads.size(); ++i) {
+    assert(fits(i, 0, capacities[0]) && "no group is large enough for the task");
+  }
+
+  size_t k = capacities.size();
+  std::vector<PartialSolution> solutions;
+
+  for (size_t i : getDescendingOrder(loads)) {
+    PartialSolution s(k, Subset{0.0, std::vector<size_t>()});
+    s[0].load = loads[i];
+    s[0].tasks.push_back(i);
+    solutions.push_back(s);
+  }
+
+  while (solutions.size() > 1) {
+    // the two solutions with the largest differences are at the end
+    std::stable_sort(solutions.begin(), solutions.end(),
+                     [](const PartialSolution& a, const PartialSolution& b) {
+                       return getDifference(a) < getDifference(b);
+                     });
+
+    PartialSolution a = std::move(solutions.back());
+    solutions.pop_back();
+    PartialSolution& b = solutions.back();
+
+    for (size_t j = 0; j < k; ++j) {
+      Subset& target = b[k - 1 - j];
+      target.load += a[j].load;
+      target.tasks.insert(target.tasks.end(), a[j].tasks.begin(), a[j].tasks.end());
+    }
+
+    sortSubsets(b);
+  }
+
+  std::vector<size_t> assignment(loads.size(), 0);
+
+  if (solutions.empty()) return assignment;
+
+  for (size_t g = 0; g < k; ++g) {
+    for (size_t i : solutions.front()[g].tasks) assignment[i] = g;
+  }
+
+  return assignment;
+}
+
+} /* namespace combigrid */
@@ -0,0 +1,25 @@
+#ifndef SRC_SGPP_COMBIGRID_SCHEDULER_KARMARKARKARPSCHEDULER_HPP_
+#define SRC_SGPP_COMBIGRID_SCHEDULER_KARMARKARKARPSCHEDULER_HPP_
+
+#include "sgpp/distributedcombigrid/scheduler/TaskScheduler.hpp"
+
+namespace combigrid {
+
+/* k-way largest differencing method (Karmarkar-Karp) for groups with equal
+ * capacity. each task starts as a partial solution of k subsets, only one of them
+ * non-empty. the two partial solutions with the largest difference between their
+ * largest and smallest subset are merged by combining the largest subset of one
+ * with the smallest of the other, until one solution is left. this usually yields
+ * better partitions than LPT for many tasks of similar size.
+ * for groups with different capacities (e.g. process groups of different size) or
+ * tasks which are restricted to some groups LPT is used.
+ */
+class KarmarkarKarpScheduler : public TaskScheduler {
+ public:
+  std::vector<size_t> schedule(const std::vector<real>& loads,
+                               const std::vector<real>& capacities) override;
+};
+
+} /* namespace combigrid */
+
+#endif /* SRC_SGPP_COMBIGRID_SCHEDULER_KARMARKARKARPSCHEDULER_HPP_ */
@@ -0,0 +1,39 @@
+#include "sgpp/distributedcombigrid/scheduler/LPTScheduler.hpp"
+
+#include <cassert>
+#include <limits>
+
+namespace combigrid {
+
+std::vector<size_t> LPTScheduler::schedule(const std::vector<real>& loads,
+                                           const std::vector<real>& capacities) {
+  assert(!capacities.empty());
+
+  std::vector<real> finish(capacities.size(), 0.0);
+  std::vector<size_t> assignment(loads.size());
+
+  for (size_t i : getDescendingOrder(loads)) {
+    size_t best = 0;
+    real bestTime = std::numeric_limits<real>::max();
+
+    for (size_t g = 0; g < capacities.size(); ++g) {
+      if (!fits(i, g, capacities[g])) continue;
+
+      real time = finish[g] + loads[i] / capacities[g];
+
+      if (time < bestTime) {
+        best = g;
+        bestTime = time;
+      }
+    }
+
+    assert(bestTime < std::numeric_limits<real>::max() && "no group can take the task");
+
+    assignment[i] = best;
+    finish[best] = bestTime;
+  }
+
+  return assignment;
+}
+
+} /* namespace combigrid */
@@ -0,0 +1,22 @@
+#ifndef SRC_SGPP_COMBIGRID_SCHEDULER_LPTSCHEDULER_HPP_
+#define SRC_SGPP_COMBIGRID_SCHEDULER_LPTSCHEDULER_HPP_
+
+#include "sgpp/distributedcombigrid/scheduler/TaskScheduler.hpp"
+
+namespace combigrid {
+
+/* longest processing time first: the tasks are assigned in the order of
+ * decreasing load, each to the group on which it would finish first.
+ * the makespan is at most 4/3 of the optimum for groups with equal capacity.
+ * tasks are only placed on groups which satisfy their minimum capacity and which
+ * are allowed for them
+ */
+class LPTScheduler : public TaskScheduler {
+ public:
+  std::vector<size_t> schedule(const std::vector<real>& loads,
+                               const std::vector<real>& capacities) override;
+};
+
+} /* namespace combigrid */
+
+#endif /* SRC_SGPP_COMBIGRID_SCHEDULER_LPTSCHEDULER_HPP_ */
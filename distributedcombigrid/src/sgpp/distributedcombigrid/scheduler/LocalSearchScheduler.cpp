@@ -0,0 +1,75 @@
+#include "sgpp/distributedcombigrid/scheduler/LocalSearchScheduler.hpp"
+
+#include <algorithm>
+
+#include "sgpp/distributedcombigrid/scheduler/LPTScheduler.hpp"
+
+namespace combigrid {
+
+LocalSearchScheduler::LocalSearchScheduler(std::unique_ptr<TaskScheduler> initial,
+                                           size_t maxIterations)
+    : initial_(std::move(initial)), maxIterations_(maxIterations) {
+  if (!initial_) initial_.reset(new LPTScheduler());
+}
+
+std::vector<size_t> LocalSearchScheduler::schedule(const std::vector<real>& loads,
+                                                   const std::vector<real>& capacities) {
+  copyRequirements(*initial_);
+
+  std::vector<size_t> assignment = initial_->schedule(loads, capacities);
+  std::vector<real> times = getGroupTimes(loads, capacities, assignment);
+
+  for (size_t it = 0; it < maxIterations_; ++it) {
+    if (!improve(loads, capacities, assignment, times)) break;
+  }
+
+  return assignment;
+}
+
+bool LocalSearchScheduler::improve(const std::vector<real>& loads,
+                                   const std::vector<real>& capacities,
+                                   std::vector<size_t>& assignment, std::vector<real>& times) {
+  size_t c = std::max_element(times.begin(), times.end()) - times.begin();
+
+  // a change is accepted if both groups finish clearly before the old time of c
+  const real threshold = times[c] * (1.0 - 1e-12);
+
+  for (size_t i = 0; i < loads.size(); ++i) {
+    if (assignment[i] != c) continue;
+
+    for (size_t g = 0; g < capacities.size(); ++g) {
+      if (g == c || !fits(i, g, capacities[g])) continue;
+
+      // move task i to g
+      real timeC = times[c] - loads[i] / capacities[c];
+      real timeG = times[g] + loads[i] / capacities[g];
+
+      if (std::max(timeC, timeG) < threshold) {
+        assignment[i] = g;
+        times[c] = timeC;
+        times[g] = timeG;
+        return true;
+      }
+
+      // swap task i with a smaller task j of g
+      for (size_t j = 0; j < loads.size(); ++j) {
+        if (assignment[j] != g || loads[j] >= loads[i] || !fits(j, c, capacities[c])) continue;
+
+        timeC = times[c] + (loads[j] - loads[i]) / capacities[c];
+        timeG = times[g] + (loads[i] - loads[j]) / capacities[g];
+
+        if (std::max(timeC, timeG) < threshold) {
+          assignment[i] = g;
+          assignment[j] = c;
+          times[c] = timeC;
+          times[g] = timeG;
+          return true;
+        }
+      }
+    }
+  }
+
+  return false;
+}
+
+} /* namespace combigrid */
@@ -0,0 +1,35 @@
+#ifndef SRC_SGPP_COMBIGRID_SCHEDULER_LOCALSEARCHSCHEDULER_HPP_
+#define SRC_SGPP_COMBIGRID_SCHEDULER_LOCALSEARCHSCHEDULER_HPP_
+
+#include <memory>
+
+#include "sgpp/distributedcombigrid/scheduler/TaskScheduler.hpp"
+
+namespace combigrid {
+
+/* improves the assignment of another scheduler (LPT by default) by moving
+ * single tasks away from the group which finishes last or by swapping them with
+ * smaller tasks of another group, as long as this lowers the time of the last
+ * group. stops at a local optimum or after maxIterations improvements.
+ */
+class LocalSearchScheduler : public TaskScheduler {
+ public:
+  explicit LocalSearchScheduler(std::unique_ptr<TaskScheduler> initial = nullptr,
+                                size_t maxIterations = 1000);
+
+  std::vector<size_t> schedule(const std::vector<real>& loads,
+                               const std::vector<real>& capacities) override;
+
+ private:
+  // apply the first improving move or swap. returns false if there is none
+  bool improve(const std::vector<real>& loads, const std::vector<real>& capacities,
+               std::vector<size_t>& assignment, std::vector<real>& times);
+
+  std::unique_ptr<TaskScheduler> initial_;
+
+  size_t maxIterations_;
+};
+
+} /* namespace combigrid */
+
+#endif /* SRC_SGPP_COMBIGRID_SCHEDULER_LOCALSEARCHSCHEDULER_HPP_ */
@@ -0,0 +1,42 @@
+#include "sgpp/distributedcombigrid/scheduler/TaskScheduler.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+namespace combigrid {
+
+std::vector<real> TaskScheduler::getGroupTimes(const std::vector<real>& loads,
+                                               const std::vector<real>& capacities,
+                                               const std::vector<size_t>& assignment) {
+  assert(loads.size() == assignment.size());
+
+  std::vector<real> times(capacities.size(), 0.0);
+
+  for (size_t i = 0; i < loads.size(); ++i) {
+    assert(assignment[i] < capacities.size());
+    times[assignment[i]] += loads[i] / capacities[assignment[i]];
+  }
+
+  return times;
+}
+
+real TaskScheduler::getMakespan(const std::vector<real>& loads,
+                                const std::vector<real>& capacities,
+                                const std::vector<size_t>& assignment) {
+  std::vector<real> times = getGroupTimes(loads, capacities, assignment);
+
+  return *std::max_element(times.begin(), times.end());
+}
+
+std::vector<size_t> TaskScheduler::getDescendingOrder(const std::vector<real>& loads) {
+  std::vector<size_t> order(loads.size());
+  std::iota(order.begin(), order.end(), 0);
+
+  std::stable_sort(order.begin(), order.end(),
+                   [&loads](size_t a, size_t b) { return loads[a] > loads[b]; });
+
+  return order;
+}
+
+} /* namespace combigrid */
@@ -0,0 +1,73 @@
+#ifndef SRC_SGPP_COMBIGRID_SCHEDULER_TASKSCHEDULER_HPP_
+#define SRC_SGPP_COMBIGRID_SCHEDULER_TASKSCHEDULER_HPP_
+
+#include <vector>
+
+#include "sgpp/distributedcombigrid/utils/Types.hpp"
+
+namespace combigrid {
+
+/* static assignment of tasks to process groups.
+ *
+ * a scheduler gets the estimated load of each task (e.g. from the load model) and
+ * the capacity of each group (relative speed, a task with load l needs l / c on a
+ * group with capacity c). it returns the index of the group for each task. the
+ * goal is a small makespan, i.e. the time of the group which finishes last.
+ * schedulers have to be deterministic, so that the assignment does not depend on
+ * the timing of the messages.
+ *
+ * optionally, each task can require a minimum capacity of its group (e.g. because
+ * its grids need the memory of a certain number of processes) and be restricted to
+ * a subset of the groups.
+ */
+class TaskScheduler {
+ public:
+  virtual ~TaskScheduler() = default;
+
+  virtual std::vector<size_t> schedule(const std::vector<real>& loads,
+                                       const std::vector<real>& capacities) = 0;
+
+  // minimum capacity of the group of each task for the following calls of schedule.
+  // an empty vector removes the requirements
+  inline void setMinCapacities(const std::vector<real>& minCapacities) {
+    minCapacities_ = minCapacities;
+  }
+
+  // groups on which each task may be placed (allowedGroups[task][group]) for the
+  // following calls of schedule. an empty vector allows all groups
+  inline void setAllowedGroups(const std::vector<std::vector<bool>>& allowedGroups) {
+    allowedGroups_ = allowedGroups;
+  }
+
+  // time of each group for the given assignment
+  static std::vector<real> getGroupTimes(const std::vector<real>& loads,
+                                         const std::vector<real>& capacities,
+                                         const std::vector<size_t>& assignment);
+
+  static real getMakespan(const std::vector<real>& loads, const std::vector<real>& capacities,
+                          const std::vector<size_t>& assignment);
+
+ protected:
+  // indices of the tasks sorted by decreasing load (ties by index)
+  static std::vector<size_t> getDescendingOrder(const std::vector<real>& loads);
+
+  // true if task may be placed on group, which has the given capacity
+  inline bool fits(size_t task, size_t group, real capacity) const {
+    return (minCapacities_.empty() || minCapacities_[task] <= capacity) &&
+           (allowedGroups_.empty() || allowedGroups_[task][group]);
+  }
+
+  // pass the requirements of the tasks to a scheduler which is used internally
+  inline void copyRequirements(TaskScheduler& other) const {
+    other.setMinCapacities(minCapacities_);
+    other.setAllowedGroups(allowedGroups_);
+  }
+
+  std::vector<real> minCapacities_;
+
+  std::vector<std::vector<bool>> allowedGroups_;
+};
+
+} /* namespace combigrid */
+
+#endif /* SRC_SGPP_COMBIGRID_SCHEDULER_TASKSCHEDULER_HPP_ */
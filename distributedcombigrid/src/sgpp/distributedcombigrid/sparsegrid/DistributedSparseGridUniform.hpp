@@ -2,6 +2,7 @@
 #define SRC_SGPP_COMBIGRID_SPARSEGRID_DISTRIBUTEDSPARSEGRIDUNIFORM_HPP_
 
 #include <assert.h>
+#include <algorithm>
 
 #include "sgpp/distributedcombigrid/utils/Types.hpp"
 
@@ -107,6 +108,14 @@ class DistributedSparseGridUniform {
 
   inline int getCommunicatorSize() const;
 
+  // assign each subspace to one of numOwners ranks of a reduction communicator,
+  // such that the owners receive roughly the same amount of data.
+  // subspaceSizes has to be the same on all ranks to get a consistent assignment
+  void calcSubspaceOwners(const std::vector<size_t>& subspaceSizes, int numOwners);
+
+  // return the owner of subspace i (only valid after calcSubspaceOwners)
+  inline RankType getSubspaceOwner(size_t i) const;
+
  private:
   void createLevels(DimType dim, const LevelVector& nmax, const LevelVector& lmin);
 
@@ -319,6 +328,38 @@ void DistributedSparseGridUniform<FG_ELEMENT>::calcProcAssignment(int procsPerNo
   }
 }
 
+/* greedy assignment: the largest subspaces are distributed first, each to the
+ * owner with the least data so far. ties are resolved by subspace index and
+ * rank, so that all ranks compute the same assignment */
+template <typename FG_ELEMENT>
+void DistributedSparseGridUniform<FG_ELEMENT>::calcSubspaceOwners(
+    const std::vector<size_t>& subspaceSizes, int numOwners) {
+  assert(subspaceSizes.size() == subspaces_.size());
+  assert(numOwners > 0);
+
+  std::vector<size_t> order(subspaces_.size());
+  for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+
+  std::stable_sort(order.begin(), order.end(), [&subspaceSizes](size_t a, size_t b) {
+    return subspaceSizes[a] > subspaceSizes[b];
+  });
+
+  std::vector<size_t> load(numOwners, 0);
+  subspaceToProc_.resize(subspaces_.size());
+
+  for (size_t i : order) {
+    RankType owner = RankType(std::min_element(load.begin(), load.end()) - load.begin());
+    subspaceToProc_[i] = owner;
+    load[owner] += subspaceSizes[i];
+  }
+}
+
+template <typename FG_ELEMENT>
+inline RankType DistributedSparseGridUniform<FG_ELEMENT>::getSubspaceOwner(size_t i) const {
+  assert(subspaceToProc_.size() == subspaces_.size());
+  return subspaceToProc_[i];
+}
+
 /* get index of space with l. returns -1 if not included */
 template <typename FG_ELEMENT>
 IndexType DistributedSparseGridUniform<FG_ELEMENT>::getIndex(const LevelVector& l) const {
@@ -11,6 +11,9 @@
 #include "sgpp/distributedcombigrid/fullgrid/DistributedFullGrid.hpp"
 #include "sgpp/distributedcombigrid/fullgrid/FullGrid.hpp"
 #include "sgpp/distributedcombigrid/mpi/MPISystem.hpp"
+// the archives used for the transfer of tasks have to be known where derived
+// tasks are exported
+#include "sgpp/distributedcombigrid/mpi/MPIUtils.hpp"
 #include "sgpp/distributedcombigrid/utils/LevelVector.hpp"
 #include "sgpp/distributedcombigrid/loadmodel/LoadModel.hpp"
 
@@ -50,6 +53,9 @@ class Task {
 
   inline int getID() const;
 
+  // number of grid points of each grid of the task
+  inline size_t getNumPoints() const;
+
   virtual void run(CommunicatorType lcomm) = 0;
 
   virtual void changeDir(CommunicatorType lcomm) {
@@ -140,6 +146,16 @@ inline const std::vector<bool>& Task::getBoundary() const { return boundary_; }
 
 inline int Task::getID() const { return id_; }
 
+inline size_t Task::getNumPoints() const {
+  size_t numPoints = 1;
+
+  for (DimType d = 0; d < dim_; ++d) {
+    numPoints *= (size_t(1) << l_[d]) + (boundary_[d] ? 1 : -1);
+  }
+
+  return numPoints;
+}
+
 inline bool Task::isFinished() const { return isFinished_; }
 
 inline void Task::setFinished(bool finished) { isFinished_ = finished; }
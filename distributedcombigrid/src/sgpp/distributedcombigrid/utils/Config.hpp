@@ -50,8 +50,9 @@ typedef std::complex<real> complex;
 /* using a uniform domain decomposition for all component grids (the same
  * number of processes in each dimension) yields a significantly better performance
  * for the combination and eval operation.
- * to enable the uniform operations set this to true.
- * so far, only the uniform operations are properly implemented
+ * otherwise each task can choose its own parallelization and the component grids
+ * are redistributed to the common parallelization of the combination parameters
+ * during the combination, which costs additional communication.
  */
 #ifdef UNIFORMDECOMPOSITION
 	constexpr bool uniformDecomposition = true;
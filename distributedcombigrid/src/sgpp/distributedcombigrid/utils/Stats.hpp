@@ -11,6 +11,7 @@
 #include <string>
 #include <unordered_map>
 #include <vector>
+#include "sgpp/distributedcombigrid/mpi/MPILargeCount.hpp"
 #include "sgpp/distributedcombigrid/mpi/MPISystem.hpp"
 
 /* comment this line to switch of timing */
@@ -219,7 +220,10 @@ inline void Stats::write(const std::string& path, CommunicatorType comm) {
   }
 
   // write to single file with MPI-IO
-  MPI_File_write_at_all(fh, pos, buffer.str().c_str(), (int)len, MPI_CHAR, MPI_STATUS_IGNORE);
+  MPI_Datatype writeType;
+  int writeCount = MPILargeCount::createLargeType(size_t(len), MPI_CHAR, &writeType);
+  MPI_File_write_at_all(fh, pos, buffer.str().c_str(), writeCount, writeType, MPI_STATUS_IGNORE);
+  MPILargeCount::freeLargeType(&writeType, MPI_CHAR);
   MPI_File_close(&fh);
 }
 #else
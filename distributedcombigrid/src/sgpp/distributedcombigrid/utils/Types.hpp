@@ -60,6 +60,22 @@ inline DataType getabstractionDataType<std::complex<float> >() {
   return abstraction::type_float_complex;
 }
 
+// type with the next lower precision, used to reduce the communication volume
+template <class T>
+struct ReducedPrecision {
+  typedef T type;
+};
+
+template <>
+struct ReducedPrecision<double> {
+  typedef float type;
+};
+
+template <>
+struct ReducedPrecision<std::complex<double> > {
+  typedef std::complex<float> type;
+};
+
 inline MPI_Datatype getMPIDatatype(abstraction::DataType type) {
   switch (type) {
     case abstraction::type_float:
@@ -7,6 +7,7 @@
 #include <random>
 #include <vector>
 
+#include "sgpp/distributedcombigrid/combicom/CombiCom.hpp"
 #include "sgpp/distributedcombigrid/fullgrid/DistributedFullGrid.hpp"
 #include "sgpp/distributedcombigrid/fullgrid/FullGrid.hpp"
 #include "sgpp/distributedcombigrid/utils/Types.hpp"
@@ -48,6 +49,13 @@ void checkDistributedFullgrid(LevelVector& levels, IndexVector& procs, std::vect
   }
   BOOST_CHECK(nrElements == dfg.getNrElements());
 
+  // the largest local part can be computed without creating the grid
+  IndexType maxNrLocalElements = dfg.getNrLocalElements();
+  MPI_Allreduce(MPI_IN_PLACE, &maxNrLocalElements, 1, MPI_INT64_T, MPI_MAX, comm);
+  BOOST_CHECK_EQUAL(maxNrLocalElements,
+                    DistributedFullGrid<std::complex<double>>::getMaxNrLocalElements(
+                        levels, boundary, procs, forward));
+
   // set function values
   for (IndexType li = 0; li < dfg.getNrLocalElements(); ++li) {
     std::vector<double> coords(dim);
@@ -88,6 +96,45 @@ void checkDistributedFullgrid(LevelVector& levels, IndexVector& procs, std::vect
   }
 }
 
+/**
+ * redistribute a grid from parallelization procs1 to procs2 and back
+ */
+void checkRedistribution(LevelVector& levels, IndexVector& procs1, IndexVector& procs2,
+                         std::vector<bool>& boundary, int size) {
+  CommunicatorType comm = TestHelper::getComm(size);
+  if (comm == MPI_COMM_NULL) return;
+
+  TestFn f;
+  const DimType dim = levels.size();
+
+  DistributedFullGrid<std::complex<double>> dfg1(dim, levels, comm, boundary, procs1, true);
+  DistributedFullGrid<std::complex<double>> dfg2(dim, levels, comm, boundary, procs2, false);
+
+  for (IndexType li = 0; li < dfg1.getNrLocalElements(); ++li) {
+    std::vector<double> coords(dim);
+    dfg1.getCoordsLocal(li, coords);
+    dfg1.getData()[li] = f(coords);
+  }
+
+  CombiCom::redistribute(dfg1, dfg2);
+
+  for (IndexType li = 0; li < dfg2.getNrLocalElements(); ++li) {
+    std::vector<double> coords(dim);
+    dfg2.getCoordsLocal(li, coords);
+    BOOST_TEST(dfg2.getData()[li] == f(coords));
+  }
+
+  // and back
+  std::fill(dfg1.getData(), dfg1.getData() + dfg1.getNrLocalElements(), 0.0);
+  CombiCom::redistribute(dfg2, dfg1);
+
+  for (IndexType li = 0; li < dfg1.getNrLocalElements(); ++li) {
+    std::vector<double> coords(dim);
+    dfg1.getCoordsLocal(li, coords);
+    BOOST_TEST(dfg1.getData()[li] == f(coords));
+  }
+}
+
 BOOST_AUTO_TEST_SUITE(distributedfullgrid)
 
 // with boundary
@@ -242,5 +289,22 @@ BOOST_AUTO_TEST_CASE(test_18) {
   boundary[2] = true;
   checkDistributedFullgrid(levels, procs, boundary, 8, true);
 }
+BOOST_AUTO_TEST_CASE(test_19) {
+  BOOST_REQUIRE(TestHelper::checkNumMPIProcsAvailable(4));
+  LevelVector levels = {4, 3};
+  IndexVector procs1 = {2, 2};
+  IndexVector procs2 = {4, 1};
+  std::vector<bool> boundary(2, true);
+  checkRedistribution(levels, procs1, procs2, boundary, 4);
+}
+BOOST_AUTO_TEST_CASE(test_20) {
+  BOOST_REQUIRE(TestHelper::checkNumMPIProcsAvailable(8));
+  LevelVector levels = {3, 4, 3};
+  IndexVector procs1 = {2, 2, 2};
+  IndexVector procs2 = {1, 8, 1};
+  std::vector<bool> boundary(3, false);
+  boundary[2] = true;
+  checkRedistribution(levels, procs1, procs2, boundary, 8);
+}
 
 BOOST_AUTO_TEST_SUITE_END()
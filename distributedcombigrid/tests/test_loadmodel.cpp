@@ -2,6 +2,8 @@
 #include <boost/test/unit_test.hpp>
 
 #include <chrono>
+#include <cmath>
+#include <cstdio>
 #include <limits>
 #include <random>
 #include <thread>
@@ -45,10 +47,10 @@ void testDataSave(int size) {
         }
       }
     }
-    // test loadmodel
+    // test loadmodel, the load is the time of all 64000 processes
     for (long int i = 0; i < ngroup; ++i) {
       // std::cout << "llm eval " << loadModel->eval({i}) << std::endl;
-      BOOST_TEST(loadModel->eval({i}) == 1000000 * i);
+      BOOST_TEST(loadModel->eval({i}) == 1000000.0 * 64000 * i);
     }
   }
   else {
@@ -87,15 +89,81 @@ void testDataSave(int size) {
   combigrid::Stats::finalize();
 }
 
+void testRegression() {
+  // the model writes to files in the working directory, so only one process tests it
+  CommunicatorType comm = TestHelper::getComm(1);
+  if (comm == MPI_COMM_NULL) {
+    return;
+  }
+
+  // process times of 12 * 2^l_1 * 4^l_2 usec with a time step of 0.01, perfect strong
+  // scaling and twice the time for a quarter of the time step
+  auto processTime = [](const LevelVector& l, real dt) {
+    return 12.0 * std::pow(2.0, real(l[0])) * std::pow(4.0, real(l[1])) *
+           std::sqrt(0.01 / dt);
+  };
+  std::vector<LevelVector> measured = {{3, 3}, {4, 3}, {5, 3}, {3, 4}, {3, 5}, {4, 4}};
+  LevelVector unseen = {6, 4};
+
+  std::vector<LevelVector> all(measured);
+  all.push_back(unseen);
+  for (const auto& l : all) std::remove(getFilename(l).c_str());
+
+  {
+    LearningLoadModel llm(std::vector<LevelVector>{});
+
+    // without measurements the linear load model is used, also for unknown level vectors
+    LinearLoadModel linear;
+    BOOST_TEST(llm.eval(unseen) == linear.eval(unseen));
+
+    // the tasks run on groups of 2, 4 and 8 processes with time steps of 0.01 and 0.0025
+    for (int k = 0; k < 24; ++k) {
+      uint nProcesses = 2u << (k % 3);
+      real dt = (k % 2 == 0) ? 0.01 : 0.0025;
+
+      for (const auto& l : measured) {
+        durationInformation info = {
+            0, static_cast<long unsigned int>(processTime(l, dt) / nProcesses), 0.0, dt, 0,
+            nProcesses};
+        llm.addDataPoint(info, l);
+      }
+    }
+
+    // the mean process time does not depend on the group sizes, the measurements are
+    // scaled to the mean (log) time step of 0.005 with the fitted power of dt
+    BOOST_TEST(llm.eval(measured[0]) == processTime(measured[0], 0.005));
+
+    // the level vector without measurements is predicted by the regression at the mean
+    // (log) time step of 0.005
+    BOOST_TEST(llm.eval(unseen) == processTime(unseen, 0.005));
+
+    // its own measurements replace the prediction, the duration on 4 processes is
+    // scaled to the time step of 0.005 as well
+    durationInformation info = {0, 1000, 0.0, 0.01, 0, 4};
+    llm.addDataPoint(info, unseen);
+    BOOST_TEST(llm.eval(unseen) == 4000.0 * std::sqrt(2.0));
+  }
+
+  for (const auto& l : all) std::remove(getFilename(l).c_str());
+}
+
 BOOST_AUTO_TEST_SUITE(loadmodel)
 
-BOOST_AUTO_TEST_CASE(test_2) {
+// the measured loads are scaled by the fitted power of the time step, which is only
+// exact up to rounding
+BOOST_AUTO_TEST_CASE(test_2, *boost::unit_test::tolerance(TestHelper::tolerance)) {
     testDataSave(2);
 }
 
-BOOST_AUTO_TEST_CASE(test_9, *boost::unit_test::timeout(120)) {
+BOOST_AUTO_TEST_CASE(test_9, *boost::unit_test::tolerance(TestHelper::tolerance) *
+                                 boost::unit_test::timeout(120)) {
   testDataSave(9);
   MPI_Barrier(MPI_COMM_WORLD);
 }
 
+BOOST_AUTO_TEST_CASE(test_regression, *boost::unit_test::tolerance(0.05)) {
+  testRegression();
+  MPI_Barrier(MPI_COMM_WORLD);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
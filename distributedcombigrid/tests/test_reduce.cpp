@@ -1,13 +1,23 @@
 #define BOOST_TEST_DYN_LINK
 #include <mpi.h>
 #include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <complex>
 #include <cstdarg>
+#include <cstdio>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include <boost/serialization/export.hpp>
+#include "sgpp/distributedcombigrid/combicom/GlobalReduceAutotuner.hpp"
 #include "sgpp/distributedcombigrid/combischeme/CombiMinMaxScheme.hpp"
 #include "sgpp/distributedcombigrid/fault_tolerance/FaultCriterion.hpp"
 #include "sgpp/distributedcombigrid/fault_tolerance/StaticFaults.hpp"
@@ -18,6 +28,7 @@
 #include "sgpp/distributedcombigrid/manager/ProcessGroupManager.hpp"
 #include "sgpp/distributedcombigrid/manager/ProcessGroupWorker.hpp"
 #include "sgpp/distributedcombigrid/manager/ProcessManager.hpp"
+#include "sgpp/distributedcombigrid/mpi/MPILargeCount.hpp"
 #include "sgpp/distributedcombigrid/task/Task.hpp"
 #include "sgpp/distributedcombigrid/utils/Config.hpp"
 #include "sgpp/distributedcombigrid/utils/Types.hpp"
@@ -26,19 +37,35 @@
 using namespace combigrid;
 
 /* simple task class to set all values on the grid to $levelVector_1 / levelVector_2$
+ * (on all numGrids grids). with advance, the values are multiplied by the number of the
+ * run, so the solution changes from run to run and differently for each task. with a
+ * perturbation p, the values are multiplied by 1 + p sin(pi x_1) sin(pi x_2), which has
+ * surpluses in all subspaces which do not lie on the boundary. with ownParallelization,
+ * the task splits the dimension with the higher level instead of the first one
  */
 class TaskConst : public combigrid::Task {
  public:
-  TaskConst(LevelVector& l, std::vector<bool>& boundary, real coeff, LoadModel* loadModel)
-      : Task(2, l, boundary, coeff, loadModel){}
+  TaskConst(LevelVector& l, std::vector<bool>& boundary, real coeff, LoadModel* loadModel,
+            int numGrids = 1, bool advance = false, real perturbation = 0.0,
+            bool ownParallelization = false)
+      : Task(2, l, boundary, coeff, loadModel),
+        numGrids_(numGrids),
+        advance_(advance),
+        perturbation_(perturbation),
+        ownParallelization_(ownParallelization),
+        numRuns_(0) {}
 
   void init(CommunicatorType lcomm, std::vector<IndexVector> decomposition) {
+    initThread_ = std::this_thread::get_id();
+
     // parallelization
     // assert(dfg_ == nullptr);
     long nprocs = getCommSize(lcomm);
     // IndexVector p = {nprocs, 1};
     IndexVector p = {nprocs,1};
 
+    if (ownParallelization_ && getLevelVector()[1] > getLevelVector()[0]) p = {1, nprocs};
+
     // decomposition = std::vector<IndexVector>(2);
     // size_t l1 = getLevelVector()[1];
     // size_t npoint_x1 = pow(2, l1) + 1;
@@ -53,25 +80,52 @@ class TaskConst : public combigrid::Task {
     //   // std::cout << decomposition[1].back() << std::endl;
     // }
 
-    dfg_ = new DistributedFullGrid<CombiDataType>(getDim(), getLevelVector(), lcomm, getBoundary(),
-                                                  p, false, decomposition);
+    // the sparse grids take the decomposition of the tasks, parallelEval assumes the
+    // forward decomposition outside of GENE
+    for (int g = 0; g < numGrids_; ++g) {
+      dfgs_.push_back(new DistributedFullGrid<CombiDataType>(
+          getDim(), getLevelVector(), lcomm, getBoundary(), p, !isGENE, decomposition));
 
-    std::vector<CombiDataType>& elements = dfg_->getElementVector();
-    for (auto& element : elements) {
-      element = 10;
+      std::vector<CombiDataType>& elements = dfgs_.back()->getElementVector();
+      for (auto& element : elements) {
+        element = 10;
+      }
     }
   }
 
   void run(CommunicatorType lcomm) {
 
     std::cout << "run " << getCommRank(lcomm) << std::endl;    
-    
-    std::vector<CombiDataType>& elements = dfg_->getElementVector();
-    for (auto& element : elements) {
-      // BOOST_CHECK(abs(dfg_->getData()[li]));
-      element = getLevelVector()[0] / (double)getLevelVector()[1];
+
+    // the first value of this process is recorded before and after each run
+    bool record = !dfgs_.empty() && dfgs_[0]->getNrLocalElements() > 0;
+
+    if (record) startValues_.push_back(dfgs_[0]->getElementVector()[0]);
+
+    std::vector<real> coords(getDim());
+
+    for (DistributedFullGrid<CombiDataType>* dfg : dfgs_) {
+      std::vector<CombiDataType>& elements = dfg->getElementVector();
+      for (size_t i = 0; i < elements.size(); ++i) {
+        CombiDataType& element = elements[i];
+        // BOOST_CHECK(abs(dfg_->getData()[li]));
+        element = getLevelVector()[0] / (double)getLevelVector()[1];
+        if (advance_) element *= numRuns_ + 1;
+
+        if (perturbation_ != 0.0) {
+          dfg->getCoordsLocal(IndexType(i), coords);
+          element *= 1.0 + perturbation_ * std::sin(M_PI * coords[0]) * std::sin(M_PI * coords[1]);
+        }
+      }
     }
-    BOOST_CHECK(dfg_);
+    BOOST_CHECK(!dfgs_.empty());
+
+    if (record) endValues_.push_back(dfgs_[0]->getElementVector()[0]);
+
+    ++numRuns_;
+
+    if (getCommSize(lcomm) == int(slowGroupSize()))
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
 
     setFinished(true);
     
@@ -80,36 +134,138 @@ class TaskConst : public combigrid::Task {
   }
 
   void getFullGrid(FullGrid<CombiDataType>& fg, RankType r, CommunicatorType lcomm, int n = 0) {
-    dfg_->gatherFullGrid(fg, r);
+    dfgs_[n]->gatherFullGrid(fg, r);
   }
 
-  DistributedFullGrid<CombiDataType>& getDistributedFullGrid(int n = 0) { return *dfg_; }
+  DistributedFullGrid<CombiDataType>& getDistributedFullGrid(int n = 0) { return *dfgs_[n]; }
 
   void setZero() {}
 
+  // values of the first grid point of this process at the start and at the end of each run
+  const std::vector<CombiDataType>& getStartValues() const { return startValues_; }
+
+  const std::vector<CombiDataType>& getEndValues() const { return endValues_; }
+
+  // runs on groups of this size take 20 ms longer, to control the measured loads. 0 for
+  // none
+  static size_t& slowGroupSize() {
+    static size_t size = 0;
+    return size;
+  }
+
+  // grids of the task on this process (none if the task is not initialized here)
+  const std::vector<DistributedFullGrid<CombiDataType>*>& getGrids() const { return dfgs_; }
+
+  // thread which initialized the task (no thread if it is not initialized on this process)
+  std::thread::id getInitThread() const { return initThread_; }
+
   ~TaskConst() {
-    if (dfg_ != NULL) delete dfg_;
+    for (DistributedFullGrid<CombiDataType>* dfg : dfgs_) delete dfg;
   }
 
  protected:
-  TaskConst() : dfg_(NULL) {}
+  TaskConst()
+      : numGrids_(1), advance_(false), perturbation_(0.0), ownParallelization_(false),
+        numRuns_(0) {}
 
  private:
   friend class boost::serialization::access;
 
-  DistributedFullGrid<CombiDataType>* dfg_;
+  int numGrids_;
+
+  bool advance_;
+
+  real perturbation_;
+
+  bool ownParallelization_;
+
+  int numRuns_;
+
+  std::vector<DistributedFullGrid<CombiDataType>*> dfgs_;
+
+  std::vector<CombiDataType> startValues_;
+
+  std::vector<CombiDataType> endValues_;
+
+  std::thread::id initThread_;
 
   template <class Archive>
   void serialize(Archive& ar, const unsigned int version) {
     ar& boost::serialization::base_object<Task>(*this);
+    ar& numGrids_;
+    ar& advance_;
+    ar& perturbation_;
+    ar& ownParallelization_;
+    ar& numRuns_;
     // ar& nprocs_;
   }
 };
 
 BOOST_CLASS_EXPORT(TaskConst)
 
-void checkCombine(size_t ngroup = 1, size_t nprocs = 1) {
-  size_t size = ngroup * nprocs + 1;
+/* precondition of the tests which are not available with fault tolerance. unlike
+ * enable_if, it also skips the test if its suite is selected with --run_test
+ */
+struct WithoutFaultTolerance {
+  boost::test_tools::assertion_result operator()(boost::unit_test::test_unit_id) {
+    return !ENABLE_FT;
+  }
+};
+
+/* precondition of the tests of tasks with their own parallelization, which the uniform
+ * decomposition does not allow
+ */
+struct WithoutUniformDecomposition {
+  boost::test_tools::assertion_result operator()(boost::unit_test::test_unit_id) {
+    return !uniformDecomposition;
+  }
+};
+
+/* setup of a combination test: the process groups (ngroup groups of nprocs processes or
+ * groups of the given sizes), the grids of the tasks (see TaskConst) and the number of
+ * combinations of the parameters. the features under test are configured by the checks
+ */
+struct CombiSetup {
+  CombiSetup(size_t ngroup, size_t nprocs) : groupSizes(ngroup, nprocs) {}
+
+  explicit CombiSetup(const std::vector<size_t>& groupSizes) : groupSizes(groupSizes) {}
+
+  std::vector<size_t> groupSizes;
+  int numGrids = 1;
+  bool advance = false;
+  real perturbation = 0.0;
+  bool ownParallelization = false;
+  size_t ncombi = 2;
+  size_t groupsPerSubmanager = 0;
+};
+
+// sets the parameters of the feature under test
+typedef std::function<void(CombiParameters&)> Configure;
+
+// drives the combination on the manager after runfirst
+typedef std::function<void(ProcessManager&, const ProcessGroupManagerContainer&)> Manage;
+
+// checks the tasks of a worker after the exit signal
+typedef std::function<void(const TaskContainer&)> CheckTasks;
+
+// the loops of the manager which are run by several checks
+enum class CombiLoop { COMBINE, COMBINE_ASYNC, RUNNEXT_AND_COMBINE, AUTONOMOUS };
+
+// combination of the constant functions of the tasks
+const real combinedValue = 4.0 / 3.0;
+
+/* runs a combination of the scheme with lmin 2 and lmax 4 in 2D on the process groups of
+ * setup. the manager calls manage after runfirst, the workers wait for signals until the
+ * exit and call checkTasks with their tasks afterwards
+ */
+void runCombination(const CombiSetup& setup, const Configure& configure, const Manage& manage,
+                    const CheckTasks& checkTasks = nullptr) {
+  const std::vector<size_t>& groupSizes = setup.groupSizes;
+  size_t ngroup = groupSizes.size();
+  // the sparse grids use the parallelization of the smallest group
+  size_t nprocs = *std::min_element(groupSizes.begin(), groupSizes.end());
+
+  size_t size = std::accumulate(groupSizes.begin(), groupSizes.end(), size_t(1));
   BOOST_REQUIRE(TestHelper::checkNumMPIProcsAvailable(size));
 
   CommunicatorType comm = TestHelper::getComm(size);
@@ -119,87 +275,47 @@ void checkCombine(size_t ngroup = 1, size_t nprocs = 1) {
 
   combigrid::Stats::initialize();
 
-  theMPISystem()->initWorldReusable(comm, ngroup, nprocs);
-  // theMPISystem()->init(ngroup, nprocs);
+  theMPISystem()->initWorldReusable(comm, groupSizes);
+  theMPISystem()->initSubmanagers(setup.groupsPerSubmanager);
 
   WORLD_MANAGER_EXCLUSIVE_SECTION {
     ProcessGroupManagerContainer pgroups;
-    for (int i = 0; i < ngroup; ++i) {
-      int pgroupRootID(i);
-      pgroups.emplace_back(std::make_shared<ProcessGroupManager>(pgroupRootID));
+    for (size_t i = 0; i < ngroup; ++i) {
+      pgroups.emplace_back(std::make_shared<ProcessGroupManager>(RankType(i)));
     }
 
     auto loadmodel = std::unique_ptr<LoadModel>(new LinearLoadModel());
 
     DimType dim = 2;
-    LevelVector lmin(dim, 2);
-    LevelVector lmax(dim, 4), leval(dim, 4);
-
-    size_t ncombi = 2;
+    LevelVector lmin(dim, 2), lmax(dim, 4);
     std::vector<bool> boundary(dim, true);
 
     CombiMinMaxScheme combischeme(dim, lmin, lmax);
-    // combischeme.createClassicalCombischeme();
     combischeme.createAdaptiveCombischeme();
-
     std::vector<LevelVector> levels = combischeme.getCombiSpaces();
-    // std::cout << "levels " << std::endl;
-    // for (const auto& level : levels) {
-    //   std::cout << toString(level) << std::endl;
-    // }
-
     std::vector<combigrid::real> coeffs = combischeme.getCoeffs();
-    // std::cout << "coeffs " << std::endl;
-    // for (const auto& coeff : coeffs) {
-    //   std::cout << coeff << std::endl;
-    // }
 
-    BOOST_REQUIRE(TestHelper::checkNumMPIProcsAvailable(size));
-
-    // create Tasks
     TaskContainer tasks;
     std::vector<int> taskIDs;
     for (size_t i = 0; i < levels.size(); i++) {
-      Task* t = new TaskConst(levels[i], boundary, coeffs[i], loadmodel.get());
+      Task* t = new TaskConst(levels[i], boundary, coeffs[i], loadmodel.get(), setup.numGrids,
+                              setup.advance, setup.perturbation, setup.ownParallelization);
       tasks.push_back(t);
       taskIDs.push_back(t->getID());
     }
 
-    // create combiparameters
-    CombiParameters params(dim, lmin, lmax, boundary, levels, coeffs, taskIDs, ncombi);
-    params.setParallelization({nprocs, 1}); //TODO why??
+    CombiParameters params(dim, lmin, lmax, boundary, levels, coeffs, taskIDs, setup.ncombi,
+                           setup.numGrids);
+    params.setParallelization({static_cast<IndexType>(nprocs), 1});
 
-    // create abstraction for Manager
-    ProcessManager manager(pgroups, tasks, params, std::move(loadmodel));
+    if (configure) configure(params);
 
-    // the combiparameters are sent to all process groups before the
-    // computations start
-    manager.updateCombiParameters(); //TODO move to manager constructor or runfirst?
+    ProcessManager manager(pgroups, tasks, params, std::move(loadmodel));
 
-    /* distribute task according to load model and start computation for
-     * the first time */
-    std::cout << "run first " << std::endl;
+    manager.updateCombiParameters();
     manager.runfirst();
 
-    for (size_t it = 0; it < ncombi; ++it) {
-      // manager.combine();
-
-      // std::cout << "run next " << std::endl;
-      // manager.runnext();
-      std::cout << "combine " << std::endl;
-      manager.combine();
-    }
-
-    // evaluate solution
-    FullGrid<CombiDataType> fg_eval(dim, leval, boundary);
-    manager.gridEval(fg_eval);
-    // std::cout << "fg_eval "<< fg_eval << std::endl;
-
-    // compare with known results:
-    // point in the middle
-    CombiDataType midResult = fg_eval.getData()[fg_eval.getNrElements() / 2];
-    std::cout << "midResult " << fabs(midResult) << std::endl;
-    BOOST_TEST(fabs(midResult) == 1.333333333);
+    manage(manager, pgroups);
 
     manager.exit();
   }
@@ -207,6 +323,662 @@ void checkCombine(size_t ngroup = 1, size_t nprocs = 1) {
     ProcessGroupWorker pgroup;
     SignalType signal = -1;
     while (signal != EXIT) signal = pgroup.wait();
+
+    if (checkTasks) checkTasks(pgroup.getTaskContainer());
+  }
+
+  combigrid::Stats::finalize();
+  MPI_Barrier(comm);
+}
+
+void runLoop(ProcessManager& manager, CombiLoop loop, size_t ncombi) {
+  switch (loop) {
+    case CombiLoop::COMBINE:
+      for (size_t it = 0; it < ncombi; ++it) manager.combine();
+      break;
+    case CombiLoop::COMBINE_ASYNC:
+      // the last combination applies the lagged one
+      for (size_t it = 0; it + 1 < ncombi; ++it) {
+        manager.combineAsync();
+        manager.runnext();
+      }
+      manager.combine();
+      break;
+    case CombiLoop::RUNNEXT_AND_COMBINE:
+      for (size_t it = 0; it < ncombi; ++it) manager.runnextAndCombine();
+      break;
+    case CombiLoop::AUTONOMOUS:
+      manager.runAutonomous(int(ncombi), 1);
+      break;
+  }
+}
+
+Configure setReduceType(GlobalReduceType reduceType) {
+  return [reduceType](CombiParameters& params) { params.setGlobalReduceType(reduceType); };
+}
+
+// evaluates the combined solution at level (4, 4) on the manager
+std::vector<CombiDataType> evalCombined(ProcessManager& manager) {
+  // the evaluation adds to the grid, so each call needs a new one
+  FullGrid<CombiDataType> fg(2, LevelVector(2, 4), std::vector<bool>(2, true));
+  manager.gridEval(fg);
+
+  return std::vector<CombiDataType>(fg.getData(), fg.getData() + fg.getNrElements());
+}
+
+// values of a plot file of parallelEval: the dimension and the sizes, then the values
+std::vector<CombiDataType> readPlotFile(const std::string& filename) {
+  std::ifstream ifs(filename.c_str(), std::ios::binary);
+  int dim = 0;
+  ifs.read(reinterpret_cast<char*>(&dim), sizeof(int));
+
+  std::vector<int> sizes(dim);
+  ifs.read(reinterpret_cast<char*>(sizes.data()), dim * sizeof(int));
+
+  size_t numElements = std::accumulate(sizes.begin(), sizes.end(), size_t(1),
+                                       std::multiplies<size_t>());
+  std::vector<CombiDataType> values(numElements);
+  ifs.read(reinterpret_cast<char*>(values.data()), numElements * sizeof(CombiDataType));
+  BOOST_REQUIRE(ifs.good());
+
+  return values;
+}
+
+// evaluates the first grid of the combined solution at level (4, 4) with parallelEval
+std::vector<CombiDataType> parallelEvalCombined(ProcessManager& manager, std::string filename) {
+  manager.parallelEval(LevelVector(2, 4), filename, 0);
+
+  // one file per grid
+  std::string plotFile = filename + "0";
+  std::vector<CombiDataType> values = readPlotFile(plotFile);
+  std::remove(plotFile.c_str());
+
+  return values;
+}
+
+// the midpoint only has a surplus in the subspace of level (1, 1)
+CombiDataType getMidpoint(const std::vector<CombiDataType>& values) {
+  return values[values.size() / 2];
+}
+
+real getMaxDifference(const std::vector<CombiDataType>& values,
+                      const std::vector<CombiDataType>& reference) {
+  BOOST_REQUIRE_EQUAL(values.size(), reference.size());
+
+  real maxDifference = 0.0;
+
+  for (size_t i = 0; i < values.size(); ++i)
+    maxDifference = std::max(maxDifference, real(std::abs(values[i] - reference[i])));
+
+  return maxDifference;
+}
+
+// all values of the grids of the tasks on this process are value
+void checkGridValues(const TaskContainer& tasks, real value) {
+  for (Task* t : tasks) {
+    for (DistributedFullGrid<CombiDataType>* dfg : dynamic_cast<TaskConst&>(*t).getGrids()) {
+      for (const CombiDataType& element : dfg->getElementVector())
+        BOOST_TEST(std::abs(element) == value);
+    }
+  }
+}
+
+/* calls f for the tasks which were run on this process, e.g. not for the small tasks of
+ * other subgroups
+ */
+void forEachRunTask(const TaskContainer& tasks, const std::function<void(const TaskConst&)>& f) {
+  for (Task* t : tasks) {
+    const TaskConst& task = dynamic_cast<const TaskConst&>(*t);
+
+    if (!task.getStartValues().empty()) f(task);
+  }
+}
+
+/* number of runs of task which start from a combined solution. such a run does not start
+ * with the value the previous run ended with
+ */
+int countCombinedRuns(const TaskConst& task) {
+  const std::vector<CombiDataType>& startValues = task.getStartValues();
+  const std::vector<CombiDataType>& endValues = task.getEndValues();
+
+  int numCombinedRuns = 0;
+
+  for (size_t i = 1; i < startValues.size(); ++i) {
+    if (std::abs(startValues[i] - endValues[i - 1]) >= 1e-9) ++numCombinedRuns;
+  }
+
+  return numCombinedRuns;
+}
+
+/* combinations without runs in between. all component grids hold the combination of the
+ * constant functions afterwards
+ */
+void checkCombine(const CombiSetup& setup, const Configure& configure = nullptr) {
+  runCombination(
+      setup, configure,
+      [&setup](ProcessManager& manager, const ProcessGroupManagerContainer&) {
+        runLoop(manager, CombiLoop::COMBINE, setup.ncombi);
+
+        BOOST_TEST(std::abs(getMidpoint(evalCombined(manager))) == combinedValue);
+      },
+      [](const TaskContainer& tasks) { checkGridValues(tasks, combinedValue); });
+}
+
+/* runs and combines a perturbed and changing solution on the groups of setup and returns
+ * the evaluated combined solution on the manager (empty on the other processes)
+ */
+std::vector<CombiDataType> combineChanging(CombiSetup setup, const Configure& configure) {
+  setup.advance = true;
+  setup.perturbation = 0.5;
+
+  std::vector<CombiDataType> result;
+
+  runCombination(setup, configure,
+                 [&setup, &result](ProcessManager& manager, const ProcessGroupManagerContainer&) {
+                   runLoop(manager, CombiLoop::RUNNEXT_AND_COMBINE, setup.ncombi);
+                   result = evalCombined(manager);
+                 });
+
+  return result;
+}
+
+// result of a combination which has to be the same as the one of the plain allreduce
+void checkSameResult(const std::vector<CombiDataType>& result,
+                     const std::vector<CombiDataType>& reference) {
+  // only the manager evaluates the combined solution
+  BOOST_REQUIRE_EQUAL(result.size(), reference.size());
+
+  if (reference.empty()) return;
+
+  // the sums are only formed in a different order
+  BOOST_CHECK(getMaxDifference(result, reference) < 1e-10);
+}
+
+/* a global reduce type has to give the combination of the constant functions and, with
+ * surpluses in all subspaces and a solution which changes from run to run, the same
+ * result as the plain allreduce
+ */
+void checkReduceType(const CombiSetup& setup, GlobalReduceType reduceType) {
+  checkCombine(setup, setReduceType(reduceType));
+
+  CombiSetup changing(setup);
+  changing.ncombi = 4;
+
+  std::vector<CombiDataType> reference = combineChanging(changing, nullptr);
+  checkSameResult(combineChanging(changing, setReduceType(reduceType)), reference);
+}
+
+/* lagged combination: the correction of a combination is applied at the start of the
+ * next one. the run after that starts from its own state plus the correction, so
+ * start[i] = end[i - 1] + combined(i - 2) - end[i - 2]
+ */
+void checkAsync(const CombiSetup& setup, const Configure& configure = nullptr) {
+  runCombination(
+      setup, configure,
+      [&setup](ProcessManager& manager, const ProcessGroupManagerContainer&) {
+        runLoop(manager, CombiLoop::COMBINE_ASYNC, setup.ncombi);
+
+        real factor = setup.advance ? real(setup.ncombi) : 1.0;
+        BOOST_TEST(std::abs(getMidpoint(evalCombined(manager))) == combinedValue * factor);
+      },
+      [&setup](const TaskContainer& tasks) {
+        forEachRunTask(tasks, [&setup](const TaskConst& task) {
+          const std::vector<CombiDataType>& startValues = task.getStartValues();
+          const std::vector<CombiDataType>& endValues = task.getEndValues();
+
+          BOOST_REQUIRE_EQUAL(startValues.size(), setup.ncombi);
+
+          // the first correction is only applied with the second combination
+          BOOST_CHECK_EQUAL(startValues[1], endValues[0]);
+
+          for (size_t i = 2; i < startValues.size(); ++i) {
+            real factor = setup.advance ? real(i - 1) : 1.0;
+            BOOST_TEST(std::abs(startValues[i] - endValues[i - 1] + endValues[i - 2]) ==
+                       combinedValue * factor);
+          }
+        });
+
+        // the last combination is synchronous
+        checkGridValues(tasks, combinedValue * (setup.advance ? real(setup.ncombi) : 1.0));
+      });
+}
+
+/* parallelEval right after an asynchronous combination has to write the solution of this
+ * combination, like after a synchronous one, not the one of the combination before
+ */
+void checkAsyncParallelEval(const CombiSetup& setup) {
+  CombiSetup changing(setup);
+  changing.advance = true;
+  changing.perturbation = 0.5;
+
+  std::vector<CombiDataType> results[2];
+
+  for (int async = 0; async < 2; ++async) {
+    runCombination(changing, nullptr,
+                   [&changing, &results, async](ProcessManager& manager,
+                                                const ProcessGroupManagerContainer&) {
+                     for (size_t it = 0; it + 1 < changing.ncombi; ++it) {
+                       manager.combine();
+                       manager.runnext();
+                     }
+
+                     if (async)
+                       manager.combineAsync();
+                     else
+                       manager.combine();
+
+                     std::string filename = "test_async_eval_" + std::to_string(async) + "_";
+                     results[async] = parallelEvalCombined(manager, filename);
+                   });
+  }
+
+  checkSameResult(results[1], results[0]);
+}
+
+/* tasks with their own parallelization are redistributed to the common one of the sparse
+ * grids in the combination. the result, evaluated on the manager and with parallelEval,
+ * has to be the same as with the common parallelization in all tasks
+ */
+void checkOwnParallelization(const CombiSetup& setup) {
+  CombiSetup changing(setup);
+  changing.advance = true;
+  changing.perturbation = 0.5;
+
+  std::vector<CombiDataType> results[2];
+  std::vector<CombiDataType> evalResults[2];
+
+  for (int own = 0; own < 2; ++own) {
+    changing.ownParallelization = (own == 1);
+
+    runCombination(changing, nullptr,
+                   [&changing, &results, &evalResults, own](
+                       ProcessManager& manager, const ProcessGroupManagerContainer&) {
+                     runLoop(manager, CombiLoop::RUNNEXT_AND_COMBINE, changing.ncombi);
+                     results[own] = evalCombined(manager);
+
+                     std::string filename = "test_own_p_" + std::to_string(own) + "_";
+                     evalResults[own] = parallelEvalCombined(manager, filename);
+                   });
+  }
+
+  checkSameResult(results[1], results[0]);
+  checkSameResult(evalResults[1], evalResults[0]);
+}
+
+/* combination right after the runs of each group. except for the first run, all runs
+ * start from the combination of the previous one
+ */
+void checkRunnextAndCombine(const CombiSetup& setup, const Configure& configure = nullptr) {
+  runCombination(
+      setup, configure,
+      [&setup](ProcessManager& manager, const ProcessGroupManagerContainer&) {
+        runLoop(manager, CombiLoop::RUNNEXT_AND_COMBINE, setup.ncombi);
+
+        real factor = setup.advance ? real(setup.ncombi + 1) : 1.0;
+        BOOST_TEST(std::abs(getMidpoint(evalCombined(manager))) == combinedValue * factor);
+      },
+      [&setup](const TaskContainer& tasks) {
+        forEachRunTask(tasks, [&setup](const TaskConst& task) {
+          const std::vector<CombiDataType>& startValues = task.getStartValues();
+
+          const std::vector<CombiDataType>& endValues = task.getEndValues();
+
+          BOOST_REQUIRE_EQUAL(startValues.size(), setup.ncombi + 1);
+          BOOST_CHECK_EQUAL(countCombinedRuns(task), int(setup.ncombi) - 1);
+
+          // the first combination follows the second run
+          BOOST_CHECK_EQUAL(startValues[1], endValues[0]);
+
+          for (size_t i = 2; i < startValues.size(); ++i) {
+            real factor = setup.advance ? real(i) : 1.0;
+            BOOST_TEST(std::abs(startValues[i]) == combinedValue * factor);
+          }
+        });
+
+        real factor = setup.advance ? real(setup.ncombi + 1) : 1.0;
+        checkGridValues(tasks, combinedValue * factor);
+      });
+}
+
+/* combination loop without the manager, numCombinedRuns runs start from a combined
+ * solution. with a change tolerance the interval between the combinations adapts
+ */
+void checkAutonomous(const CombiSetup& setup, int runsPerCombination,
+                     real combinationChangeTolerance, int numCombinedRuns) {
+  runCombination(
+      setup,
+      [combinationChangeTolerance](CombiParameters& params) {
+        if (combinationChangeTolerance > 0.0)
+          params.setAdaptiveCombination(combinationChangeTolerance, 1, 4);
+      },
+      [&setup, runsPerCombination](ProcessManager& manager, const ProcessGroupManagerContainer&) {
+        manager.runAutonomous(int(setup.ncombi), runsPerCombination);
+
+        // the number of runs is fixed, the last one is followed by a combination
+        real numRuns = real(setup.ncombi * runsPerCombination);
+        real factor = setup.advance ? numRuns + 1.0 : 1.0;
+        BOOST_TEST(std::abs(getMidpoint(evalCombined(manager))) == combinedValue * factor);
+      },
+      [&setup, numCombinedRuns](const TaskContainer& tasks) {
+        forEachRunTask(tasks, [&setup, numCombinedRuns](const TaskConst& task) {
+          const std::vector<CombiDataType>& startValues = task.getStartValues();
+          const std::vector<CombiDataType>& endValues = task.getEndValues();
+
+          BOOST_CHECK_EQUAL(countCombinedRuns(task), numCombinedRuns);
+
+          for (size_t i = 1; i < startValues.size(); ++i) {
+            if (std::abs(startValues[i] - endValues[i - 1]) < 1e-9) continue;
+
+            // the combination of the previous run
+            real factor = setup.advance ? real(i) : 1.0;
+            BOOST_TEST(std::abs(startValues[i]) == combinedValue * factor);
+          }
+        });
+      });
+}
+
+/* migration of tasks between groups of the same size, by rebalancing after the
+ * combinations of loop and explicitly to the last group. the migrated grids keep the
+ * combined solution
+ */
+void checkMigration(const CombiSetup& setup, CombiLoop loop) {
+  runCombination(
+      setup, [](CombiParameters& params) { params.setTaskMigration(true, 0.0); },
+      [&setup, loop](ProcessManager& manager, const ProcessGroupManagerContainer& pgroups) {
+        runLoop(manager, loop, setup.ncombi);
+
+        const std::vector<size_t>& groupSizes = setup.groupSizes;
+        size_t last = groupSizes.size() - 1;
+        Task* migrated = nullptr;
+
+        for (size_t i = 0; i < last && migrated == nullptr; ++i) {
+          const TaskContainer& groupTasks = pgroups[i]->getTaskContainer();
+
+          if (groupSizes[i] == groupSizes[last] && !groupTasks.empty()) migrated = groupTasks[0];
+        }
+        BOOST_REQUIRE(migrated != nullptr);
+
+        manager.migrateTask(migrated->getID(), last);
+
+        const TaskContainer& lastTasks = pgroups[last]->getTaskContainer();
+        BOOST_CHECK(std::find(lastTasks.begin(), lastTasks.end(), migrated) != lastTasks.end());
+
+        BOOST_TEST(std::abs(getMidpoint(evalCombined(manager))) == combinedValue);
+      },
+      [](const TaskContainer& tasks) { checkGridValues(tasks, combinedValue); });
+}
+
+/* migration while an asynchronous combination is pending. both groups apply it first, so
+ * the migrated grid holds the combined solution as well
+ */
+void checkMigrationAsync(const CombiSetup& setup) {
+  runCombination(
+      setup, nullptr,
+      [&setup](ProcessManager& manager, const ProcessGroupManagerContainer& pgroups) {
+        manager.combineAsync();
+
+        const TaskContainer& firstTasks = pgroups[0]->getTaskContainer();
+        BOOST_REQUIRE(!firstTasks.empty());
+        manager.migrateTask(firstTasks[0]->getID(), setup.groupSizes.size() - 1);
+
+        BOOST_TEST(std::abs(getMidpoint(evalCombined(manager))) == combinedValue);
+      },
+      [](const TaskContainer& tasks) { checkGridValues(tasks, combinedValue); });
+}
+
+/* tasks are only placed on groups where their grids and the temporary grid of the
+ * combination fit into memoryPerProcess. tasks with more than maxPoints points do not fit
+ * on the groups which are larger than the smallest one
+ */
+void checkMemoryPerProcess(const CombiSetup& setup, size_t memoryPerProcess, size_t maxPoints) {
+  runCombination(
+      setup, [memoryPerProcess](CombiParameters& params) {
+        params.setMemoryPerProcess(memoryPerProcess);
+      },
+      [&setup, maxPoints](ProcessManager& manager, const ProcessGroupManagerContainer& pgroups) {
+        const std::vector<size_t>& groupSizes = setup.groupSizes;
+        size_t smallest = *std::min_element(groupSizes.begin(), groupSizes.end());
+
+        for (size_t i = 0; i < pgroups.size(); ++i) {
+          if (groupSizes[i] == smallest) continue;
+
+          for (Task* t : pgroups[i]->getTaskContainer()) BOOST_CHECK(t->getNumPoints() <= maxPoints);
+        }
+
+        runLoop(manager, CombiLoop::COMBINE, setup.ncombi);
+
+        BOOST_TEST(std::abs(getMidpoint(evalCombined(manager))) == combinedValue);
+      },
+      [](const TaskContainer& tasks) { checkGridValues(tasks, combinedValue); });
+}
+
+/* the groups of each size are balanced on their own. the first group is the most loaded
+ * one, but there is no other group of its size. all tasks of the last group are moved to
+ * the second one, so rebalancing has to move tasks back to the last group
+ */
+void checkRebalanceSizeClasses() {
+  TaskConst::slowGroupSize() = 3;
+
+  runCombination(
+      CombiSetup(std::vector<size_t>{3, 2, 2}), nullptr,
+      [](ProcessManager& manager, const ProcessGroupManagerContainer& pgroups) {
+        size_t numFirstTasks = pgroups[0]->getTaskContainer().size();
+        TaskContainer lastTasks(pgroups[2]->getTaskContainer());
+
+        for (Task* t : lastTasks) manager.migrateTask(t->getID(), 1);
+
+        BOOST_CHECK(manager.rebalance(0.0) > 0);
+        BOOST_CHECK(!pgroups[2]->getTaskContainer().empty());
+        BOOST_CHECK_EQUAL(pgroups[0]->getTaskContainer().size(), numFirstTasks);
+
+        manager.combine();
+
+        BOOST_TEST(std::abs(getMidpoint(evalCombined(manager))) == combinedValue);
+      },
+      [](const TaskContainer& tasks) { checkGridValues(tasks, combinedValue); });
+
+  TaskConst::slowGroupSize() = 0;
+}
+
+/* status and durations of the loop are collected by sub-managers */
+void checkSubmanagers(const CombiSetup& setup, CombiLoop loop) {
+  runCombination(
+      setup, nullptr,
+      [&setup, loop](ProcessManager& manager, const ProcessGroupManagerContainer& pgroups) {
+        runLoop(manager, loop, setup.ncombi);
+
+        for (auto g : pgroups) BOOST_CHECK_EQUAL(g->getStatus(), PROCESS_GROUP_WAIT);
+
+        BOOST_TEST(std::abs(getMidpoint(evalCombined(manager))) == combinedValue);
+      },
+      [](const TaskContainer& tasks) { checkGridValues(tasks, combinedValue); });
+}
+
+Configure setTaskSubgroups(size_t subgroupSize, size_t subgroupMaxPoints) {
+  return [subgroupSize, subgroupMaxPoints](CombiParameters& params) {
+    params.setTaskSubgroups(subgroupSize, subgroupMaxPoints);
+  };
+}
+
+/* small tasks (with at most subgroupMaxPoints points) run on subgroups of subgroupSize
+ * processes of the groups which are larger than that. the last subgroup of a group may be
+ * smaller
+ */
+void checkSubgroups(const CombiSetup& setup, size_t subgroupSize, size_t subgroupMaxPoints) {
+  checkRunnextAndCombine(setup, setTaskSubgroups(subgroupSize, subgroupMaxPoints));
+
+  runCombination(
+      setup, setTaskSubgroups(subgroupSize, subgroupMaxPoints),
+      [](ProcessManager& manager, const ProcessGroupManagerContainer&) { manager.combine(); },
+      [subgroupSize, subgroupMaxPoints](const TaskContainer& tasks) {
+        size_t groupSize = getCommSize(theMPISystem()->getLocalComm());
+        size_t localRank = theMPISystem()->getLocalRank();
+        size_t ownSubgroupSize = groupSize;
+
+        if (subgroupSize < groupSize) {
+          size_t first = localRank / subgroupSize * subgroupSize;
+          ownSubgroupSize = std::min(subgroupSize, groupSize - first);
+        }
+
+        for (Task* t : tasks) {
+          const TaskConst& task = dynamic_cast<const TaskConst&>(*t);
+          bool small = t->getNumPoints() <= subgroupMaxPoints;
+
+          for (DistributedFullGrid<CombiDataType>* dfg : task.getGrids()) {
+            size_t taskSize = getCommSize(dfg->getCommunicator());
+            BOOST_CHECK_EQUAL(taskSize, small ? ownSubgroupSize : groupSize);
+          }
+        }
+      });
+}
+
+/* tasks initialized on a helper thread while the previous one runs. this needs
+ * MPI_THREAD_MULTIPLE and is not done for the small tasks on subgroups. the tests
+ * initialize MPI without threads, so usually the fallback is checked
+ */
+void checkPrefetch(const CombiSetup& setup, size_t subgroupSize, size_t subgroupMaxPoints) {
+  runCombination(
+      setup,
+      [subgroupSize, subgroupMaxPoints](CombiParameters& params) {
+        params.setPrefetchTaskInit(true);
+        params.setTaskSubgroups(subgroupSize, subgroupMaxPoints);
+      },
+      [&setup](ProcessManager& manager, const ProcessGroupManagerContainer&) {
+        runLoop(manager, CombiLoop::COMBINE, setup.ncombi);
+
+        BOOST_TEST(std::abs(getMidpoint(evalCombined(manager))) == combinedValue);
+      },
+      [subgroupSize, subgroupMaxPoints](const TaskContainer& tasks) {
+        int provided;
+        MPI_Query_thread(&provided);
+        bool prefetch = provided == MPI_THREAD_MULTIPLE;
+
+        size_t groupSize = getCommSize(theMPISystem()->getLocalComm());
+        bool subgroups = subgroupSize > 0 && subgroupSize < groupSize;
+
+        for (Task* t : tasks) {
+          const TaskConst& task = dynamic_cast<const TaskConst&>(*t);
+
+          // small tasks of other subgroups are not initialized on this process
+          if (task.getInitThread() == std::thread::id()) continue;
+
+          bool subgroupTask = subgroups && t->getNumPoints() <= subgroupMaxPoints;
+          BOOST_CHECK_EQUAL(task.getInitThread() != std::this_thread::get_id(),
+                            prefetch && !subgroupTask);
+        }
+
+        checkGridValues(tasks, combinedValue);
+      });
+}
+
+/* write a checkpoint after the first combination and restart from it with a new
+ * manager and new workers, which do not create the tasks themselves. if restartGroupSizes
+ * are given, the restart is done with these groups and has to be rejected
+ */
+void checkCheckpoint(size_t ngroup, size_t nprocs, size_t subgroupSize = 0, bool delta = false,
+                     const std::vector<size_t>& restartGroupSizes = {}) {
+  size_t size = ngroup * nprocs + 1;
+  BOOST_REQUIRE(TestHelper::checkNumMPIProcsAvailable(size));
+
+  CommunicatorType comm = TestHelper::getComm(size);
+  if (comm == MPI_COMM_NULL) {
+    return;
+  }
+
+  combigrid::Stats::initialize();
+
+  theMPISystem()->initWorldReusable(comm, ngroup, nprocs);
+
+  const std::string prefix = "test_checkpoint";
+  std::vector<int> taskIDs;
+
+  for (int restart = 0; restart < 2; ++restart) {
+    if (restart && !restartGroupSizes.empty()) {
+      theMPISystem()->initWorldReusable(comm, restartGroupSizes);
+    }
+
+    WORLD_MANAGER_EXCLUSIVE_SECTION {
+      ProcessGroupManagerContainer pgroups;
+      for (size_t i = 0; i < ngroup; ++i) {
+        pgroups.emplace_back(std::make_shared<ProcessGroupManager>(RankType(i)));
+      }
+
+      auto loadmodel = std::unique_ptr<LoadModel>(new LinearLoadModel());
+
+      DimType dim = 2;
+      LevelVector lmin(dim, 2), lmax(dim, 4), leval(dim, 4);
+      size_t ncombi = 3;
+      std::vector<bool> boundary(dim, true);
+
+      CombiMinMaxScheme combischeme(dim, lmin, lmax);
+      combischeme.createAdaptiveCombischeme();
+      std::vector<LevelVector> levels = combischeme.getCombiSpaces();
+      std::vector<combigrid::real> coeffs = combischeme.getCoeffs();
+
+      TaskContainer tasks;
+      if (!restart) {
+        for (size_t i = 0; i < levels.size(); i++) {
+          Task* t = new TaskConst(levels[i], boundary, coeffs[i], loadmodel.get());
+          tasks.push_back(t);
+          taskIDs.push_back(t->getID());
+        }
+      }
+
+      CombiParameters params(dim, lmin, lmax, boundary, levels, coeffs, taskIDs, ncombi);
+      params.setParallelization({static_cast<IndexType>(nprocs), 1});
+      params.setDeltaCombination(delta, 1e-12);
+      params.setTaskSubgroups(subgroupSize, 1000);
+
+      ProcessManager manager(pgroups, tasks, params, std::move(loadmodel));
+
+      FullGrid<CombiDataType> fg_eval(dim, leval, boundary);
+
+      if (!restart) {
+        manager.updateCombiParameters();
+        manager.runfirst();
+        manager.combine();
+        BOOST_CHECK(manager.writeCheckpoint(prefix));
+
+        // the temporary files replaced the checkpoint
+        BOOST_CHECK(!std::ifstream(prefix + "_manager.dcg.tmp").good());
+        BOOST_CHECK(!std::ifstream(prefix + "_group0.dcg.tmp").good());
+      } else if (!restartGroupSizes.empty()) {
+        // the sparse grids of the checkpoint are decomposed for the groups which wrote them
+        BOOST_CHECK(!manager.restart(prefix));
+
+        std::remove((prefix + "_manager.dcg").c_str());
+        for (size_t i = 0; i < ngroup; ++i) {
+          std::remove((prefix + "_group" + std::to_string(i) + ".dcg").c_str());
+        }
+      } else {
+        // a missing checkpoint is reported without changing the state
+        BOOST_CHECK(!manager.restart(prefix + "_missing"));
+        BOOST_CHECK(manager.restart(prefix));
+        BOOST_CHECK_EQUAL(tasks.size(), levels.size());
+
+        // the grids hold the combined solution of the checkpoint
+        manager.gridEval(fg_eval);
+        BOOST_TEST(fabs(fg_eval.getData()[fg_eval.getNrElements() / 2]) == 1.333333333);
+
+        // the evaluation adds to the grid on the manager, so a new one is needed
+        manager.combine();
+        FullGrid<CombiDataType> fg_combined(dim, leval, boundary);
+        manager.gridEval(fg_combined);
+        BOOST_TEST(fabs(fg_combined.getData()[fg_combined.getNrElements() / 2]) == 1.333333333);
+
+        std::remove((prefix + "_manager.dcg").c_str());
+        for (size_t i = 0; i < ngroup; ++i) {
+          std::remove((prefix + "_group" + std::to_string(i) + ".dcg").c_str());
+        }
+      }
+
+      manager.exit();
+    }
+    else {
+      ProcessGroupWorker pgroup;
+      SignalType signal = -1;
+      while (signal != EXIT) signal = pgroup.wait();
+    }
   }
 
   combigrid::Stats::finalize();
@@ -217,14 +989,384 @@ BOOST_AUTO_TEST_SUITE(reduce)
 
 BOOST_AUTO_TEST_CASE(test_1, *boost::unit_test::tolerance(TestHelper::higherTolerance) *
                                  boost::unit_test::timeout(60)) {
-  std::cout << "reduce/test_1"<< std::endl;
-  checkCombine(1,1);
+  std::cout << "reduce/test_1" << std::endl;
+  checkCombine(CombiSetup(1, 1));
 }
 
 BOOST_AUTO_TEST_CASE(test_2, *boost::unit_test::tolerance(TestHelper::higherTolerance) *
                                  boost::unit_test::timeout(60)) {
-  std::cout << "reduce/test_2"<< std::endl;
-  checkCombine(1,2);
+  std::cout << "reduce/test_2" << std::endl;
+  checkCombine(CombiSetup(1, 2));
+}
+
+BOOST_AUTO_TEST_CASE(test_3, *boost::unit_test::tolerance(TestHelper::higherTolerance) *
+                                 boost::unit_test::timeout(60)) {
+  std::cout << "reduce/test_3" << std::endl;
+  checkReduceType(CombiSetup(2, 1), GLOBAL_REDUCE_REDUCE_SCATTER);
+}
+
+BOOST_AUTO_TEST_CASE(test_4, *boost::unit_test::tolerance(TestHelper::higherTolerance) *
+                                 boost::unit_test::timeout(60)) {
+  std::cout << "reduce/test_4" << std::endl;
+  checkReduceType(CombiSetup(2, 2), GLOBAL_REDUCE_REDUCE_SCATTER);
+}
+
+BOOST_AUTO_TEST_CASE(test_5, *boost::unit_test::tolerance(TestHelper::higherTolerance) *
+                                 boost::unit_test::timeout(60)) {
+  std::cout << "reduce/test_5" << std::endl;
+  checkReduceType(CombiSetup(3, 2), GLOBAL_REDUCE_HIERARCHICAL);
+}
+
+BOOST_AUTO_TEST_CASE(test_6, *boost::unit_test::tolerance(TestHelper::higherTolerance) *
+                                 boost::unit_test::timeout(60)) {
+  std::cout << "reduce/test_6" << std::endl;
+  checkAsync(CombiSetup(2, 2));
+  // the solution changes, so the lagged correction differs from the combined solution
+  CombiSetup lagged(2, 2);
+  lagged.advance = true;
+  lagged.ncombi = 3;
+  checkAsync(lagged);
+  // the evaluation applies a pending asynchronous combination, also the first one
+  CombiSetup eval(2, 2);
+  eval.ncombi = 1;
+  checkAsyncParallelEval(eval);
+  eval.ncombi = 2;
+  checkAsyncParallelEval(eval);
+}
+
+BOOST_AUTO_TEST_CASE(test_7, *boost::unit_test::tolerance(TestHelper::higherTolerance) *
+                                 boost::unit_test::timeout(60)) {
+  std::cout << "reduce/test_7" << std::endl;
+  checkCombine(CombiSetup(2, 2),
+               [](CombiParameters& params) { params.setDeltaCombination(true, 1e-12); });
+
+  // a changing solution, compared with the plain allreduce. with a tolerance of 1e-3, the
+  // subspaces with boundary points (e.g. level (1, 1), which also contains the midpoint)
+  // always change by more, because of the constant part. the other subspaces only carry
+  // the perturbation: with 1e-5 sin(pi x) sin(pi y) times at most 3 * 2 their changes
+  // stay below 1e-3 and they are never exchanged, with 1e-2 the coarse ones are
+  for (real perturbation : {1e-5, 1e-2}) {
+    CombiSetup changing(2, 2);
+    changing.advance = true;
+    changing.perturbation = perturbation;
+    std::vector<CombiDataType> exactResult, deltaResult;
+
+    runCombination(changing, nullptr,
+                   [&exactResult](ProcessManager& manager, const ProcessGroupManagerContainer&) {
+                     runLoop(manager, CombiLoop::RUNNEXT_AND_COMBINE, 2);
+                     exactResult = evalCombined(manager);
+                   });
+    runCombination(changing,
+                   [](CombiParameters& params) { params.setDeltaCombination(true, 1e-3); },
+                   [&deltaResult](ProcessManager& manager, const ProcessGroupManagerContainer&) {
+                     runLoop(manager, CombiLoop::RUNNEXT_AND_COMBINE, 2);
+                     deltaResult = evalCombined(manager);
+                   });
+
+    // only the manager evaluates the combined solution
+    BOOST_REQUIRE_EQUAL(deltaResult.size(), exactResult.size());
+
+    if (deltaResult.empty()) continue;
+
+    // the changes below the tolerance are missing, but each surplus is off by at most
+    // ngroup * tol and a value sums up at most 70 surpluses of the component grids
+    real maxError = getMaxDifference(deltaResult, exactResult);
+    BOOST_CHECK(maxError > 0.0);
+    BOOST_CHECK(maxError <= 70 * 2 * 1e-3);
+
+    // the midpoint only has a surplus in the exchanged subspace of level (1, 1)
+    BOOST_CHECK(std::abs(getMidpoint(deltaResult) - getMidpoint(exactResult)) < 1e-12);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_8, *boost::unit_test::tolerance(TestHelper::higherTolerance) *
+                                 boost::unit_test::timeout(60)) {
+  std::cout << "reduce/test_8" << std::endl;
+  // use tiny chunks to run through the code paths for messages with more than
+  // INT_MAX elements
+  CombiSetup changing(2, 2);
+  changing.ncombi = 4;
+  std::vector<CombiDataType> reference = combineChanging(changing, nullptr);
+
+  size_t maxChunkSize = MPILargeCount::getMaxChunkSize();
+  MPILargeCount::getMaxChunkSize() = 5;
+  checkCombine(CombiSetup(2, 2));
+  checkCombine(CombiSetup(2, 2), setReduceType(GLOBAL_REDUCE_REDUCE_SCATTER));
+  // the chunks are reduced in the same order as the whole message
+  checkSameResult(combineChanging(changing, nullptr), reference);
+  checkSameResult(combineChanging(changing, setReduceType(GLOBAL_REDUCE_REDUCE_SCATTER)),
+                  reference);
+  MPILargeCount::getMaxChunkSize() = maxChunkSize;
+}
+
+BOOST_AUTO_TEST_CASE(test_9, *boost::unit_test::tolerance(TestHelper::higherTolerance) *
+                                 boost::unit_test::timeout(60)) {
+  std::cout << "reduce/test_9" << std::endl;
+  // several grids per task are reduced concurrently
+  CombiSetup setup(2, 2);
+  setup.numGrids = 3;
+  checkCombine(setup);
+  checkAsync(setup);
+}
+
+BOOST_AUTO_TEST_CASE(test_10, *boost::unit_test::tolerance(TestHelper::higherTolerance) *
+                                  boost::unit_test::timeout(60)) {
+  std::cout << "reduce/test_10" << std::endl;
+  checkCombine(CombiSetup(2, 2), setReduceType(GLOBAL_REDUCE_AUTOTUNE));
+}
+
+BOOST_AUTO_TEST_CASE(test_11, *boost::unit_test::tolerance(TestHelper::higherTolerance) *
+                                  boost::unit_test::timeout(60)) {
+  std::cout << "reduce/test_11" << std::endl;
+  // the four combinations of the comparison use all copies of the window
+  checkReduceType(CombiSetup(2, 2), GLOBAL_REDUCE_RMA);
+  checkReduceType(CombiSetup(3, 1), GLOBAL_REDUCE_RMA);
+}
+
+BOOST_AUTO_TEST_CASE(test_12, *boost::unit_test::tolerance(TestHelper::higherTolerance) *
+                                  boost::unit_test::timeout(60)) {
+  std::cout << "reduce/test_12" << std::endl;
+  Configure reducedPrecision = [](CombiParameters& params) {
+    params.setReducedPrecisionReduce(true, 6);
+  };
+  checkCombine(CombiSetup(2, 2), reducedPrecision);
+  CombiSetup threeGroups(3, 1);
+  threeGroups.numGrids = 2;
+  checkCombine(threeGroups, reducedPrecision);
+
+  // the fine surpluses are not zero, so the result differs from the one of the full
+  // precision allreduce. each surplus is off by at most ngroup + 1 roundings to float of
+  // contributions below 4, a value of the combined solution sums up at most 70 surpluses
+  // of the component grids
+  CombiSetup perturbed(2, 2);
+  perturbed.perturbation = 1.0;
+  std::vector<CombiDataType> exactResult, reducedResult;
+
+  runCombination(perturbed, nullptr,
+                 [&exactResult](ProcessManager& manager, const ProcessGroupManagerContainer&) {
+                   runLoop(manager, CombiLoop::COMBINE, 2);
+                   exactResult = evalCombined(manager);
+                 });
+  runCombination(perturbed, reducedPrecision,
+                 [&reducedResult](ProcessManager& manager, const ProcessGroupManagerContainer&) {
+                   runLoop(manager, CombiLoop::COMBINE, 2);
+                   reducedResult = evalCombined(manager);
+                 });
+
+  // only the manager evaluates the combined solution
+  BOOST_REQUIRE_EQUAL(reducedResult.size(), exactResult.size());
+
+  if (!exactResult.empty()) {
+    real maxError = getMaxDifference(reducedResult, exactResult);
+    BOOST_CHECK(maxError > 0.0);
+    BOOST_CHECK(maxError < 70 * 3 * 4.0 * std::numeric_limits<float>::epsilon());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_13, *boost::unit_test::tolerance(TestHelper::higherTolerance) *
+                                  boost::unit_test::timeout(60)) {
+  std::cout << "reduce/test_13" << std::endl;
+  checkMigration(CombiSetup(2, 2), CombiLoop::COMBINE);
+  CombiSetup threeGroups(3, 1);
+  threeGroups.numGrids = 2;
+  checkMigration(threeGroups, CombiLoop::COMBINE);
+  checkMigrationAsync(CombiSetup(2, 2));
+}
+
+// the fault tolerance requires groups of equal size
+BOOST_AUTO_TEST_CASE(test_14, *boost::unit_test::tolerance(TestHelper::higherTolerance) *
+                                  boost::unit_test::timeout(60) *
+                                  boost::unit_test::precondition(WithoutFaultTolerance())) {
+  std::cout << "reduce/test_14" << std::endl;
+  // process groups of different size
+  checkCombine(CombiSetup(std::vector<size_t>{1, 2}));
+  CombiSetup threeGroups(std::vector<size_t>{2, 3, 2});
+  threeGroups.numGrids = 2;
+  checkAsync(threeGroups);
+  // the ranks >= 2 of the larger groups take part in the migration as well
+  checkMigration(CombiSetup(std::vector<size_t>{3, 2, 3}), CombiLoop::COMBINE);
+  checkRebalanceSizeClasses();
+  // the largest grid (85 points) and its temporary copy on the two first processes of
+  // the larger group fit into the memory of a process
+  checkCombine(CombiSetup(std::vector<size_t>{2, 3}),
+               [](CombiParameters& params) { params.setMemoryPerProcess(1024); });
+  // with half of the memory the temporary grids of the grids with 81 and 85 points do
+  // not fit on the larger group anymore
+  checkMemoryPerProcess(CombiSetup(std::vector<size_t>{2, 3}), 512, 45);
+}
+
+BOOST_AUTO_TEST_CASE(test_15, *boost::unit_test::tolerance(TestHelper::higherTolerance) *
+                                  boost::unit_test::timeout(60)) {
+  std::cout << "reduce/test_15" << std::endl;
+  // small tasks on subgroups of the process groups
+  checkSubgroups(CombiSetup(2, 4), 2, 50);
+  CombiSetup twoGrids(2, 4);
+  twoGrids.numGrids = 2;
+  checkAsync(twoGrids, setTaskSubgroups(2, 1000));
+  checkSubgroups(CombiSetup(2, 4), 3, 1000);
+}
+
+BOOST_AUTO_TEST_CASE(test_16, *boost::unit_test::tolerance(TestHelper::higherTolerance) *
+                                  boost::unit_test::timeout(60)) {
+  std::cout << "reduce/test_16" << std::endl;
+  // combination right after the tasks of a group are finished. with fault tolerance,
+  // the manager checks the status of the groups in between
+  checkRunnextAndCombine(CombiSetup(2, 2));
+  CombiSetup threeGroups(3, 1);
+  threeGroups.numGrids = 2;
+  checkMigration(threeGroups, CombiLoop::RUNNEXT_AND_COMBINE);
+  CombiSetup changing(2, 2);
+  changing.advance = true;
+  changing.ncombi = 3;
+  checkRunnextAndCombine(changing);
+}
+
+BOOST_AUTO_TEST_CASE(test_17, *boost::unit_test::tolerance(TestHelper::higherTolerance) *
+                                  boost::unit_test::timeout(60)) {
+  std::cout << "reduce/test_17" << std::endl;
+  // combination loop without the manager, the second run starts from the first
+  // combination
+  checkAutonomous(CombiSetup(2, 2), 1, 0.0, 1);
+  CombiSetup threeGroups(3, 1);
+  threeGroups.numGrids = 2;
+  checkMigration(threeGroups, CombiLoop::AUTONOMOUS);
+}
+
+// the fault tolerance does not support sub-managers
+BOOST_AUTO_TEST_CASE(test_18, *boost::unit_test::tolerance(TestHelper::higherTolerance) *
+                                  boost::unit_test::timeout(60) *
+                                  boost::unit_test::precondition(WithoutFaultTolerance())) {
+  std::cout << "reduce/test_18" << std::endl;
+  // status and durations are collected by sub-managers
+  CombiSetup setup(4, 2);
+  setup.groupsPerSubmanager = 2;
+  checkSubmanagers(setup, CombiLoop::RUNNEXT_AND_COMBINE);
+  CombiSetup eightGroups(8, 1);
+  eightGroups.groupsPerSubmanager = 3;
+  checkSubmanagers(eightGroups, CombiLoop::COMBINE_ASYNC);
+  checkMigration(setup, CombiLoop::AUTONOMOUS);
+}
+
+// the fault tolerance does not support the adaptive combination interval
+BOOST_AUTO_TEST_CASE(test_19, *boost::unit_test::tolerance(TestHelper::higherTolerance) *
+                                  boost::unit_test::timeout(60) *
+                                  boost::unit_test::precondition(WithoutFaultTolerance())) {
+  std::cout << "reduce/test_19" << std::endl;
+  // combination loop with adaptive combination interval. the solution does not change,
+  // so the interval grows to 2 after the second combination and the third run is not
+  // followed by a combination
+  CombiSetup setup(2, 2);
+  setup.ncombi = 4;
+  checkAutonomous(setup, 1, 1e-3, 2);
+  // the solution changes in every run, so the interval shrinks to 2 after the second
+  // combination and to 1 after the third one. the twelve runs are combined five times,
+  // after the runs 4, 8, 10, 11 and 12
+  CombiSetup changing(2, 2);
+  changing.advance = true;
+  changing.ncombi = 3;
+  checkAutonomous(changing, 4, 1e-3, 4);
+  // the starting interval is limited to the maximum of 4 runs per combination
+  changing.ncombi = 1;
+  checkAutonomous(changing, 8, 1e-3, 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_20, *boost::unit_test::tolerance(TestHelper::higherTolerance) *
+                                  boost::unit_test::timeout(60)) {
+  std::cout << "reduce/test_20" << std::endl;
+  // tasks initialized on a helper thread while the previous task runs
+  checkPrefetch(CombiSetup(2, 2), 0, 0);
+  CombiSetup subgroups(2, 4);
+  subgroups.numGrids = 2;
+  checkPrefetch(subgroups, 2, 50);
+}
+
+// the fault tolerance requires groups of equal size
+BOOST_AUTO_TEST_CASE(test_21, *boost::unit_test::tolerance(TestHelper::higherTolerance) *
+                                  boost::unit_test::timeout(60) *
+                                  boost::unit_test::precondition(WithoutFaultTolerance())) {
+  std::cout << "reduce/test_21" << std::endl;
+  // small tasks on subgroups of groups which are larger than the smallest group. the
+  // processes of the larger group outside of the subgroup hold no grid of such a task
+  checkSubgroups(CombiSetup(std::vector<size_t>{2, 4}), 2, 50);
+  CombiSetup twoGrids(std::vector<size_t>{2, 3});
+  twoGrids.numGrids = 2;
+  checkSubgroups(twoGrids, 2, 50);
+}
+
+// the fault tolerance requires groups of equal size and does not support sub-managers
+BOOST_AUTO_TEST_CASE(test_22, *boost::unit_test::tolerance(TestHelper::higherTolerance) *
+                                  boost::unit_test::timeout(60) *
+                                  boost::unit_test::precondition(WithoutFaultTolerance())) {
+  std::cout << "reduce/test_22" << std::endl;
+  // adaptive combination interval on groups of different size with sub-managers
+  CombiSetup setup(std::vector<size_t>{2, 3});
+  setup.groupsPerSubmanager = 2;
+  setup.numGrids = 2;
+  setup.ncombi = 4;
+  checkAutonomous(setup, 1, 1e-3, 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_23, *boost::unit_test::tolerance(TestHelper::higherTolerance) *
+                                  boost::unit_test::timeout(60)) {
+  std::cout << "reduce/test_23" << std::endl;
+  // combination loop with several runs per combination, with fault tolerance the
+  // manager sends the single steps. the combinations follow the runs 2, 4 and 6, so
+  // the runs 3 and 5 start from a combined solution
+  CombiSetup setup(2, 2);
+  setup.advance = true;
+  setup.ncombi = 3;
+  checkAutonomous(setup, 2, 0.0, 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_24, *boost::unit_test::tolerance(TestHelper::higherTolerance) *
+                                  boost::unit_test::timeout(60) *
+                                  boost::unit_test::precondition(WithoutUniformDecomposition())) {
+  std::cout << "reduce/test_24" << std::endl;
+  // tasks with a non-uniform decomposition, combined and evaluated with parallelEval. the
+  // group sizes are powers of two, so the decompositions of all levels are nested
+  checkOwnParallelization(CombiSetup(2, 2));
+  CombiSetup twoGrids(2, 4);
+  twoGrids.numGrids = 2;
+  checkOwnParallelization(twoGrids);
+}
+
+BOOST_AUTO_TEST_CASE(test_checkpoint,
+                     *boost::unit_test::tolerance(TestHelper::higherTolerance) *
+                         boost::unit_test::timeout(60)) {
+  checkCheckpoint(2, 2);
+  checkCheckpoint(2, 4, 2);
+  checkCheckpoint(4, 2, 0, true);
+  // groups of different sizes are not available with fault tolerance
+  if (!ENABLE_FT) checkCheckpoint(2, 2, 0, false, {1, 3});
+}
+
+BOOST_AUTO_TEST_CASE(test_autotuner, *boost::unit_test::timeout(60)) {
+  int rank = getCommRank(MPI_COMM_WORLD);
+  std::string file = "test_autotuner_" + std::to_string(rank) + ".txt";
+  std::remove(file.c_str());
+
+  std::string key = GlobalReduceAutotuner::getKey({2, 2}, {4, 4}, {2, 1}, 2);
+  std::string otherKey = GlobalReduceAutotuner::getKey({2, 2}, {4, 4}, {1, 2}, 2);
+  {
+    GlobalReduceAutotuner tuner(file);
+    // all candidates are measured once, the fastest one wins
+    double times[] = {3.0, 1.0};
+    for (double time : times) {
+      BOOST_CHECK(!tuner.isTuned(key));
+      GlobalReduceType type = tuner.select(key);
+      tuner.record(key, type, time, true);
+    }
+    BOOST_CHECK(tuner.isTuned(key));
+    BOOST_CHECK_EQUAL(tuner.select(key), tuner.getCandidates()[1]);
+    BOOST_CHECK(!tuner.isTuned(otherKey));
+  }
+  // the winner is read from the tuning file
+  GlobalReduceAutotuner tuner(file);
+  BOOST_CHECK(tuner.isTuned(key));
+  BOOST_CHECK_EQUAL(tuner.select(key), tuner.getCandidates()[1]);
+  BOOST_CHECK(!tuner.isTuned(otherKey));
+
+  std::remove(file.c_str());
 }
 
 BOOST_AUTO_TEST_SUITE_END()
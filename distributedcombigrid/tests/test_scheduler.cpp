@@ -0,0 +1,153 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <numeric>
+#include <vector>
+
+#include "sgpp/distributedcombigrid/scheduler/ILPScheduler.hpp"
+#include "sgpp/distributedcombigrid/scheduler/KarmarkarKarpScheduler.hpp"
+#include "sgpp/distributedcombigrid/scheduler/LPTScheduler.hpp"
+#include "sgpp/distributedcombigrid/scheduler/LocalSearchScheduler.hpp"
+#include "sgpp/distributedcombigrid/scheduler/TaskScheduler.hpp"
+
+using namespace combigrid;
+
+/* checks that each task is assigned to a valid group, that the result is
+ * deterministic and that the makespan is within the bounds of a list schedule
+ */
+real checkSchedule(TaskScheduler& scheduler, const std::vector<real>& loads,
+                   const std::vector<real>& capacities) {
+  std::vector<size_t> assignment = scheduler.schedule(loads, capacities);
+
+  BOOST_REQUIRE(assignment.size() == loads.size());
+  for (size_t g : assignment) BOOST_CHECK(g < capacities.size());
+
+  BOOST_CHECK(assignment == scheduler.schedule(loads, capacities));
+
+  real makespan = TaskScheduler::getMakespan(loads, capacities, assignment);
+  real sumLoads = std::accumulate(loads.begin(), loads.end(), real(0.0));
+  real sumCapacities = std::accumulate(capacities.begin(), capacities.end(), real(0.0));
+  real maxLoad = *std::max_element(loads.begin(), loads.end());
+  real maxCapacity = *std::max_element(capacities.begin(), capacities.end());
+
+  BOOST_CHECK(makespan >= sumLoads / sumCapacities - 1e-12);
+  BOOST_CHECK(makespan <= sumLoads / sumCapacities + maxLoad / maxCapacity + 1e-12);
+
+  return makespan;
+}
+
+BOOST_AUTO_TEST_SUITE(scheduler)
+
+BOOST_AUTO_TEST_CASE(test_lpt) {
+  LPTScheduler lpt;
+  std::vector<real> loads = {5, 5, 4, 4, 3, 3, 3};
+  std::vector<real> capacities(3, 1.0);
+
+  // the classical example where LPT is not optimal (optimum 9)
+  BOOST_CHECK(checkSchedule(lpt, loads, capacities) == 11);
+
+  // a faster group gets more work
+  std::vector<real> loads2 = {4, 2};
+  std::vector<real> capacities2 = {2, 1};
+  std::vector<size_t> assignment = lpt.schedule(loads2, capacities2);
+  BOOST_CHECK(assignment[0] == 0);
+  BOOST_CHECK(assignment[1] == 1);
+  BOOST_CHECK(TaskScheduler::getMakespan(loads2, capacities2, assignment) == 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_karmarkar_karp) {
+  KarmarkarKarpScheduler kk;
+
+  // two groups: the differencing method finds the perfect partition 10 = 8 + 2 = 7 + 3
+  std::vector<real> loads = {8, 7, 3, 2};
+  std::vector<real> capacities(2, 1.0);
+  BOOST_CHECK(checkSchedule(kk, loads, capacities) == 10);
+
+  std::vector<real> loads2 = {5, 5, 4, 4, 3, 3, 3};
+  std::vector<real> capacities2(3, 1.0);
+  BOOST_CHECK(checkSchedule(kk, loads2, capacities2) <= 11);
+
+  // different capacities fall back to LPT
+  std::vector<real> capacities3 = {2, 1, 1};
+  LPTScheduler lpt;
+  BOOST_CHECK(kk.schedule(loads2, capacities3) == lpt.schedule(loads2, capacities3));
+}
+
+BOOST_AUTO_TEST_CASE(test_local_search) {
+  LocalSearchScheduler ls;
+  std::vector<real> loads = {5, 5, 4, 4, 3, 3, 3};
+  std::vector<real> capacities(3, 1.0);
+
+  // starting from LPT, moves and swaps reach the optimum
+  BOOST_CHECK(checkSchedule(ls, loads, capacities) == 9);
+
+  LocalSearchScheduler lsKK(std::unique_ptr<TaskScheduler>(new KarmarkarKarpScheduler()));
+  std::vector<real> loads2 = {12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1};
+  BOOST_CHECK(checkSchedule(lsKK, loads2, capacities) == 26);
+}
+
+BOOST_AUTO_TEST_CASE(test_ilp) {
+  std::vector<real> loads = {9, 5, 5, 5, 3, 3};
+  std::vector<real> capacities(2, 1.0);
+
+  // local search gets stuck at 16, the optimum is {9, 3, 3} and {5, 5, 5}
+  LocalSearchScheduler ls;
+  BOOST_CHECK(checkSchedule(ls, loads, capacities) == 16);
+
+  ILPScheduler ilp;
+  BOOST_CHECK(checkSchedule(ilp, loads, capacities) == 15);
+
+  ILPScheduler ilpLPT(std::unique_ptr<TaskScheduler>(new LPTScheduler()));
+  std::vector<real> loads2 = {5, 5, 4, 4, 3, 3, 3};
+  BOOST_CHECK(checkSchedule(ilpLPT, loads2, std::vector<real>(3, 1.0)) == 9);
+
+  // stopping branch and bound right away never makes the initial assignment worse
+  ILPScheduler ilpNoNodes(nullptr, 0);
+  BOOST_CHECK(checkSchedule(ilpNoNodes, loads, capacities) <= 16);
+}
+
+BOOST_AUTO_TEST_CASE(test_min_capacities) {
+  // the first task only fits on the larger group, e.g. because of its memory
+  std::vector<real> loads = {1, 8};
+  std::vector<real> capacities = {1, 4};
+  std::vector<real> minCapacities = {4, 1};
+
+  LPTScheduler lpt;
+  LocalSearchScheduler ls;
+  KarmarkarKarpScheduler kk;
+  ILPScheduler ilp;
+
+  for (TaskScheduler* scheduler : std::vector<TaskScheduler*>{&lpt, &ls, &kk, &ilp}) {
+    scheduler->setMinCapacities(minCapacities);
+    std::vector<size_t> assignment = scheduler->schedule(loads, capacities);
+    BOOST_CHECK(assignment[0] == 1);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_allowed_groups) {
+  // the largest task is not allowed on the larger groups, e.g. because of the memory of
+  // its temporary grids there. with equal capacities, Karmarkar-Karp falls back to LPT
+  std::vector<real> loads = {8, 1, 1, 1};
+  std::vector<std::vector<real>> capacities = {{1, 2, 2}, {1, 1, 1}};
+  std::vector<std::vector<bool>> allowedGroups(loads.size(), std::vector<bool>(3, true));
+  allowedGroups[0] = {true, false, false};
+
+  LPTScheduler lpt;
+  LocalSearchScheduler ls;
+  KarmarkarKarpScheduler kk;
+  ILPScheduler ilp;
+
+  for (const std::vector<real>& c : capacities) {
+    for (TaskScheduler* scheduler : std::vector<TaskScheduler*>{&lpt, &ls, &kk, &ilp}) {
+      scheduler->setAllowedGroups(allowedGroups);
+      std::vector<size_t> assignment = scheduler->schedule(loads, c);
+      BOOST_CHECK(assignment[0] == 0);
+
+      // the other tasks go to the other groups
+      for (size_t i = 1; i < loads.size(); ++i) BOOST_CHECK(assignment[i] != 0);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,393 @@
+/* offline discrete-event simulation of the manager/worker protocol.
+ *
+ * predicts the makespan and the utilization of the process groups of a
+ * combination technique run for different numbers of groups and processes
+ * without running MPI. the tasks are assigned with the scheduler of the
+ * ProcessManager, the groups run them one after another, hierarchize, take part
+ * in the global reduction and report to the manager, which starts the next run
+ * when all groups are done (runfirst, then ncombi times combine and runnext as
+ * in combi_example).
+ *
+ * usage: simulateCombination [ctparam]
+ *
+ * the combination scheme is read from the [ct] section of the ctparam file, the
+ * default configuration from [manager]. the optional section [simulation]
+ * configures the models:
+ *
+ *   ngroup = 2 4 8         # configurations to simulate (all combinations of
+ *   nprocs = 4 8           # ngroup and nprocs), default from [manager]
+ *   loadmodel = linear     # linear: load of LinearLoadModel * timePerLoad
+ *                          # durations: recorded .durations files
+ *   timePerLoad = 1e-7     # seconds per unit of load on one process
+ *   durationsDir = .       # directory of the .durations files
+ *   initTimePerPoint = 0   # seconds per grid point to initialize a task
+ *   hierarchizationTimePerPoint = 1e-8  # seconds per point to hierarchize and
+ *                                       # add (resp. extract and dehierarchize)
+ *   latency = 2e-6         # seconds per message
+ *   bandwidth = 5e9        # bytes per second between two processes
+ *
+ * all times are for one process, a group of size p needs 1 / p of it (perfect
+ * strong scaling inside a group). recorded durations are scaled by the number
+ * of processes they were measured with.
+ */
+#include <boost/property_tree/ini_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <queue>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "sgpp/distributedcombigrid/combischeme/CombiMinMaxScheme.hpp"
+#include "sgpp/distributedcombigrid/loadmodel/LearningLoadModel.hpp"
+#include "sgpp/distributedcombigrid/loadmodel/LinearLoadModel.hpp"
+#include "sgpp/distributedcombigrid/scheduler/LPTScheduler.hpp"
+#include "sgpp/distributedcombigrid/utils/LevelVector.hpp"
+#include "sgpp/distributedcombigrid/utils/Types.hpp"
+
+using namespace combigrid;
+
+/* time of a task on one process from the .durations files written by the
+ * LearningLoadModel. levels without a file are estimated with the linear load
+ * model, scaled by the mean ratio of the recorded levels (or by timePerLoad if
+ * there are no recorded levels at all)
+ */
+class RecordedLoadModel : public LoadModel {
+ public:
+  RecordedLoadModel(const std::vector<LevelVector>& levels, const std::string& directory,
+                    real timePerLoad)
+      : timePerLoad_(timePerLoad) {
+    LinearLoadModel linear;
+    real ratio(0.0);
+
+    for (const LevelVector& l : levels) {
+      // getFilename starts with "./"
+      std::ifstream ifs(directory + "/" + getFilename(l).substr(2));
+      std::string line;
+      real sum(0.0);
+      size_t count = 0;
+
+      // columns: duration in usec, dt, simulation time, group, number of processes
+      while (std::getline(ifs, line)) {
+        std::istringstream iss(line);
+        real duration, dt, time, nProcesses;
+        int group;
+
+        if (!(iss >> duration >> dt >> time >> group >> nProcesses)) continue;
+
+        sum += duration * 1e-6 * nProcesses;
+        ++count;
+      }
+
+      if (count == 0) continue;
+
+      times_[l] = sum / real(count);
+      ratio += times_[l] / linear.eval(l);
+    }
+
+    if (!times_.empty()) timePerLoad_ = ratio / real(times_.size());
+
+    std::cout << "recorded durations for " << times_.size() << " of " << levels.size()
+              << " levels" << std::endl;
+  }
+
+  real eval(const LevelVector& l) {
+    auto it = times_.find(l);
+
+    if (it != times_.end()) return it->second;
+
+    LinearLoadModel linear;
+    return timePerLoad_ * linear.eval(l);
+  }
+
+ private:
+  std::map<LevelVector, real> times_;
+
+  real timePerLoad_;
+};
+
+// time of a task on one process from the load of the linear load model
+class ScaledLinearLoadModel : public LoadModel {
+ public:
+  explicit ScaledLinearLoadModel(real timePerLoad) : timePerLoad_(timePerLoad) {}
+
+  real eval(const LevelVector& l) { return timePerLoad_ * linear_.eval(l); }
+
+ private:
+  LinearLoadModel linear_;
+
+  real timePerLoad_;
+};
+
+struct SimulationParameters {
+  size_t ncombi;
+  real initTimePerPoint;
+  real hierarchizationTimePerPoint;
+  real latency;
+  real bandwidth;
+};
+
+struct SimulationResult {
+  real makespan;
+
+  real combinationTime;  // time between the first hierarchization and the last report
+
+  std::vector<real> busy;  // time each group computes
+};
+
+// number of points of a component grid with boundary
+size_t getNumPoints(const LevelVector& l) {
+  size_t points = 1;
+
+  for (LevelType li : l) points *= (size_t(1) << li) + 1;
+
+  return points;
+}
+
+/* number of points of the sparse grid of the combination, i.e. of all hierarchical
+ * subspaces of the component grids (see DistributedSparseGridUniform::setSizes)
+ */
+size_t getSparseGridPoints(const std::vector<LevelVector>& levels) {
+  std::set<LevelVector> subspaces;
+
+  for (const LevelVector& l : levels) {
+    LevelVector k(l.size(), 1);
+
+    // iterate over all k <= l
+    while (true) {
+      subspaces.insert(k);
+
+      size_t d = 0;
+
+      while (d < k.size() && k[d] == l[d]) k[d++] = 1;
+
+      if (d == k.size()) break;
+
+      ++k[d];
+    }
+  }
+
+  size_t points = 0;
+
+  for (const LevelVector& k : subspaces) {
+    size_t subspacePoints = 1;
+
+    for (LevelType kd : k) subspacePoints *= (kd == 1) ? 3 : (size_t(1) << (kd - 1));
+
+    points += subspacePoints;
+  }
+
+  return points;
+}
+
+/* discrete-event simulation of one configuration. events are processed in the
+ * order of their time, each one advances the state of one group or of the
+ * manager and may create new events
+ */
+SimulationResult simulate(const std::vector<LevelVector>& levels, LoadModel& loadModel,
+                          size_t ngroup, size_t nprocs, const SimulationParameters& params) {
+  enum EventType { RUN_FINISHED, HIERARCHIZED, REDUCED, COMBINED, SIGNAL };
+
+  struct Event {
+    real time;
+    EventType type;
+    size_t group;
+
+    bool operator>(const Event& other) const {
+      return time > other.time || (time == other.time && group > other.group);
+    }
+  };
+
+  std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+
+  // task assignment as in ProcessManager::runfirst
+  std::vector<real> loads(levels.size()), capacities(ngroup, real(nprocs));
+
+  for (size_t i = 0; i < levels.size(); ++i) loads[i] = loadModel.eval(levels[i]);
+
+  LPTScheduler scheduler;
+  std::vector<size_t> assignment = scheduler.schedule(loads, capacities);
+
+  std::vector<real> runTime(ngroup, 0.0), initTime(ngroup, 0.0), hierarchizationTime(ngroup, 0.0);
+
+  for (size_t i = 0; i < levels.size(); ++i) {
+    size_t g = assignment[i];
+    real points = real(getNumPoints(levels[i]));
+
+    runTime[g] += loads[i] / real(nprocs);
+    initTime[g] += params.initTimePerPoint * points / real(nprocs);
+    hierarchizationTime[g] += params.hierarchizationTimePerPoint * points / real(nprocs);
+  }
+
+  // allreduce of the part of the sparse grid of each process across the groups
+  // (recursive doubling for the latency, ring for the bandwidth term)
+  real bytes = real(getSparseGridPoints(levels)) * sizeof(CombiDataType) / real(nprocs);
+  real reduceTime(0.0);
+
+  if (ngroup > 1) {
+    reduceTime = 2.0 * std::ceil(std::log2(real(ngroup))) * params.latency +
+                 2.0 * real(ngroup - 1) / real(ngroup) * bytes / params.bandwidth;
+  }
+
+  SimulationResult result;
+  result.busy.assign(ngroup, 0.0);
+  result.combinationTime = 0.0;
+
+  // the manager sends the signals to the groups one after another
+  for (size_t g = 0; g < ngroup; ++g) {
+    real start = real(g + 1) * params.latency;
+    events.push({start + initTime[g] + runTime[g], RUN_FINISHED, g});
+    result.busy[g] += initTime[g] + runTime[g];
+  }
+
+  // number of groups which reached the current synchronization point
+  size_t combination = 0, arrived = 0, combined = 0;
+  real lastHierarchized(0.0), combinationStart(0.0), now(0.0);
+
+  while (!events.empty()) {
+    Event e = events.top();
+    events.pop();
+    now = e.time;
+
+    switch (e.type) {
+      case RUN_FINISHED: {
+        // the manager has to wait for all groups before it sends the combine signal
+        if (combination == params.ncombi) break;
+
+        if (++arrived < ngroup) break;
+
+        arrived = 0;
+        combinationStart = now;
+
+        for (size_t g = 0; g < ngroup; ++g) {
+          real start = now + real(g + 2) * params.latency;
+          events.push({start + hierarchizationTime[g], HIERARCHIZED, g});
+          result.busy[g] += hierarchizationTime[g];
+        }
+      } break;
+      case HIERARCHIZED: {
+        // the global reduction synchronizes all groups
+        lastHierarchized = std::max(lastHierarchized, now);
+
+        if (++arrived < ngroup) break;
+
+        arrived = 0;
+
+        for (size_t g = 0; g < ngroup; ++g) {
+          events.push({lastHierarchized + reduceTime, REDUCED, g});
+          result.busy[g] += reduceTime;
+        }
+      } break;
+      case REDUCED: {
+        // extract and dehierarchize, then report to the manager
+        events.push({now + hierarchizationTime[e.group] + params.latency, COMBINED, e.group});
+        result.busy[e.group] += hierarchizationTime[e.group];
+      } break;
+      case COMBINED: {
+        if (++combined < ngroup) break;
+
+        combined = 0;
+        lastHierarchized = 0.0;
+        result.combinationTime += now - combinationStart;
+        ++combination;
+
+        for (size_t g = 0; g < ngroup; ++g) events.push({now, SIGNAL, g});
+      } break;
+      case SIGNAL: {
+        // runnext
+        real start = now + real(e.group + 1) * params.latency;
+        events.push({start + runTime[e.group], RUN_FINISHED, e.group});
+        result.busy[e.group] += runTime[e.group];
+      } break;
+    }
+  }
+
+  result.makespan = now;
+
+  return result;
+}
+
+std::vector<size_t> readList(const std::string& str) {
+  std::istringstream iss(str);
+  std::vector<size_t> list;
+  size_t value;
+
+  while (iss >> value) list.push_back(value);
+
+  return list;
+}
+
+int main(int argc, char** argv) {
+  std::string ctparam = (argc > 1) ? argv[1] : "ctparam";
+
+  boost::property_tree::ptree cfg;
+  boost::property_tree::ini_parser::read_ini(ctparam, cfg);
+
+  DimType dim = cfg.get<DimType>("ct.dim");
+  LevelVector lmin(dim), lmax(dim);
+  cfg.get<std::string>("ct.lmin") >> lmin;
+  cfg.get<std::string>("ct.lmax") >> lmax;
+
+  SimulationParameters params;
+  params.ncombi = cfg.get<size_t>("ct.ncombi");
+  params.initTimePerPoint = cfg.get<real>("simulation.initTimePerPoint", 0.0);
+  params.hierarchizationTimePerPoint =
+      cfg.get<real>("simulation.hierarchizationTimePerPoint", 1e-8);
+  params.latency = cfg.get<real>("simulation.latency", 2e-6);
+  params.bandwidth = cfg.get<real>("simulation.bandwidth", 5e9);
+
+  std::vector<size_t> ngroups =
+      readList(cfg.get<std::string>("simulation.ngroup", cfg.get<std::string>("manager.ngroup")));
+  std::vector<size_t> nprocss =
+      readList(cfg.get<std::string>("simulation.nprocs", cfg.get<std::string>("manager.nprocs")));
+
+  CombiMinMaxScheme combischeme(dim, lmin, lmax);
+  combischeme.createAdaptiveCombischeme();
+  std::vector<LevelVector> levels = combischeme.getCombiSpaces();
+
+  std::unique_ptr<LoadModel> loadModel;
+  std::string loadModelName = cfg.get<std::string>("simulation.loadmodel", "linear");
+  real timePerLoad = cfg.get<real>("simulation.timePerLoad", 1e-7);
+
+  if (loadModelName == "durations") {
+    loadModel.reset(new RecordedLoadModel(
+        levels, cfg.get<std::string>("simulation.durationsDir", "."), timePerLoad));
+  } else {
+    assert(loadModelName == "linear" && "unknown load model");
+    loadModel.reset(new ScaledLinearLoadModel(timePerLoad));
+  }
+
+  std::cout << levels.size() << " component grids, " << getSparseGridPoints(levels)
+            << " sparse grid points, " << params.ncombi << " combinations" << std::endl;
+
+  std::cout << std::setw(8) << "ngroup" << std::setw(8) << "nprocs" << std::setw(14) << "makespan"
+            << std::setw(14) << "combination" << std::setw(12) << "min util" << std::setw(12)
+            << "avg util" << std::setw(12) << "max util" << std::endl;
+
+  for (size_t ngroup : ngroups) {
+    for (size_t nprocs : nprocss) {
+      SimulationResult result = simulate(levels, *loadModel, ngroup, nprocs, params);
+
+      real minBusy = *std::min_element(result.busy.begin(), result.busy.end());
+      real maxBusy = *std::max_element(result.busy.begin(), result.busy.end());
+      real avgBusy(0.0);
+
+      for (real busy : result.busy) avgBusy += busy / real(ngroup);
+
+      std::cout << std::setw(8) << ngroup << std::setw(8) << nprocs << std::setw(14)
+                << result.makespan << std::setw(14) << result.combinationTime << std::setw(12)
+                << minBusy / result.makespan << std::setw(12) << avgBusy / result.makespan
+                << std::setw(12) << maxBusy / result.makespan << std::endl;
+    }
+  }
+
+  return 0;
+}